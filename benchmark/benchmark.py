@@ -3,8 +3,11 @@
 import argparse
 import os
 import subprocess
+import tempfile
 import time
 
+from gen_corpus import add_corpus_args, generate_corpus
+
 def measure_time(command, repeat_time=60):
     duration = 0
     count = 0
@@ -25,7 +28,9 @@ def measure_time(command, repeat_time=60):
 
 def get_args():
     parser = argparse.ArgumentParser()
-    parser.add_argument("file", help="path to source codes")
+    parser.add_argument("file", nargs="?", default=None,
+                        help="path to source codes. "
+                             "Default to a synthetic corpus made by gen_corpus.py")
     parser.add_argument("--cpplint_cpp", default="./build/cpplint-cpp", type=str,
                         help="path to cpplint-cpp")
     parser.add_argument("--cpplint_py", default="python cpplint.py", type=str,
@@ -34,12 +39,11 @@ def get_args():
                         help="options for cpplint")
     parser.add_argument("--time", default=60, type=int,
                         help="Minimum measurement time for a command. Default to 60 (sec)")
+    add_corpus_args(parser.add_argument_group("corpus options (used without file)"))
     return parser.parse_args()
 
 
-if __name__ == '__main__':
-    args = get_args()
-    file = args.file
+def run(args, file):
     options = args.options
     repeat_time = args.time
 
@@ -62,3 +66,15 @@ if __name__ == '__main__':
     # Output result
     print(f"Execution time for cpplint-cpp: {time1:.6f} seconds")
     print(f"Execution time for cpplint.py: {time2:.6f} seconds")
+
+
+if __name__ == '__main__':
+    args = get_args()
+    if args.file is not None:
+        run(args, args.file)
+    else:
+        with tempfile.TemporaryDirectory() as temp_dir:
+            corpus = os.path.join(temp_dir, "corpus")
+            _, total_lines = generate_corpus(corpus, args)
+            print(f"Generated a corpus: {args.files} files, {total_lines} lines, seed={args.seed}")
+            run(args, corpus)
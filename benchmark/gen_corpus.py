@@ -0,0 +1,315 @@
+"""Generate a deterministic C++ source tree for benchmarking.
+
+The same seed and options always produce the same files, so benchmark
+results don't depend on which checkout is on hand.
+
+Usage:
+    python gen_corpus.py <output dir> [--seed=N] [--files=N] [--lines=N] ...
+"""
+import argparse
+import os
+import random
+import shutil
+
+IDENTS = [
+    'value', 'count', 'index', 'buffer', 'size', 'name', 'result', 'item',
+    'offset', 'length', 'node', 'parent', 'child', 'state', 'config', 'data',
+    'handle', 'stream', 'token', 'entry', 'cache', 'key', 'flags', 'limit',
+]
+TYPES = [
+    'int', 'size_t', 'int64_t', 'uint32_t', 'double', 'bool', 'char',
+    'std::string', 'std::vector<int>', 'std::map<std::string, int>',
+    'std::unique_ptr<Node>', 'const char*', 'long', 'short',
+]
+FUNCS = [
+    'Process', 'Update', 'Compute', 'Parse', 'Flush', 'Reset', 'Append',
+    'Lookup', 'Insert', 'Remove', 'Resize', 'Validate', 'Serialize', 'Load',
+]
+SYSTEM_HEADERS = [
+    'stdio.h', 'stdlib.h', 'string.h', 'algorithm', 'map', 'memory',
+    'set', 'string', 'unordered_map', 'utility', 'vector', 'functional',
+]
+WORDS = [
+    'the', 'cache', 'is', 'updated', 'when', 'a', 'node', 'changes', 'and',
+    'we', 'skip', 'empty', 'entries', 'to', 'keep', 'order', 'stable', 'for',
+]
+UTF8_WORDS = ['naïve', 'Größe', 'façade', '日本語', 'привет', 'λ-calculus', '✓', '🚀']
+CONFIG_LINES = [
+    'linelength=100',
+    'linelength=120',
+    'filter=-build/include_subdir',
+    'filter=-legal/copyright',
+    'filter=-runtime/references',
+    'filter=-whitespace/indent,+whitespace/braces',
+    'filter=-readability/casting',
+]
+INDENT = '  '
+
+
+class SourceGenerator:
+    """Generates lines of a file with the given options."""
+
+    def __init__(self, rng, args, utf8):
+        self.rng = rng
+        self.args = args
+        self.utf8 = utf8
+        self.lines = []
+
+    def chance(self, probability):
+        return self.rng.random() < probability
+
+    def ident(self):
+        name = self.rng.choice(IDENTS)
+        if self.chance(0.3):
+            name += '_' + self.rng.choice(IDENTS)
+        return name
+
+    def words(self, count):
+        words = [self.rng.choice(WORDS) for _ in range(count)]
+        if self.utf8 and self.chance(0.5):
+            words[self.rng.randrange(count)] = self.rng.choice(UTF8_WORDS)
+        return ' '.join(words)
+
+    def string_literal(self):
+        text = self.words(self.rng.randint(1, 5))
+        if self.chance(0.2):
+            text += ' // not a comment'
+        if self.chance(0.2):
+            text += '\\n'
+        return '"' + text + '"'
+
+    def expr(self):
+        kind = self.rng.randrange(6)
+        if kind == 0:
+            return str(self.rng.randint(0, 1000))
+        if kind == 1:
+            return f'{self.ident()} + {self.ident()}'
+        if kind == 2:
+            return f'static_cast<{self.rng.choice(TYPES[:6])}>({self.ident()})'
+        if kind == 3:
+            return f'{self.ident()}.size()'
+        if kind == 4 and self.chance(self.args.string_density):
+            return self.string_literal()
+        return self.ident()
+
+    def call(self, indent):
+        """A call whose arguments are wrapped at the line length limit."""
+        width = self.rng.randint(20, self.args.line_length)
+        head = f'{indent}{self.rng.choice(FUNCS)}('
+        args = [self.expr()]
+        while len(head) + len(', '.join(args)) < width and len(args) < 12:
+            args.append(self.expr())
+        lines = [head]
+        for arg in args:
+            if len(lines[-1]) + len(arg) + 2 > self.args.line_length and lines[-1] != head:
+                lines[-1] = lines[-1].rstrip()
+                lines.append(' ' * len(head))
+            lines[-1] += arg + ', '
+        lines[-1] = lines[-1][:-2] + ');'
+        return lines
+
+    def statement(self, indent):
+        kind = self.rng.randrange(8)
+        if kind < 3:
+            lines = self.call(indent)
+        elif kind < 5:
+            lines = [f'{indent}{self.rng.choice(TYPES)} {self.ident()} = {self.expr()};']
+        elif kind == 5:
+            lines = [f'{indent}{self.ident()} += {self.expr()};']
+        elif kind == 6 and self.chance(self.args.raw_string_density * 4):
+            lines = [f'{indent}const char* {self.ident()} = R"(']
+            lines += [self.words(self.rng.randint(2, 8))
+                      for _ in range(self.rng.randint(1, 4))]
+            lines.append(')";')
+        else:
+            lines = [f'{indent}{self.ident()}->{self.rng.choice(FUNCS)}();']
+        if self.chance(self.args.comment_density):
+            if self.chance(0.5):
+                lines.insert(0, f'{indent}// {self.words(self.rng.randint(3, 10))}')
+            else:
+                lines[-1] += f'  // {self.words(self.rng.randint(1, 5))}'
+        return lines
+
+    def block(self, indent, depth, budget):
+        """Statements and nested blocks up to budget lines."""
+        start = len(self.lines)
+        while len(self.lines) - start < budget:
+            if depth < self.args.depth and self.chance(0.25):
+                head = self.rng.choice([
+                    f'if ({self.ident()} > {self.expr()}) {{',
+                    f'for (int i = 0; i < {self.ident()}; i++) {{',
+                    f'while ({self.ident()}) {{',
+                    f'switch ({self.ident()}) {{',
+                ])
+                self.lines.append(indent + head)
+                inner = self.rng.randint(1, max(1, budget // 2))
+                if head.startswith('switch'):
+                    self.lines.append(f'{indent}{INDENT}case 0:')
+                    self.block(indent + INDENT * 2, depth + 1, inner)
+                    self.lines.append(f'{indent}{INDENT * 2}break;')
+                else:
+                    self.block(indent + INDENT, depth + 1, inner)
+                self.lines.append(indent + '}')
+            else:
+                self.lines += self.statement(indent)
+
+    def function(self, indent, depth):
+        ret = self.rng.choice(TYPES[:8])
+        params = ', '.join(f'{self.rng.choice(TYPES)} {self.ident()}'
+                           for _ in range(self.rng.randint(0, 3)))
+        if self.chance(self.args.comment_density):
+            self.lines.append(f'{indent}// {self.words(self.rng.randint(4, 12))}')
+        self.lines.append(f'{indent}{ret} {self.rng.choice(FUNCS)}{self.ident().title()}({params}) {{')
+        self.block(indent + INDENT, depth + 1, self.rng.randint(3, 30))
+        if ret != 'void':
+            self.lines.append(f'{indent}{INDENT}return {{}};')
+        self.lines.append(indent + '}')
+        self.lines.append('')
+
+    def class_def(self, indent, depth):
+        name = self.rng.choice(FUNCS) + self.ident().title().replace('_', '')
+        self.lines.append(f'{indent}class {name} {{')
+        self.lines.append(f'{indent} public:')
+        self.lines.append(f'{indent}{INDENT}explicit {name}(int {self.ident()});')
+        self.lines.append(f'{indent}{INDENT}virtual ~{name}();')
+        for _ in range(self.rng.randint(1, 3)):
+            self.function(indent + INDENT, depth + 1)
+        self.lines.append(f'{indent} private:')
+        for _ in range(self.rng.randint(1, 4)):
+            self.lines.append(f'{indent}{INDENT}{self.rng.choice(TYPES)} {self.ident()}_;')
+        self.lines.append(f'{indent}}};')
+        self.lines.append('')
+
+    def macro(self):
+        name = self.ident().upper()
+        if self.chance(0.5):
+            self.lines.append(f'#define {name}(x) \\')
+            self.lines.append(f'{INDENT}do {{ \\')
+            self.lines.append(f'{INDENT * 2}{self.rng.choice(FUNCS)}(x); \\')
+            self.lines.append(f'{INDENT}}} while (0)')
+        else:
+            self.lines.append(f'#ifdef USE_{name}')
+            self.lines.append(f'#define {name} {self.rng.randint(0, 100)}')
+            self.lines.append('#else')
+            self.lines.append(f'#define {name} 0')
+            self.lines.append(f'#endif  // USE_{name}')
+        self.lines.append('')
+
+    def file(self, path, budget):
+        is_header = path.endswith('.h')
+        # cpplint uses file names for header guards when there is no repository.
+        guard = os.path.basename(path).replace('.', '_').upper() + '_'
+        if self.chance(0.9):
+            self.lines.append('// Copyright 2024 cpplint-cpp authors')
+        if is_header:
+            self.lines += [f'#ifndef {guard}', f'#define {guard}', '']
+        headers = self.rng.sample(SYSTEM_HEADERS, self.rng.randint(2, 6))
+        headers.sort(key=lambda h: (not h.endswith('.h'), h))
+        self.lines += [f'#include <{h}>' for h in headers]
+        self.lines.append(f'#include "{path[:-len(os.path.splitext(path)[1])]}.h"')
+        self.lines.append('')
+        if self.chance(self.args.comment_density):
+            self.lines.append('/*')
+            self.lines += [f' * {self.words(self.rng.randint(4, 12))}'
+                           for _ in range(self.rng.randint(1, 4))]
+            self.lines.append(' */')
+        self.lines += ['namespace corpus {', '']
+        while len(self.lines) < budget:
+            kind = self.rng.random()
+            if kind < self.args.macro_density:
+                self.macro()
+            elif kind < 0.5:
+                self.class_def('', 0)
+            else:
+                self.function('', 0)
+        self.lines += ['}  // namespace corpus', '']
+        if is_header:
+            self.lines += [f'#endif  // {guard}']
+        return self.lines
+
+
+def generate_corpus(out_dir, args):
+    """Write files into out_dir. Existing files in out_dir are removed.
+
+    Returns paths to the generated source files and the total number of lines.
+    """
+    rng = random.Random(args.seed)
+    if os.path.exists(out_dir):
+        shutil.rmtree(out_dir)
+
+    # Directories form a tree, and some of them have CPPLINT.cfg.
+    dirs = ['']
+    for i in range(max(0, args.dirs - 1)):
+        parent = rng.choice(dirs)
+        if parent.count('/') + 1 >= args.dir_depth:
+            parent = ''
+        dirs.append(os.path.join(parent, f'dir{i}').replace(os.sep, '/'))
+    for d in dirs:
+        os.makedirs(os.path.join(out_dir, d), exist_ok=True)
+        if d == '' or rng.random() < args.config_density:
+            lines = rng.sample(CONFIG_LINES, rng.randint(1, 3))
+            if d == '':
+                lines.insert(0, 'set noparent')
+            with open(os.path.join(out_dir, d, 'CPPLINT.cfg'), 'w', encoding='utf-8') as f:
+                f.write('\n'.join(lines) + '\n')
+
+    paths = []
+    total_lines = 0
+    for i in range(args.files):
+        d = rng.choice(dirs)
+        ext = '.h' if i % 2 == 0 else '.cc'
+        path = os.path.join(d, f'file{i // 2}{ext}').replace(os.sep, '/')
+        budget = rng.randint(args.lines // 2, args.lines * 3 // 2)
+        utf8 = rng.random() < args.utf8_density
+        newline = '\r\n' if rng.random() < args.crlf_density else '\n'
+        lines = SourceGenerator(rng, args, utf8).file(path, budget)
+        total_lines += len(lines)
+        paths.append(os.path.join(out_dir, path))
+        with open(paths[-1], 'w', encoding='utf-8', newline=newline) as f:
+            f.write('\n'.join(lines) + '\n')
+    return paths, total_lines
+
+
+def add_corpus_args(parser):
+    """Options for the corpus. benchmark scripts share them."""
+    parser.add_argument('--seed', default=0, type=int,
+                        help='Seed for the random generator. Default to 0')
+    parser.add_argument('--files', default=200, type=int,
+                        help='Number of source files. Default to 200')
+    parser.add_argument('--lines', default=400, type=int,
+                        help='Average number of lines for each file. Default to 400')
+    parser.add_argument('--line_length', default=80, type=int,
+                        help='Maximum line length for wrapping statements. Default to 80')
+    parser.add_argument('--depth', default=4, type=int,
+                        help='Maximum nesting depth of blocks in functions. Default to 4')
+    parser.add_argument('--comment_density', default=0.2, type=float,
+                        help='Probability of comments for each statement. Default to 0.2')
+    parser.add_argument('--string_density', default=0.3, type=float,
+                        help='Probability of string literals for expressions. Default to 0.3')
+    parser.add_argument('--raw_string_density', default=0.02, type=float,
+                        help='Probability of raw strings for statements. Default to 0.02')
+    parser.add_argument('--macro_density', default=0.1, type=float,
+                        help='Probability of macros for top level items. Default to 0.1')
+    parser.add_argument('--crlf_density', default=0.05, type=float,
+                        help='Ratio of files that use CRLF. Default to 0.05')
+    parser.add_argument('--utf8_density', default=0.2, type=float,
+                        help='Ratio of files that have non-ASCII characters. Default to 0.2')
+    parser.add_argument('--dirs', default=16, type=int,
+                        help='Number of directories. Default to 16')
+    parser.add_argument('--dir_depth', default=3, type=int,
+                        help='Maximum depth of directories. Default to 3')
+    parser.add_argument('--config_density', default=0.3, type=float,
+                        help='Ratio of directories that have CPPLINT.cfg. Default to 0.3')
+
+
+def get_args():
+    parser = argparse.ArgumentParser()
+    parser.add_argument('out_dir', help='output directory. It will be overwritten')
+    add_corpus_args(parser)
+    return parser.parse_args()
+
+
+if __name__ == '__main__':
+    args = get_args()
+    _, total_lines = generate_corpus(args.out_dir, args)
+    print(f'Generated {args.files} files ({total_lines} lines) in {args.out_dir}')
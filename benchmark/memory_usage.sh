@@ -1,11 +1,21 @@
 #!/bin/sh
 # Script to measure memory usage with cpplint
+# It uses a synthetic corpus made by gen_corpus.py when a directory is not specified.
 #
 # Examples
 #  sh ./benchmark/memory_usage.sh "python3 cpplint.py" .
 #  sh ./benchmark/memory_usage.sh "./build/cpplint-cpp" ../googletest-1.4.0
+#  sh ./benchmark/memory_usage.sh "./build/cpplint-cpp"
+
+target=$2
+if [ -z "$target" ]; then
+    temp_dir="$(mktemp -d)"
+    trap 'rm -rf "$temp_dir"' EXIT
+    target="$temp_dir/corpus"
+    python3 "$(dirname "$0")/gen_corpus.py" "$target" || exit 1
+fi
 
 echo Measuring memory usage: $1
-kib="$(/usr/bin/time -f "%M" sh -c "$1 --recursive --quiet --counting=detailed $2 >/dev/null 2>&1 || exit 0" 2>&1)"
+kib="$(/usr/bin/time -f "%M" sh -c "$1 --recursive --quiet --counting=detailed $target >/dev/null 2>&1 || exit 0" 2>&1)"
 mib=$(echo "scale=2; $kib / 1024" | bc)
 echo Maximum memory usage: ${mib} MiB
@@ -0,0 +1,577 @@
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "cleanse.h"
+#include "cpplint_state.h"
+#include "error_categories.h"
+#include "file_linter.h"
+#include "getline.h"
+#include "line_utils.h"
+#include "options.h"
+#include "regex_utils.h"
+#include "states.h"
+#include "string_utils.h"
+
+// Microbenchmarks for hot functions of cpplint-cpp.
+// Each benchmark reports nanoseconds and heap allocations per operation.
+// Usage: micro-benchmark [--min-time=<ms>] [<name filter>]
+
+// Counts heap allocations made by the benchmarked code.
+// All replaceable forms of operator new are counted. Array forms call them.
+static std::atomic<uint64_t> g_alloc_count = 0;
+
+static void* CountedAlloc(size_t size) noexcept {
+    g_alloc_count.fetch_add(1, std::memory_order_relaxed);
+    if (size == 0)
+        size = 1;
+    return std::malloc(size);
+}
+
+static void* CountedAlignedAlloc(size_t size, std::align_val_t alignment) noexcept {
+    g_alloc_count.fetch_add(1, std::memory_order_relaxed);
+    size_t align = static_cast<size_t>(alignment);
+    if (size == 0)
+        size = 1;
+#ifdef _WIN32
+    return _aligned_malloc(size, align);
+#else
+    // aligned_alloc requires the size to be a multiple of the alignment.
+    size = (size + align - 1) / align * align;
+    return std::aligned_alloc(align, size);
+#endif
+}
+
+static void AlignedFree(void* ptr) noexcept {
+#ifdef _WIN32
+    _aligned_free(ptr);
+#else
+    std::free(ptr);
+#endif
+}
+
+void* operator new(size_t size) {
+    void* ptr = CountedAlloc(size);
+    if (!ptr)
+        throw std::bad_alloc();
+    return ptr;
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    return CountedAlloc(size);
+}
+
+void* operator new(size_t size, std::align_val_t alignment) {
+    void* ptr = CountedAlignedAlloc(size, alignment);
+    if (!ptr)
+        throw std::bad_alloc();
+    return ptr;
+}
+
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return CountedAlignedAlloc(size, alignment);
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept {
+    AlignedFree(ptr);
+}
+
+void operator delete(void* ptr, size_t, std::align_val_t) noexcept {
+    AlignedFree(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t, const std::nothrow_t&) noexcept {
+    AlignedFree(ptr);
+}
+
+// Prevents the compiler from removing unused results.
+static volatile size_t g_sink = 0;
+
+// Representative lines of C++ code.
+// It has classes, templates, macros, casts, and multi-line expressions.
+static const char SAMPLE_SOURCE[] = R"(// Copyright 2024 cpplint-cpp authors
+#ifndef SAMPLE_WIDGET_H_
+#define SAMPLE_WIDGET_H_
+
+#include <stdio.h>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include "widget/base.h"
+
+namespace widget {
+
+/* A block comment
+   that spans some lines. */
+template <typename T, int N = 4>
+class Widget : public Base<T> {
+ public:
+    explicit Widget(const std::string& name) : m_name(name), m_count(0) {}
+    virtual ~Widget() override = default;
+
+    int Count() const { return m_count; }
+    const std::string& Name() const { return m_name; }
+
+    void Update(const std::map<std::string, std::vector<T>>& items,
+                int* out_total) {
+        for (const auto& [key, values] : items) {
+            if (key.empty() || values.size() > static_cast<size_t>(N)) {
+                continue;
+            }
+            *out_total += (int)values.size();
+            m_count++;
+        }
+        CHECK(m_count >= 0);
+        EXPECT_EQ(m_count, *out_total) << "count mismatch";
+    }
+
+ private:
+    std::string m_name;
+    int m_count;
+    DISALLOW_COPY_AND_ASSIGN(Widget);
+};
+
+static const char kLongString[] = "this is a string literal with // and /* inside";
+static int g_counter = 0;
+
+inline int64_t Compute(int a, int b,
+                       int c) {
+    int64_t result = (a + b) * c - reinterpret_cast<int64_t>(&g_counter);
+    if (result > 0 and c != 0) {
+        printf("%d\n", a);
+        snprintf(nullptr, 0, "%s", "x");
+    }
+    char buffer[256];
+    memset(buffer, 0, sizeof(buffer));
+    auto pair = std::make_pair<int, int>(a, b);
+    return result + pair.first + strtok(buffer, ",") - buffer;
+}
+
+void Widget::Draw(Canvas& canvas) {
+  canvas.DrawRect( 0, 0, 10, 10 );
+  if(canvas.IsVisible()){
+    canvas.Flush();
+  }
+  else {
+    VLOG(INFO) << "hidden";
+  }
+  std::unique_ptr<Shape> shape = std::make_unique<Circle>(  3  );
+  shape->Move(1,2);
+  *count++;
+}
+
+}  // namespace widget
+
+#endif  // SAMPLE_WIDGET_H_
+)";
+
+// Options for benchmarking.
+static size_t g_min_time_ms = 200;
+static std::string g_name_filter;
+
+// Calls func() until it takes g_min_time_ms, and prints the average.
+// func() should run ops_per_call operations.
+template <typename Func>
+static void RunBenchmark(const std::string& name, size_t ops_per_call, Func&& func) {
+    if (!g_name_filter.empty() && name.find(g_name_filter) == std::string::npos)
+        return;
+    using Clock = std::chrono::steady_clock;
+
+    // Warm up. It also fills caches that are allocated lazily.
+    func();
+
+    uint64_t iterations = 1;
+    while (true) {
+        uint64_t alloc_start = g_alloc_count.load(std::memory_order_relaxed);
+        Clock::time_point start = Clock::now();
+        for (uint64_t i = 0; i < iterations; i++)
+            func();
+        Clock::time_point end = Clock::now();
+        uint64_t allocs = g_alloc_count.load(std::memory_order_relaxed) - alloc_start;
+
+        double elapsed_ns = static_cast<double>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+        if (elapsed_ns >= static_cast<double>(g_min_time_ms) * 1e6 || iterations >= (1ULL << 40)) {
+            double ops = static_cast<double>(iterations * ops_per_call);
+            printf("%-52s %12.1f ns/op %10.2f allocs/op\n",
+                   name.c_str(), elapsed_ns / ops, static_cast<double>(allocs) / ops);
+            return;
+        }
+        iterations *= 2;
+    }
+}
+
+static std::vector<std::string> SplitSample() {
+    std::vector<std::string> lines;
+    lines.emplace_back("// marker so line numbers and indices both start at 1");
+    std::istringstream stream(SAMPLE_SOURCE);
+    std::string line;
+    while (std::getline(stream, line))
+        lines.push_back(line);
+    lines.emplace_back("// marker so line numbers end in a known way");
+    return lines;
+}
+
+// A pathological file that has deeply nested structs.
+// Scanning forward for the end of each class makes it O(lines * classes).
+static std::vector<std::string> MakeNestedStructs(size_t count) {
+    std::vector<std::string> lines;
+    lines.emplace_back("// marker so line numbers and indices both start at 1");
+    lines.emplace_back("// Copyright 2024 cpplint-cpp authors");
+    for (size_t i = 0; i < count; i++)
+        lines.emplace_back("struct S" + std::to_string(i) + " {");
+    for (size_t i = 0; i < count; i++)
+        lines.emplace_back("};");
+    lines.emplace_back("// marker so line numbers end in a known way");
+    return lines;
+}
+
+// A pathological constructor that has a long initializer list.
+// Scanning back for the start of the list makes it O(lines^2).
+static std::vector<std::string> MakeInitializerList(size_t count) {
+    std::vector<std::string> lines;
+    lines.emplace_back("// marker so line numbers and indices both start at 1");
+    lines.emplace_back("// Copyright 2024 cpplint-cpp authors");
+    lines.emplace_back("class A {");
+    lines.emplace_back(" public:");
+    lines.emplace_back("  explicit A(const int& a)");
+    lines.emplace_back("      : m_0(&a),");
+    for (size_t i = 1; i < count; i++)
+        lines.emplace_back("        m_" + std::to_string(i) + "(&a),");
+    lines.emplace_back("        m_end(a) {}");
+    lines.emplace_back("};");
+    lines.emplace_back("// marker so line numbers end in a known way");
+    return lines;
+}
+
+static int ParseArgs(int argc, char* argv[]) {
+    const std::string min_time_flag = "--min-time=";
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg.starts_with(min_time_flag)) {
+            g_min_time_ms = StrToUint(arg.substr(min_time_flag.size()));
+            if (g_min_time_ms == INDEX_NONE) {
+                fprintf(stderr, "Invalid value for --min-time: %s\n", arg.c_str());
+                return 1;
+            }
+        } else if (arg.starts_with("-")) {
+            fprintf(stderr, "Usage: micro-benchmark [--min-time=<ms>] [<name filter>]\n");
+            return 1;
+        } else {
+            g_name_filter = arg;
+        }
+    }
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    if (ParseArgs(argc, argv))
+        return 1;
+
+    // Disable all errors to measure checks rather than outputs.
+    CppLintState cpplint_state;
+    Options options;
+    options.AddFilters("-");
+    fs::path file = "sample/widget.h";
+    FileLinter linter(file, &cpplint_state, options);
+    linter.CacheVariables(file);
+
+    std::vector<std::string> lines = SplitSample();
+    std::vector<std::string> raw_lines = lines;
+    linter.RemoveMultiLineComments(lines);
+    CleansedLines clean_lines(lines, options);
+    const std::vector<std::string>& elided = clean_lines.GetElidedLines();
+    const size_t num_lines = clean_lines.NumLines();
+
+    // Reading lines
+    {
+        std::istringstream stream(SAMPLE_SOURCE);
+        std::string buffer(120, '\0');
+        std::string line;
+        RunBenchmark("GetLine", lines.size() - 2, [&]() {
+            stream.clear();
+            stream.seekg(0);
+            int status = LINE_OK;
+            while ((status & LINE_EOF) == 0) {
+                GetLine(stream, &buffer, &line, &status);
+                g_sink = g_sink + line.size();
+            }
+        });
+    }
+    RunBenchmark("GetLineWidth", num_lines, [&]() {
+        for (const std::string& line : raw_lines)
+            g_sink = g_sink + GetLineWidth(line);
+    });
+
+    // Preprocessing
+    RunBenchmark("CleansedLines (per file)", 1, [&]() {
+        CleansedLines new_lines(lines, options);
+        g_sink = g_sink + new_lines.NumLines();
+    });
+    {
+        CleansedLines reused_lines;
+        RunBenchmark("CleansedLines::Reset (per file)", 1, [&]() {
+            reused_lines.Reset(lines, options);
+            g_sink = g_sink + reused_lines.NumLines();
+        });
+    }
+    {
+        std::vector<std::pair<size_t, size_t>> starts;
+        for (size_t linenum = 0; linenum < num_lines; linenum++) {
+            size_t pos = elided[linenum].find_first_of("({[");
+            if (pos != std::string::npos)
+                starts.emplace_back(linenum, pos);
+        }
+        RunBenchmark("CloseExpression", starts.size(), [&]() {
+            for (const auto& [start_linenum, start_pos] : starts) {
+                size_t linenum = start_linenum;
+                size_t pos = start_pos;
+                const std::string& line = CloseExpression(clean_lines, &linenum, &pos);
+                g_sink = g_sink + line.size() + pos;
+            }
+        });
+    }
+
+    // Checks that use NestingState are measured with NestingState::Update.
+    NestingState nesting_state;
+    auto run_with_state = [&](const char* check_name, auto&& check) {
+        std::string name = "NestingState::Update";
+        if (check_name)
+            name = name + " + " + check_name;
+        RunBenchmark(name, num_lines, [&]() {
+            nesting_state.Clear();
+            for (size_t linenum = 0; linenum < num_lines; linenum++) {
+                nesting_state.Update(clean_lines, elided[linenum], linenum, &linter);
+                check(linenum);
+            }
+        });
+    };
+    run_with_state(nullptr, [](size_t) {});
+    run_with_state("CheckForNamespaceIndentation", [&](size_t linenum) {
+        linter.CheckForNamespaceIndentation(clean_lines, elided[linenum],
+                                            linenum, &nesting_state);
+    });
+    run_with_state("CheckStyleWithState", [&](size_t linenum) {
+        linter.CheckStyleWithState(clean_lines, elided[linenum], linenum, &nesting_state);
+    });
+    run_with_state("CheckSpacing", [&](size_t linenum) {
+        linter.CheckSpacing(clean_lines, elided[linenum], linenum, &nesting_state);
+    });
+    run_with_state("CheckBracesSpacing", [&](size_t linenum) {
+        linter.CheckBracesSpacing(clean_lines, elided[linenum], linenum, &nesting_state);
+    });
+    run_with_state("CheckForNonConstReference", [&](size_t linenum) {
+        linter.CheckForNonConstReference(clean_lines, elided[linenum],
+                                         linenum, &nesting_state);
+    });
+    run_with_state("CheckForNonStandardConstructs", [&](size_t linenum) {
+        linter.CheckForNonStandardConstructs(clean_lines, elided[linenum],
+                                             linenum, &nesting_state);
+    });
+
+    // Checks that use other states
+    {
+        FunctionState function_state;
+        RunBenchmark("CheckForFunctionLengths", num_lines, [&]() {
+            function_state = FunctionState();
+            for (size_t linenum = 0; linenum < num_lines; linenum++)
+                linter.CheckForFunctionLengths(clean_lines, linenum, &function_state);
+        });
+    }
+    {
+        IncludeState include_state;
+        RunBenchmark("CheckLanguage", num_lines, [&]() {
+            include_state.Clear();
+            for (size_t linenum = 0; linenum < num_lines; linenum++) {
+                linter.CheckLanguage(clean_lines, elided[linenum], linenum,
+                                     true, &include_state);
+            }
+        });
+        RunBenchmark("CheckForIncludeWhatYouUse (per file)", 1, [&]() {
+            linter.CheckForIncludeWhatYouUse(clean_lines, &include_state);
+        });
+    }
+
+    // Checks for each line
+    auto run_per_line = [&](const char* name, auto&& check) {
+        RunBenchmark(name, num_lines, [&]() {
+            for (size_t linenum = 0; linenum < num_lines; linenum++)
+                check(elided[linenum], linenum);
+        });
+    };
+    run_per_line("CheckForMultilineCommentsAndStrings",
+                 [&](const std::string& line, size_t linenum) {
+        linter.CheckForMultilineCommentsAndStrings(line, linenum);
+    });
+    run_per_line("CheckStyle", [&](const std::string& line, size_t linenum) {
+        linter.CheckStyle(clean_lines, line, linenum, true);
+    });
+    run_per_line("CheckBraces", [&](const std::string& line, size_t linenum) {
+        linter.CheckBraces(clean_lines, line, linenum);
+    });
+    run_per_line("CheckTrailingSemicolon", [&](const std::string& line, size_t linenum) {
+        linter.CheckTrailingSemicolon(clean_lines, line, linenum);
+    });
+    run_per_line("CheckEmptyBlockBody", [&](const std::string& line, size_t linenum) {
+        linter.CheckEmptyBlockBody(clean_lines, line, linenum);
+    });
+    run_per_line("CheckOperatorSpacing", [&](const std::string& line, size_t linenum) {
+        linter.CheckOperatorSpacing(clean_lines, line, linenum);
+    });
+    run_per_line("CheckParenthesisSpacing", [&](const std::string& line, size_t linenum) {
+        linter.CheckParenthesisSpacing(line, linenum);
+    });
+    run_per_line("CheckCommaSpacing", [&](const std::string& line, size_t linenum) {
+        linter.CheckCommaSpacing(clean_lines, line, linenum);
+    });
+    run_per_line("CheckSpacingForFunctionCall", [&](const std::string& line, size_t linenum) {
+        linter.CheckSpacingForFunctionCall(line, linenum);
+    });
+    run_per_line("CheckCheck", [&](const std::string& line, size_t linenum) {
+        linter.CheckCheck(clean_lines, line, linenum);
+    });
+    run_per_line("CheckAltTokens", [&](const std::string& line, size_t linenum) {
+        linter.CheckAltTokens(line, linenum);
+    });
+    run_per_line("CheckCasts", [&](const std::string& line, size_t linenum) {
+        linter.CheckCasts(clean_lines, line, linenum);
+    });
+    run_per_line("CheckGlobalStatic", [&](const std::string& line, size_t linenum) {
+        linter.CheckGlobalStatic(line, linenum);
+    });
+    run_per_line("CheckPrintf", [&](const std::string& line, size_t linenum) {
+        linter.CheckPrintf(line, linenum);
+    });
+    run_per_line("CheckVlogArguments", [&](const std::string& line, size_t linenum) {
+        linter.CheckVlogArguments(line, linenum);
+    });
+    run_per_line("CheckPosixThreading", [&](const std::string& line, size_t linenum) {
+        linter.CheckPosixThreading(line, linenum);
+    });
+    run_per_line("CheckInvalidIncrement", [&](const std::string& line, size_t linenum) {
+        linter.CheckInvalidIncrement(line, linenum);
+    });
+    run_per_line("CheckMakePairUsesDeduction", [&](const std::string& line, size_t linenum) {
+        linter.CheckMakePairUsesDeduction(line, linenum);
+    });
+    run_per_line("CheckRedundantVirtual", [&](const std::string& line, size_t linenum) {
+        linter.CheckRedundantVirtual(clean_lines, line, linenum);
+    });
+    run_per_line("CheckRedundantOverrideOrFinal", [&](const std::string& line, size_t linenum) {
+        linter.CheckRedundantOverrideOrFinal(clean_lines, line, linenum);
+    });
+    run_per_line("CheckCxxHeaders", [&](const std::string& line, size_t linenum) {
+        linter.CheckCxxHeaders(line, linenum);
+    });
+
+    // Whole files
+    {
+        const std::vector<std::string> nested_lines = MakeNestedStructs(5000);
+        std::vector<std::string> file_lines;
+        RunBenchmark("ProcessFileData (5000 nested structs)", 1, [&]() {
+            file_lines = nested_lines;
+            linter.ProcessFileData(file_lines);
+        });
+        const std::vector<std::string> init_lines = MakeInitializerList(5000);
+        RunBenchmark("ProcessFileData (5000 member initializers)", 1, [&]() {
+            file_lines = init_lines;
+            linter.ProcessFileData(file_lines);
+        });
+    }
+
+    // Checks for each file
+    RunBenchmark("CheckForCopyright (per file)", 1, [&]() {
+        linter.CheckForCopyright(raw_lines);
+    });
+    RunBenchmark("CheckForHeaderGuard (per file)", 1, [&]() {
+        linter.CheckForHeaderGuard(clean_lines);
+    });
+    RunBenchmark("CheckForNewlineAtEOF (per file)", 1, [&]() {
+        linter.CheckForNewlineAtEOF(raw_lines);
+    });
+
+    // Error filters
+    {
+        Options filter_options;
+        filter_options.AddFilters("-whitespace,+whitespace/braces,-build/include_order,"
+                                  "-readability/casting:sample/widget.h,-runtime/int");
+        const std::vector<ErrorCategory> categories = {
+            "whitespace/braces", "whitespace/indent", "build/include_order",
+            "readability/casting", "runtime/int", "legal/copyright",
+        };
+        const std::string filename = "sample/widget.h";
+        RunBenchmark("Options::ShouldPrintError", categories.size(), [&]() {
+            size_t linenum = 1;
+            for (ErrorCategory category : categories)
+                g_sink = g_sink + filter_options.ShouldPrintError(category, filename, linenum++);
+        });
+
+        // Filters resolved once per file. All of them are filtered, so nothing is printed.
+        const std::vector<ErrorCategory> filtered_categories = {
+            "whitespace/indent", "build/include_order", "readability/casting",
+            "runtime/int", "whitespace/tab", "whitespace/comma",
+        };
+        FileLinter filter_linter(file, &cpplint_state, filter_options);
+        RunBenchmark("FileLinter::Error (filtered)", filtered_categories.size(), [&]() {
+            size_t linenum = 1;
+            for (ErrorCategory category : filtered_categories)
+                filter_linter.Error(linenum++, category, 5, "message");
+        });
+        g_sink = g_sink + cpplint_state.ErrorCount();
+    }
+
+    // Regex wrappers
+    {
+        static const regex_code re_search = RegexCompile(R"(\w+\s*\()");
+        static const regex_code re_jit = RegexJitCompile(R"(\w+\s*\()");
+        static const regex_code re_match = RegexCompile(R"(\s*(\w+)\s*=)");
+        static const regex_code re_replace = RegexCompile(R"(\s+)");
+        static const RegexSet re_set({
+            R"(\bstatic_cast\b)",
+            R"(\bconst_cast\b)",
+            R"(\breinterpret_cast\b)",
+            R"(\bprintf\b)",
+        });
+        regex_match match = RegexCreateMatchData(16);
+        run_per_line("RegexSearch", [&](const std::string& line, size_t) {
+            g_sink = g_sink + RegexSearch(re_search, line, match);
+        });
+        run_per_line("RegexJitSearch", [&](const std::string& line, size_t) {
+            g_sink = g_sink + RegexJitSearch(re_jit, line, match);
+        });
+        run_per_line("RegexMatch", [&](const std::string& line, size_t) {
+            g_sink = g_sink + RegexMatch(re_match, line, match);
+        });
+        run_per_line("RegexReplace", [&](const std::string& line, size_t) {
+            g_sink = g_sink + RegexReplace(re_replace, " ", line).size();
+        });
+        run_per_line("RegexSet::Search", [&](const std::string& line, size_t) {
+            g_sink = g_sink + re_set.Search(line);
+        });
+        RunBenchmark("RegexCompile", 1, [&]() {
+            regex_code code = RegexCompile(R"(^\s*(\w+)\s*::\s*(\w+)\s*\()");
+            g_sink = g_sink + (code != nullptr);
+        });
+    }
+
+    cpplint_state.FlushThreadStream();
+    return 0;
+}
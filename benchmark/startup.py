@@ -0,0 +1,69 @@
+# Script to measure the startup latency of cpplint-cpp on a single file.
+# It's the typical case of editor-on-save linting.
+
+import argparse
+import os
+import subprocess
+import statistics
+import tempfile
+import time
+
+from gen_corpus import add_corpus_args, generate_corpus
+
+
+def measure_latency(command, count=100):
+    times = []
+    for i in range(count):
+        start_time = time.perf_counter()  # Record start time
+        # Execute the command
+        subprocess.run(
+            command, shell=True,
+            stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+        end_time = time.perf_counter()  # Record end time
+        times.append(end_time - start_time)
+    return times
+
+
+def get_args():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("file", nargs="?", default=None,
+                        help="path to a source file. "
+                             "Default to a synthetic file made by gen_corpus.py")
+    parser.add_argument("--cpplint_cpp", default="./build/cpplint-cpp", type=str,
+                        help="path to cpplint-cpp")
+    parser.add_argument("--options", default="--quiet", type=str,
+                        help="options for cpplint")
+    parser.add_argument("--count", default=100, type=int,
+                        help="Number of runs. Default to 100")
+    add_corpus_args(parser.add_argument_group("corpus options (used without file)"))
+    return parser.parse_args()
+
+
+def run(args, file):
+    cmd = f"{args.cpplint_cpp} {args.options} {file}"
+
+    if os.name == 'nt':
+        # Fix paths for Windows
+        cmd = cmd.replace("/", "\\")
+
+    # Measuring
+    print(f"Measuring startup latency: {cmd}")
+    times = measure_latency(cmd, args.count)
+
+    # Output result
+    times_ms = [t * 1000 for t in times]
+    print(f"Median: {statistics.median(times_ms):.3f} ms")
+    print(f"Min: {min(times_ms):.3f} ms")
+    print(f"Max: {max(times_ms):.3f} ms")
+
+
+if __name__ == '__main__':
+    args = get_args()
+    if args.file is not None:
+        run(args, args.file)
+    else:
+        with tempfile.TemporaryDirectory() as temp_dir:
+            # Use the first source file of a corpus.
+            args.files = 2
+            paths, _ = generate_corpus(os.path.join(temp_dir, "corpus"), args)
+            run(args, next(p for p in paths if p.endswith(".cc")))
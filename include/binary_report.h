@@ -0,0 +1,139 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/* Binary format for --output=binary
+
+    A stream starts with the 8-byte magic "CPPLINTB" and a uint32 version.
+    It is followed by records. Every record starts with a uint32 payload size
+    and a uint8 record type. All integers are little-endian.
+
+    BINARY_RECORD_STRING: bytes of a string.
+        Defines an interned string. IDs are assigned from 0 in order.
+    BINARY_RECORD_ERROR: uint32 file ID, uint32 line number, uint32 category ID,
+        uint32 template ID, uint8 confidence, uint8 number of arguments,
+        and a pair of uint32 offset and uint32 value for each argument.
+
+    A template is a message without its numbers. Each argument is a number
+    inserted at an offset of the template, so messages that only differ in
+    numbers share their template. (e.g. "Lines should be <= 80 characters long"
+    is "Lines should be <=  characters long" with 80 at offset 19.)
+
+    A string is always defined before the first error that refers to it,
+    so readers can process a memory-mapped file in one pass.
+*/
+
+constexpr char BINARY_MAGIC[] = "CPPLINTB";
+constexpr size_t BINARY_MAGIC_SIZE = sizeof(BINARY_MAGIC) - 1;
+constexpr uint32_t BINARY_VERSION = 2;
+
+// The size of an error record without arguments
+constexpr uint32_t BINARY_ERROR_SIZE = 18;
+// The size of an argument of an error record
+constexpr uint32_t BINARY_ARG_SIZE = 8;
+
+enum : uint8_t {
+    BINARY_RECORD_STRING = 1,
+    BINARY_RECORD_ERROR = 2,
+};
+
+// Writes errors as binary records.
+// This class is not thread-safe. CppLintState calls it with a lock.
+class BinaryWriter {
+ private:
+    // Hashes std::string_view, so strings are looked up without copies.
+    struct StringHash {
+        using is_transparent = void;
+        size_t operator()(std::string_view str) const noexcept {
+            return std::hash<std::string_view>{}(str);
+        }
+    };
+
+    std::unordered_map<std::string, uint32_t, StringHash, std::equal_to<>> m_string_ids;
+    std::string m_buffer;
+
+    // Buffers to split a message into a template and arguments
+    std::string m_template;
+    std::vector<std::pair<uint32_t, uint32_t>> m_args;
+
+    void WriteUint32(uint32_t val);
+    void WriteRecordHeader(uint32_t payload_size, uint8_t type);
+
+    // Returns an ID for a string. It writes a string record for new strings.
+    uint32_t InternString(std::string_view str);
+
+ public:
+    BinaryWriter() : m_string_ids({}), m_buffer(""), m_template(""), m_args({}) {}
+
+    void WriteHeader();
+    void WriteError(std::string_view filename, size_t linenum,
+                    std::string_view category, int confidence,
+                    std::string_view message);
+
+    const std::string& Buffer() const { return m_buffer; }
+    void ClearBuffer() { m_buffer.clear(); }
+};
+
+// A binary output mapped into memory.
+// It falls back to reading the whole file when mmap is not available.
+class MappedFile {
+ private:
+    void* m_ptr;
+    size_t m_size;
+    std::string m_content;  // Used when the file is not mapped
+
+ public:
+    MappedFile() : m_ptr(nullptr), m_size(0), m_content("") {}
+    ~MappedFile() { Close(); }
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // Returns false when the file can't be opened.
+    bool Open(const std::string& filename);
+    void Close();
+
+    std::string_view Data() const;
+};
+
+struct BinaryError {
+    std::string_view filename;
+    size_t linenum;
+    std::string_view category;
+    int confidence;
+    std::string_view message;
+};
+
+// Reads errors from binary records.
+// The data should be alive while using the reader and returned errors.
+// A returned message is only valid until the next ReadError() call.
+class BinaryReader {
+ private:
+    std::string_view m_data;
+    size_t m_pos;
+    std::vector<std::string_view> m_strings;
+    std::string m_message;  // A template filled with arguments
+    std::string m_error_message;
+
+    bool ReadUint32(uint32_t* val);
+    bool SetError(const std::string& message) {
+        // Stop reading broken data
+        m_error_message = message;
+        m_pos = m_data.size();
+        return false;
+    }
+
+ public:
+    explicit BinaryReader(std::string_view data);
+
+    // Reads the next error.
+    // Returns false at the end of data or when the data is broken.
+    bool ReadError(BinaryError* error);
+
+    // Returns a non-empty string when the data is broken.
+    const std::string& ErrorMessage() const { return m_error_message; }
+};
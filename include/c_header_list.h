@@ -1,9 +1,10 @@
 #pragma once
-#include <string>
+#include <string_view>
 #include <utility>
+#include "perfect_hash.h"
 
 // C++ headers
-inline const char* const CPP_HEADERS[] = {
+inline constexpr const char* CPP_HEADERS[] = {
     // Legacy
     "algobase.h",
     "algo.h",
@@ -179,7 +180,7 @@ inline const char* const CPP_HEADERS[] = {
 };
 
 // C headers
-inline const char* const C_HEADERS[] = {
+inline constexpr const char* C_HEADERS[] = {
     // System C headers
     "assert.h",
     "complex.h",
@@ -337,7 +338,7 @@ inline const char* const C_HEADERS[] = {
 
 // Folders of C libraries so commonly used in C++,
 // that they have parity with standard C libraries.
-inline const char* const C_STANDARD_HEADER_FOLDERS[] = {
+inline constexpr const char* C_STANDARD_HEADER_FOLDERS[] = {
     // standard C library
     "sys",
     // glibc for linux
@@ -363,15 +364,21 @@ inline const char* const C_STANDARD_HEADER_FOLDERS[] = {
     nullptr,
 };
 
-inline std::string GetHeaderFoldersPattern() {
-    std::string pattern = "(?:";
-    const char* const *folder_p = C_STANDARD_HEADER_FOLDERS;
-    while (*folder_p != nullptr) {
-        pattern += *folder_p;
-        pattern += "|";
-        folder_p++;
+// Lookup tables for the header lists
+inline constexpr PerfectHashSet<CountStrArray(CPP_HEADERS)> CPP_HEADER_SET(CPP_HEADERS);
+inline constexpr PerfectHashSet<CountStrArray(C_HEADERS)> C_HEADER_SET(C_HEADERS);
+
+// Same as RegexSearch(R"((?:sys|arpa|...)\/.*\.h)", include)
+inline bool InHeaderFolders(std::string_view include) {
+    size_t slash = include.find('/');
+    while (slash != std::string_view::npos) {
+        std::string_view dir = include.substr(0, slash);
+        for (const char* const *folder_p = C_STANDARD_HEADER_FOLDERS;
+             *folder_p != nullptr; folder_p++) {
+            if (dir.ends_with(*folder_p))
+                return include.find(".h", slash + 1) != std::string_view::npos;
+        }
+        slash = include.find('/', slash + 1);
     }
-    pattern.pop_back();
-    pattern += R"()\/.*\.h)";
-    return pattern;
+    return false;
 }
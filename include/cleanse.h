@@ -1,11 +1,13 @@
 #pragma once
 #include <string>
+#include <string_view>
 #include <vector>
 #include "options.h"
 #include "regex_utils.h"
 #include "string_utils.h"
 
-extern const regex_code RE_PATTERN_INCLUDE;
+// Pattern for #include lines. It is compiled on first use.
+const regex_code& GetIncludePattern();
 
 // Get regex pattern for RE_PATTERN_ALT_TOKEN_REPLACEMENT
 std::string GetReAltTokenReplacement();
@@ -24,10 +26,17 @@ const std::string& AltTokenToToken(const std::string& alt_token);
     True, if next character appended to 'line' is inside a
     string constant.
 */
-bool IsCppString(const std::string& line);
+bool IsCppString(std::string_view line);
 
 // Removes //-comments and single-line C-style /* */ comments.
-std::string CleanseComments(const std::string& line, bool* is_comment);
+// The result is written to new_line to reuse its buffer.
+void CleanseComments(const std::string& line, bool* is_comment, std::string* new_line);
+
+inline std::string CleanseComments(const std::string& line, bool* is_comment) {
+    std::string new_line;
+    CleanseComments(line, is_comment, &new_line);
+    return new_line;
+}
 
 class CleansedLines {
     /*Holds 4 copies of all lines with different preprocessing applied to them.
@@ -38,18 +47,65 @@ class CleansedLines {
     4) lines_without_raw_strings member is same as raw_lines, but with C++11 raw
         strings removed.
     All these members are of <type 'list'>, and of the same length.
+
+    Lines can be a window of a stream. Line numbers are counted from the
+    beginning of the stream, and m_first_line is the line number of the first
+    line in the window.
     */
  private:
+    size_t m_first_line;
     std::vector<std::string> m_elided;
     std::vector<std::string> m_lines;
-    std::vector<std::string>& m_raw_lines;
+    std::vector<std::string>* m_raw_lines;
     std::vector<std::string> m_lines_without_raw_strings;
     std::vector<bool> m_has_comment;
     regex_match m_re_result;
+    // Buffer for CollapseStrings()
+    std::string m_collapse_buffer;
+
+    // Block extents computed in Reset(). See GetBlockEnd() and FindBodyStart().
+    std::vector<size_t> m_block_ends;
+    std::vector<size_t> m_body_starts;
+    // Buffers to compute m_block_ends
+    std::vector<ptrdiff_t> m_brace_depths;
+    std::vector<size_t> m_depth_lines;
+
+    // Statement boundaries computed in Reset(). They bound backward scans of checks.
+    std::vector<size_t> m_prev_non_blank_lines;
+    std::vector<size_t> m_prev_statement_ends;
+    std::vector<size_t> m_disallow_lines;
+
+    void ComputeBlockExtents();
+    void ComputeStatementBoundaries();
 
  public:
+    CleansedLines() :
+        m_first_line(0),
+        m_elided({}),
+        m_lines({}),
+        m_raw_lines(nullptr),
+        m_lines_without_raw_strings({}),
+        m_has_comment({}),
+        m_re_result(RegexCreateMatchData(16)),
+        m_collapse_buffer(),
+        m_block_ends({}),
+        m_body_starts({}),
+        m_brace_depths({}),
+        m_depth_lines({}),
+        m_prev_non_blank_lines({}),
+        m_prev_statement_ends({}),
+        m_disallow_lines({}) {}
+
     CleansedLines(std::vector<std::string>& lines,
-                  const Options& options);
+                  const Options& options) : CleansedLines() {
+        Reset(lines, options);
+    }
+
+    // Processes lines of a new file. Allocated buffers are reused.
+    // first_line is the line number of lines[0] when lines are a window of a stream.
+    void Reset(std::vector<std::string>& lines,
+               const Options& options,
+               size_t first_line = 0);
 
     /*Removes C++11 raw strings from lines.
 
@@ -63,13 +119,14 @@ class CleansedLines {
           (replaced by blank line)
           "";
     */
-    std::vector<std::string> CleanseRawStrings(const std::vector<std::string>& raw_lines);
+    void CleanseRawStrings(const std::vector<std::string>& raw_lines,
+                           std::vector<std::string>* lines_without_raw_strings);
 
     /*
       Collapses strings and chars on a line to simple "" or '' blocks.
       We nix strings first so we're not fooled by text like '"http://"'
     */
-    std::string CollapseStrings(const std::string& elided);
+    void CollapseStrings(const std::string& elided, std::string* collapsed);
 
     /*
     Replace any alternate token by its original counterpart.
@@ -79,22 +136,53 @@ class CleansedLines {
     alternate tokens. For these, any trailing space is removed during the
     conversion.
     */
-    std::string ReplaceAlternateTokens(const std::string& line);
+    void ReplaceAlternateTokens(std::string* line);
+
+    // Returns the line number of the first line. Lines before it are not available.
+    size_t FirstLine() const { return m_first_line; }
 
-    size_t NumLines() const { return m_lines.size(); }
+    // Returns the line number after the last line.
+    size_t NumLines() const { return m_first_line + m_lines.size(); }
 
-    const std::string& GetLineAt(size_t id) const { return m_lines[id]; }
-    const std::string& GetElidedAt(size_t id) const { return m_elided[id]; }
+    const std::string& GetLineAt(size_t id) const { return m_lines[id - m_first_line]; }
+    const std::string& GetElidedAt(size_t id) const { return m_elided[id - m_first_line]; }
     const std::vector<std::string>& GetElidedLines() const {
         return m_elided;
     }
-    const std::string& GetRawLineAt(size_t id) const { return m_raw_lines[id]; }
+    const std::string& GetRawLineAt(size_t id) const {
+        return (*m_raw_lines)[id - m_first_line];
+    }
     const std::string& GetLineWithoutRawStringAt(size_t id) const {
-        return m_lines_without_raw_strings[id];
+        return m_lines_without_raw_strings[id - m_first_line];
     }
     const std::vector<std::string>& GetLinesWithoutRawStrings() const {
         return m_lines_without_raw_strings;
     }
 
-    bool HasComment(size_t id) const { return m_has_comment[id]; }
+    bool HasComment(size_t id) const { return m_has_comment[id - m_first_line]; }
+
+    // Returns the first line where the numbers of { and } in elided lines
+    // from linenum are balanced, or INDEX_NONE.
+    // Note that a line without braces is balanced by itself.
+    size_t GetBlockEnd(size_t linenum) const { return m_block_ends[linenum - m_first_line]; }
+
+    // Returns the first line from linenum that has {, } or ; in lines
+    // without comments, or INDEX_NONE.
+    size_t FindBodyStart(size_t linenum) const {
+        return m_body_starts[linenum - m_first_line];
+    }
+
+    // Returns the last non-blank elided line before linenum, or INDEX_NONE.
+    size_t GetPrevNonBlankLine(size_t linenum) const {
+        return m_prev_non_blank_lines[linenum - m_first_line];
+    }
+
+    // Returns the last elided line before linenum that ends with {, } or ;,
+    // or INDEX_NONE.
+    size_t GetPrevStatementEnd(size_t linenum) const {
+        return m_prev_statement_ends[linenum - m_first_line];
+    }
+
+    // Returns sorted line numbers of elided lines that have "DISALLOW_".
+    const std::vector<size_t>& GetDisallowLines() const { return m_disallow_lines; }
 };
@@ -28,3 +28,5 @@ constexpr size_t INDEX_MAX = SIZE_MAX - 1;
 // Macros for characters
 #define IS_SPACE(c) isspace((uint8_t)(c))
 #define IS_DIGIT(c) isdigit((uint8_t)(c))
+// Same as \w in regex patterns
+#define IS_WORD_CHAR(c) (isalnum((uint8_t)(c)) || (c) == '_')
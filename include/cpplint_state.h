@@ -1,10 +1,17 @@
 #pragma once
+#include <array>
+#include <condition_variable>
+#include <cstdint>
 #include <map>
 #include <mutex>
 #include <string>
+#include <string_view>
+#include <thread>
 #include <utility>
 #include <vector>
+#include "binary_report.h"
 #include "common.h"
+#include "error_categories.h"
 
 enum : int {
     COUNT_TOTAL,
@@ -20,9 +27,21 @@ enum : int {
     OUTPUT_JUNIT,
     OUTPUT_SED,
     OUTPUT_GSED,
+    OUTPUT_SARIF,
+    OUTPUT_NDJSON,
+    OUTPUT_BINARY,
     OUTPUT_MAX,
 };
 
+// An error kept for --watch. It's compared with errors of the next run.
+struct ErrorRecord {
+    std::string filename;
+    size_t linenum;
+    std::string category;
+    int confidence;
+    std::string message;
+};
+
 class CppLintState {
     // Maintains module-wide state..
  private:
@@ -32,6 +51,12 @@ class CppLintState {
     int m_counting;  // In what way are we counting errors?
     // string to int dict storing error counts
     std::map<std::string, int> m_errors_by_category;
+    // Detailed error counts for --shard-summary
+    bool m_shard_summary;
+    std::map<std::string, int> m_shard_counts;
+    // Counts of interned categories. They are merged into the maps above
+    // when the counts are printed, so errors don't look up strings.
+    std::array<int, NUM_ERROR_CATEGORIES> m_category_counts;
     bool m_quiet;  // Suppress non-error messagess?
 
     /* output format:
@@ -41,6 +66,9 @@ class CppLintState {
      * "junit" - format that Jenkins, Bamboo, etc can parse
      * "sed" - returns a gnu sed command to fix the problem
      * "gsed" - like sed, but names the command gsed, e.g. for macOS homebrew users
+     * "sarif" - SARIF 2.1.0 log that code scanning services can ingest
+     * "ndjson" - one JSON object per line for each error
+     * "binary" - compact records that cpplint-report can merge
      */
     int m_output_format;
 
@@ -54,6 +82,62 @@ class CppLintState {
 
     int m_num_threads;
 
+    // True after the first SARIF result has been written to stdout.
+    // Results are separated by commas when flushing thread streams.
+    bool m_sarif_has_result;
+
+    // String-interned records for binary output.
+    // It's shared by all threads to keep string IDs consistent.
+    BinaryWriter m_binary_writer;
+
+    // Output stage of the pipeline.
+    // While the writer thread is running, outputs are appended to pending strings,
+    // and the thread writes them to stdout and stderr without locking m_mtx.
+    std::thread m_writer;
+    std::condition_variable m_writer_cv;
+    std::condition_variable m_writer_space_cv;
+    bool m_writer_running;
+    std::string m_pending_out;
+    std::string m_pending_err;
+    int64_t m_writer_busy_ns;
+    bool m_sync_requested;
+
+    // Errors kept for --watch
+    bool m_record_errors;
+    bool m_print_errors;
+    std::vector<ErrorRecord> m_error_records;
+
+    void WriterLoop();
+
+    // Adds a count to the maps of categories.
+    void AddCategoryCount(const std::string& category, int count);
+    void MergeCategoryCounts();
+
+    // Writes an error to thread local buffers. Returns false when the error is
+    // only recorded. (See SetErrorRecording())
+    bool FormatError(const std::string& filename, size_t linenum,
+                     std::string_view category, int confidence,
+                     std::string_view message);
+
+    // Writes binary records and flushes large buffers.
+    // m_mtx should be locked before calling this.
+    void FlushErrorBuffers(const std::string& filename, size_t linenum,
+                           std::string_view category, int confidence,
+                           std::string_view message);
+
+    // Writes a string to stdout or stderr, or passes it to the writer thread.
+    // m_mtx should be locked before calling these.
+    void WriteOut(const std::string& str);
+    void WriteErr(const std::string& str);
+
+    // Writes the thread local cout buffer to stdout.
+    // m_mtx should be locked before calling this.
+    void FlushCoutBuffer();
+
+    // Writes binary records to stdout.
+    // m_mtx should be locked before calling this.
+    void FlushBinaryBuffer();
+
  public:
     CppLintState();
 
@@ -70,6 +154,12 @@ class CppLintState {
             m_output_format = OUTPUT_SED;
         else if (output_format == "gsed")
             m_output_format = OUTPUT_GSED;
+        else if (output_format == "sarif")
+            m_output_format = OUTPUT_SARIF;
+        else if (output_format == "ndjson")
+            m_output_format = OUTPUT_NDJSON;
+        else if (output_format == "binary")
+            m_output_format = OUTPUT_BINARY;
         else
             m_output_format = OUTPUT_EMACS;
     }
@@ -104,8 +194,13 @@ class CppLintState {
         // Sets the module's error statistic back to zero.
         m_error_count = 0;
         m_errors_by_category.clear();
+        m_shard_counts.clear();
+        m_category_counts.fill(0);
     }
 
+    // Counts errors for each category regardless of the counting style.
+    void SetShardSummary(bool shard_summary) { m_shard_summary = shard_summary; }
+
     int ErrorCount() const { return m_error_count; }
     int ErrorCount(const std::string& category) const;
 
@@ -113,20 +208,69 @@ class CppLintState {
     int GetNumThreads() const { return m_num_threads; }
 
     // Bumps the module's error statistic.
-    void IncrementErrorCount(const std::string& category);
+    void IncrementErrorCount(const std::string& category, int count = 1);
+    void IncrementErrorCount(ErrorCategory category) {
+        m_error_count++;
+        m_category_counts[category.Id()]++;
+    }
+
+    // Writes error counts of the current shard. The file can be merged with
+    // ReadShardSummary(). Returns false when failed to open the file.
+    bool WriteShardSummary(const std::string& path, size_t shard_index,
+                           size_t shard_count, size_t num_files);
+
+    // Adds error counts from a file written by WriteShardSummary().
+    // shard will be the "i/N" string of the summary.
+    // Returns false when the file is not a valid summary.
+    bool ReadShardSummary(const std::string& path, std::string* shard);
 
     // Outputs an error.
     // This should be called from FileLinter::Error to check filters
+    void Error(const std::string& filename, size_t linenum,
+               ErrorCategory category, int confidence,
+               std::string_view message);
+
+    // Outputs an error from records of other runs. (e.g. --watch and cpplint-report)
     void Error(const std::string& filename, size_t linenum,
                const std::string& category, int confidence,
                const std::string& message);
 
+    // Keeps errors passed to Error(). When print is false, they are neither printed
+    // nor counted, so the caller can decide what to print.
+    void SetErrorRecording(bool record, bool print = true);
+
+    // Returns recorded errors and clears them.
+    std::vector<ErrorRecord> TakeErrorRecords();
+
     // Flush buffers for cout and cerr
     void FlushThreadStream();
 
+    // Starts a thread that writes outputs, so workers don't wait for stdout and stderr.
+    // FlushThreadStream() still blocks when the thread is too far behind.
+    void StartWriter();
+
+    // Writes pending outputs and stops the writer thread.
+    void StopWriter();
+
+    // Waits for the writer thread to write pending outputs, and flushes stdout.
+    // Outputs of other threads should be flushed before calling this.
+    void SyncWriter();
+
+    // Time the writer thread spent on writing outputs.
+    // It should be called after StopWriter().
+    int64_t WriterBusyNs() const { return m_writer_busy_ns; }
+
     // Get error buffer as string
     std::string GetErrorStreamAsStr();
 
+    // Get output buffer as string
+    std::string GetOutputStreamAsStr();
+
+    // Print the beginning and the end of a document for structured outputs.
+    // These should be called before and after processing all files.
+    void PrintOutputHeader();
+    void PrintOutputFooter();
+
     // Print a summary of errors by category, and the total.
     void PrintErrorCounts();
     void PrintInfo(const std::string& message);
@@ -134,8 +278,8 @@ class CppLintState {
 
     bool AddJUnitFailure(const std::string& filename,
                          size_t linenum,
-                         const std::string& message,
-                         const std::string& category,
+                         std::string_view message,
+                         std::string_view category,
                          int confidence) {
         UNUSED(filename);
         UNUSED(linenum);
@@ -0,0 +1,130 @@
+#pragma once
+#include <bitset>
+#include <cstdint>
+#include <string_view>
+#include "common.h"
+#include "perfect_hash.h"
+
+// We categorize each error message we print.  Here are the categories.
+// We want an explicit list so we can list them all in cpplint --filter=.
+// If you add a new error message with a new category, add it to the list
+// here!  ErrorCategory makes a compile error if you forget to do this.
+inline constexpr const char* ERROR_CATEGORIES[] = {
+    "build/c++11",
+    "build/c++17",
+    "build/deprecated",
+    "build/endif_comment",
+    "build/explicit_make_pair",
+    "build/forward_decl",
+    "build/header_guard",
+    "build/include",
+    "build/include_subdir",
+    "build/include_alpha",
+    "build/include_order",
+    "build/include_what_you_use",
+    "build/namespaces_headers",
+    "build/namespaces_literals",
+    "build/namespaces",
+    "build/printf_format",
+    "build/storage_class",
+    "legal/copyright",
+    "readability/alt_tokens",
+    "readability/braces",
+    "readability/casting",
+    "readability/check",
+    "readability/constructors",
+    "readability/fn_size",
+    "readability/inheritance",
+    "readability/multiline_comment",
+    "readability/multiline_string",
+    "readability/namespace",
+    "readability/nolint",
+    "readability/nul",
+    "readability/strings",
+    "readability/todo",
+    "readability/utf8",
+    "runtime/arrays",
+    "runtime/casting",
+    "runtime/explicit",
+    "runtime/int",
+    "runtime/init",
+    "runtime/invalid_increment",
+    "runtime/member_string_references",
+    "runtime/memset",
+    "runtime/operator",
+    "runtime/printf",
+    "runtime/printf_format",
+    "runtime/references",
+    "runtime/string",
+    "runtime/threadsafe_fn",
+    "runtime/vlog",
+    "whitespace/blank_line",
+    "whitespace/braces",
+    "whitespace/comma",
+    "whitespace/comments",
+    "whitespace/empty_conditional_body",
+    "whitespace/empty_if_body",
+    "whitespace/empty_loop_body",
+    "whitespace/end_of_line",
+    "whitespace/ending_newline",
+    "whitespace/forcolon",
+    "whitespace/indent",
+    "whitespace/indent_namespace",
+    "whitespace/line_length",
+    "whitespace/newline",
+    "whitespace/operators",
+    "whitespace/parens",
+    "whitespace/semicolon",
+    "whitespace/tab",
+    "whitespace/todo",
+    nullptr,
+};
+
+inline constexpr size_t NUM_ERROR_CATEGORIES = CountStrArray(ERROR_CATEGORIES);
+
+// Returns the index of a category in ERROR_CATEGORIES, or INDEX_NONE.
+constexpr size_t FindErrorCategory(std::string_view category) {
+    for (size_t i = 0; i < NUM_ERROR_CATEGORIES; i++) {
+        if (category == ERROR_CATEGORIES[i])
+            return i;
+    }
+    return INDEX_NONE;
+}
+
+inline bool InErrorCategories(std::string_view category) {
+    return FindErrorCategory(category) != INDEX_NONE;
+}
+
+// Interned id of an error category. It's an index of ERROR_CATEGORIES.
+// String literals are converted at compile time, so errors don't pass strings
+// to suppressions, filters, and counters.
+class ErrorCategory {
+ private:
+    uint8_t m_id;
+
+    static consteval uint8_t IdOf(const char* category) {
+        size_t id = FindErrorCategory(category);
+        // Throwing in consteval makes a compile error.
+        if (id == INDEX_NONE)
+            throw "Unknown error category. Add it to ERROR_CATEGORIES.";
+        return static_cast<uint8_t>(id);
+    }
+
+ public:
+    // Implicit, so Error() can take a string literal.
+    consteval ErrorCategory(const char* category) :  // NOLINT(runtime/explicit)
+        m_id(IdOf(category)) {}
+
+    // id should be less than NUM_ERROR_CATEGORIES.
+    constexpr explicit ErrorCategory(size_t id) : m_id(static_cast<uint8_t>(id)) {}
+
+    constexpr size_t Id() const { return m_id; }
+    constexpr const char* Name() const { return ERROR_CATEGORIES[m_id]; }
+
+    constexpr bool operator==(const ErrorCategory& other) const = default;
+};
+
+static_assert(NUM_ERROR_CATEGORIES <= UINT8_MAX);
+
+// A set of error categories, indexed by ErrorCategory::Id()
+using ErrorCategorySet = std::bitset<NUM_ERROR_CATEGORIES>;
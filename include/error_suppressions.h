@@ -1,90 +1,13 @@
 #pragma once
+#include <array>
 #include <climits>
-#include <map>
+#include <optional>
 #include <stack>
 #include <string>
 #include <vector>
+#include "error_categories.h"
 #include "string_utils.h"
 
-// We categorize each error message we print.  Here are the categories.
-// We want an explicit list so we can list them all in cpplint --filter=.
-// If you add a new error message with a new category, add it to the list
-// here!  cpplint_unittest.py should tell you if you forget to do this.
-inline const char* const ERROR_CATEGORIES[] = {
-    "build/c++11",
-    "build/c++17",
-    "build/deprecated",
-    "build/endif_comment",
-    "build/explicit_make_pair",
-    "build/forward_decl",
-    "build/header_guard",
-    "build/include",
-    "build/include_subdir",
-    "build/include_alpha",
-    "build/include_order",
-    "build/include_what_you_use",
-    "build/namespaces_headers",
-    "build/namespaces_literals",
-    "build/namespaces",
-    "build/printf_format",
-    "build/storage_class",
-    "legal/copyright",
-    "readability/alt_tokens",
-    "readability/braces",
-    "readability/casting",
-    "readability/check",
-    "readability/constructors",
-    "readability/fn_size",
-    "readability/inheritance",
-    "readability/multiline_comment",
-    "readability/multiline_string",
-    "readability/namespace",
-    "readability/nolint",
-    "readability/nul",
-    "readability/strings",
-    "readability/todo",
-    "readability/utf8",
-    "runtime/arrays",
-    "runtime/casting",
-    "runtime/explicit",
-    "runtime/int",
-    "runtime/init",
-    "runtime/invalid_increment",
-    "runtime/member_string_references",
-    "runtime/memset",
-    "runtime/operator",
-    "runtime/printf",
-    "runtime/printf_format",
-    "runtime/references",
-    "runtime/string",
-    "runtime/threadsafe_fn",
-    "runtime/vlog",
-    "whitespace/blank_line",
-    "whitespace/braces",
-    "whitespace/comma",
-    "whitespace/comments",
-    "whitespace/empty_conditional_body",
-    "whitespace/empty_if_body",
-    "whitespace/empty_loop_body",
-    "whitespace/end_of_line",
-    "whitespace/ending_newline",
-    "whitespace/forcolon",
-    "whitespace/indent",
-    "whitespace/indent_namespace",
-    "whitespace/line_length",
-    "whitespace/newline",
-    "whitespace/operators",
-    "whitespace/parens",
-    "whitespace/semicolon",
-    "whitespace/tab",
-    "whitespace/todo",
-    nullptr,
-};
-
-inline bool InErrorCategories(const std::string& category) {
-    return InStrVec(ERROR_CATEGORIES, category);
-}
-
 // These error categories are no longer enforced by cpplint, but for backwards-
 // compatibility they may still appear in NOLINT comments.
 inline const char* const LEGACY_ERROR_CATEGORIES[] = {
@@ -170,20 +93,39 @@ class LineRange {
 
 class ErrorSuppressions {
  private:
-    std::map<std::string, std::vector<LineRange>> m_suppressions;
+    // Suppressions for each category id.
+    // The last one is for all categories. (NOLINT without categories)
+    static constexpr size_t ALL_CATEGORIES = NUM_ERROR_CATEGORIES;
+    std::array<std::vector<LineRange>, NUM_ERROR_CATEGORIES + 1> m_suppressions;
     std::stack<LineRange*> m_open_block_suppressions;
 
+    static size_t IndexOf(std::optional<ErrorCategory> category) {
+        return category ? category->Id() : ALL_CATEGORIES;
+    }
+
+    static bool Contain(const std::vector<LineRange>& suppressed, size_t linenum) {
+        for (const LineRange& lr : suppressed) {
+            if (lr.Contain(linenum))
+                return true;
+        }
+        return false;
+    }
+
  public:
     ErrorSuppressions() :
-        m_suppressions({}), m_open_block_suppressions() {}
+        m_suppressions(), m_open_block_suppressions() {}
 
     void Clear() {
-        m_suppressions.clear();
+        // Vectors are cleared to reuse their buffers for the next file.
+        for (std::vector<LineRange>& suppressed : m_suppressions)
+            suppressed.clear();
         m_open_block_suppressions = {};
     }
 
-    LineRange* AddSuppression(const std::string& category, const LineRange& line_range) {
-        std::vector<LineRange>& suppressed = m_suppressions[category];
+    // category is std::nullopt for all categories.
+    LineRange* AddSuppression(std::optional<ErrorCategory> category,
+                              const LineRange& line_range) {
+        std::vector<LineRange>& suppressed = m_suppressions[IndexOf(category)];
         if (suppressed.empty() || !suppressed.back().ContainRange(line_range)) {
             suppressed.push_back(line_range);
             return &suppressed.back();
@@ -191,15 +133,15 @@ class ErrorSuppressions {
         return nullptr;
     }
 
-    void AddGlobalSuppression(const std::string& category) {
+    void AddGlobalSuppression(ErrorCategory category) {
         AddSuppression(category, LineRange(0, INDEX_MAX));
     }
 
-    void AddLineSuppression(const std::string& category, size_t linenum) {
+    void AddLineSuppression(std::optional<ErrorCategory> category, size_t linenum) {
         AddSuppression(category, LineRange(linenum, linenum));
     }
 
-    void StartBlockSuppression(const std::string& category, size_t linenum) {
+    void StartBlockSuppression(std::optional<ErrorCategory> category, size_t linenum) {
         LineRange* open_block = AddSuppression(category, LineRange(linenum, INDEX_MAX));
         m_open_block_suppressions.push(open_block);
     }
@@ -223,49 +165,24 @@ class ErrorSuppressions {
         return INDEX_NONE;
     }
 
-    bool IsSuppressed(const std::string& category, size_t linenum) {
-        // Check the non-category suppressions
-        for (const LineRange& lr : m_suppressions[""]) {
-            if (lr.Contain(linenum))
-                return true;
-        }
-
-        // Check a category
-        auto it = m_suppressions.find(category);
-        if (it == m_suppressions.end())
-            return false;
-        const std::vector<LineRange>& suppressed = it->second;
-        for (const LineRange& lr : suppressed) {
-            if (lr.Contain(linenum))
-                return true;
-        }
-        return false;
+    bool IsSuppressed(ErrorCategory category, size_t linenum) const {
+        // Check the non-category suppressions, then the category.
+        return Contain(m_suppressions[ALL_CATEGORIES], linenum) ||
+               Contain(m_suppressions[category.Id()], linenum);
     }
 
-    bool IsSuppressed(size_t linenum) {
+    bool IsSuppressed(size_t linenum) const {
         // Check the non-category suppressions
-        for (const LineRange& lr : m_suppressions[""]) {
-            if (lr.Contain(linenum))
-                return true;
-        }
-        return false;
+        return Contain(m_suppressions[ALL_CATEGORIES], linenum);
     }
 
     bool HasOpenBlock() { return !m_open_block_suppressions.empty(); }
 
     void AddDefaultCSuppressions() {
-        static const std::vector<std::string> DEFAULT_C_SUPPRESSED_CATEGORIES = {
-            "readability/casting",
-        };
-        for (const std::string& category : DEFAULT_C_SUPPRESSED_CATEGORIES)
-            AddGlobalSuppression(category);
+        AddGlobalSuppression("readability/casting");
     }
 
     void AddDefaultKernelSuppressions() {
-        static const std::vector<std::string> DEFAULT_KERNEL_SUPPRESSED_CATEGORIES = {
-            "whitespace/tab",
-        };
-        for (const std::string& category : DEFAULT_KERNEL_SUPPRESSED_CATEGORIES)
-            AddGlobalSuppression(category);
+        AddGlobalSuppression("whitespace/tab");
     }
 };
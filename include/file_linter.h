@@ -1,10 +1,18 @@
 #pragma once
+#include <atomic>
+#include <cstdint>
 #include <filesystem>
+#include <istream>
+#include <map>
 #include <set>
 #include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
 #include "cleanse.h"
+#include "common.h"
 #include "cpplint_state.h"
+#include "error_categories.h"
 #include "error_suppressions.h"
 #include "options.h"
 #include "regex_utils.h"
@@ -12,12 +20,77 @@
 
 namespace fs = std::filesystem;
 
+// Line-local checks of files with at least this many lines run on other threads.
+// Each thread checks at least this many lines.
+inline constexpr size_t PARALLEL_CHUNK_LINES = 20000;
+
+// Counts workers of LintPipeline that are waiting for files.
+// Line-local checks of a large file only run on as many extra threads as there
+// are idle workers, so large files checked at once don't start more threads
+// than --threads. They run on the worker's thread when all workers are busy.
+class IdleWorkers {
+ private:
+    std::atomic<int64_t> m_count;
+
+ public:
+    IdleWorkers() : m_count(0) {}
+
+    // Workers add 1 when they wait for a file, and -1 when they get one.
+    void Add(int64_t count) { m_count.fetch_add(count); }
+
+    // Takes up to max idle workers. Returns the number of taken workers.
+    size_t TryTake(size_t max) {
+        int64_t count = m_count.load();
+        while (count > 0) {
+            int64_t taken = MIN(count, static_cast<int64_t>(max));
+            if (m_count.compare_exchange_weak(count, count - taken))
+                return static_cast<size_t>(taken);
+        }
+        return 0;
+    }
+
+    // Gives back workers taken with TryTake().
+    void Release(size_t count) { m_count.fetch_add(static_cast<int64_t>(count)); }
+
+    int64_t Count() const { return m_count.load(); }
+};
+
+// Linting a file uses about this many times its size in memory.
+// (The content, lines, four copies of them in CleansedLines, and string headers)
+inline constexpr size_t LINT_MEMORY_PER_BYTE = 12;
+
+// Stdin is checked with a window of this many lines.
+// A quarter of them is the lookbehind of checks, and another quarter is the lookahead.
+inline constexpr size_t STREAM_WINDOW_LINES = 4096;
+// Checks look behind up to 10 lines, so the window should not be smaller than this.
+inline constexpr size_t MIN_STREAM_WINDOW_LINES = 64;
+
+// A map of header name to linenumber and the template entity.
+// Example: { '<functional>': (1219, 'less<>') }
+using IwyuRequired = std::map<std::string, std::pair<size_t, std::string>>;
+
+// An error that is printed after all lines are processed.
+// Errors from line checks on multiple threads are sorted by order.
+struct DeferredError {
+    size_t order;
+    size_t linenum;
+    ErrorCategory category;
+    int confidence;
+    std::string message;
+};
+
 // A worker for a file
 class FileLinter {
  private:
     CppLintState* m_cpplint_state;
     Options m_options;
     ErrorSuppressions m_error_suppressions;
+
+    // Results of filters for each category in the file. (See Options::FilterCategories)
+    // They are computed at the first error, and cleared when m_options changes.
+    bool m_categories_filtered;
+    ErrorCategorySet m_filtered_categories;
+    ErrorCategorySet m_line_filtered_categories;
     std::set<std::string> m_all_extensions;
     std::set<std::string> m_header_extensions;
     std::set<std::string> m_non_header_extensions;
@@ -30,23 +103,123 @@ class FileLinter {
     regex_match m_re_result;
     bool m_has_error;
 
+    // Buffers and states for a file.
+    // They are kept in the linter to reuse allocated memory for the next file.
+    std::vector<std::string> m_lines;
+    std::vector<size_t> m_crlf_lines;
+    std::vector<size_t> m_bad_lines;
+    std::vector<size_t> m_null_lines;
+    std::string m_line_buffer;
+    CleansedLines m_clean_lines;
+    IncludeState m_include_state;
+    FunctionState m_function_state;
+    NestingState m_nesting_state;
+
+    // Cache for IsInitializerList().
+    // Lines after m_init_list_statement_end are scanned up to m_init_list_scanned.
+    size_t m_init_list_statement_end;
+    size_t m_init_list_scanned;
+    bool m_init_list_found;
+
+    // Large files are split into chunks of this many lines,
+    // and line-local checks run on each chunk with another thread.
+    size_t m_parallel_chunk_lines;
+    // Idle workers of the pipeline. Chunks only use their threads when it's not null.
+    IdleWorkers* m_idle_workers;
+
+    // The number of lines in a window for ProcessStream().
+    size_t m_stream_window_lines;
+
+    // Errors are stored here instead of being printed when it is not null.
+    std::vector<DeferredError>* m_deferred_errors;
+    size_t m_error_order;
+
+    // Prepares the linter to run line-local checks for a chunk of the parent's file.
+    void InitLineWorker(const FileLinter& parent, std::vector<DeferredError>* errors);
+
+    // Runs line checks on multiple threads and prints errors in the same order as
+    // ProcessLine does.
+    void ProcessLinesInParallel(bool is_header_extension,
+                                const CleansedLines& clean_lines,
+                                size_t num_workers);
+
+    // Reads a line with GetLine(), and records line numbers of CR, bad UTF-8, and NUL.
+    // Returns false at the end of the stream.
+    bool ReadStreamLine(std::istream& stream, std::string* line, size_t linenum,
+                        size_t* lf_lines_count);
+
+    // Reports CR, bad UTF-8, and NUL recorded for lines before end.
+    // CRs are reported only when some lines end with LF.
+    void CheckLineEncodings(size_t lf_lines_count, size_t end);
+
+    // Checks --filter and CPPLINT.cfg filters with results cached for the file.
+    bool IsFiltered(ErrorCategory category, size_t linenum) {
+        if (!m_categories_filtered) {
+            m_options.FilterCategories(m_filename, &m_filtered_categories,
+                                       &m_line_filtered_categories);
+            m_categories_filtered = true;
+        }
+        if (m_line_filtered_categories[category.Id()])
+            return !m_options.ShouldPrintError(category, m_filename, linenum);
+        return m_filtered_categories[category.Id()];
+    }
+
  public:
-    FileLinter() {}
-    FileLinter(const fs::path& file, CppLintState* state, const Options& options) :
-                m_cpplint_state(state),
-                m_options(options),
+    FileLinter() :
+                m_cpplint_state(nullptr),
+                m_options(),
                 m_error_suppressions(),
+                m_categories_filtered(false),
+                m_filtered_categories(),
+                m_line_filtered_categories(),
                 m_all_extensions({}),
                 m_header_extensions({}),
                 m_non_header_extensions({}),
-                m_file(file),
-                m_filename(file.string()),
+                m_file(),
+                m_filename(),
                 m_file_extension(),
                 m_file_from_repo(),
                 m_basefilename_relative(),
                 m_cppvar(),
                 m_re_result(RegexCreateMatchData(16)),
-                m_has_error(false) {}
+                m_has_error(false),
+                m_lines({}),
+                m_crlf_lines({}),
+                m_bad_lines({}),
+                m_null_lines({}),
+                m_line_buffer(),
+                m_clean_lines(),
+                m_include_state(),
+                m_function_state(),
+                m_nesting_state(),
+                m_init_list_statement_end(INDEX_NONE),
+                m_init_list_scanned(INDEX_NONE),
+                m_init_list_found(false),
+                m_parallel_chunk_lines(PARALLEL_CHUNK_LINES),
+                m_idle_workers(nullptr),
+                m_stream_window_lines(STREAM_WINDOW_LINES),
+                m_deferred_errors(nullptr),
+                m_error_order(0) {}
+
+    FileLinter(const fs::path& file, CppLintState* state, const Options& options) :
+                FileLinter() {
+        Reset(file, state, options);
+    }
+
+    // Prepares the linter for a new file.
+    // Use this instead of constructing a new linter to reuse its buffers.
+    void Reset(const fs::path& file, CppLintState* state, const Options& options) {
+        m_cpplint_state = state;
+        m_options = options;
+        m_file = file;
+        m_filename = file.string();
+        m_file_extension.clear();
+        m_file_from_repo.clear();
+        m_basefilename_relative.clear();
+        m_cppvar.clear();
+        m_has_error = false;
+        m_categories_filtered = false;
+    }
 
     fs::path GetRelativeFromRepository(const fs::path& file, const fs::path& repository);
     fs::path GetRelativeFromSubdir(const fs::path& file, const fs::path& subdir);
@@ -55,10 +228,16 @@ class FileLinter {
     void CheckForCopyright(const std::vector<std::string>& lines);
 
     // Remove multiline (c-style) comments from lines.
-    void RemoveMultiLineComments(std::vector<std::string>& lines);
+    // first_line is the line number of lines[0] when lines are a window of a stream.
+    // With more_lines, a comment that is not closed in lines is not reported
+    // because it can end in the following lines.
+    // Returns the index of the first line of an unclosed comment, or INDEX_NONE.
+    size_t RemoveMultiLineComments(std::vector<std::string>& lines,
+                                   size_t first_line = 0, bool more_lines = false);
 
     // Logs an error if there is no newline char at the end of the file.
-    void CheckForNewlineAtEOF(const std::vector<std::string>& lines);
+    void CheckForNewlineAtEOF(const std::vector<std::string>& lines,
+                              size_t first_line = 0);
 
     std::string GetHeaderGuardCPPVariable();
 
@@ -272,6 +451,10 @@ class FileLinter {
                                    const std::string& elided_line, size_t linenum,
                                    NestingState* nesting_state);
 
+    // Check if current line is inside constructor initializer list.
+    // Lines should be checked in ascending order for each file.
+    bool IsInitializerList(const CleansedLines& clean_lines, size_t linenum);
+
     /*
     Logs an error if we see certain non-ANSI constructs ignored by gcc-2.
 
@@ -356,6 +539,15 @@ class FileLinter {
     void CheckForIncludeWhatYouUse(const CleansedLines& clean_lines,
                                    IncludeState* include_state);
 
+    // CheckForIncludeWhatYouUse in two steps, so a stream can be scanned by windows.
+    // Finds symbols that need headers in lines from begin to end.
+    void FindIncludeWhatYouUse(const CleansedLines& clean_lines,
+                               size_t begin, size_t end,
+                               IwyuRequired* required);
+    // Reports the missing headers.
+    void ReportIncludeWhatYouUse(const IwyuRequired& required,
+                                 IncludeState* include_state);
+
     // Logs an error if a source file does not include its header.
     void CheckHeaderFileIncluded(IncludeState* include_state);
 
@@ -378,12 +570,20 @@ class FileLinter {
     void CacheVariables(const fs::path& file);
 
 
-    // Gets lines from a file and executes ProcessFileData
-    void ProcessFile();
+    // Gets lines from a file and executes ProcessFileData.
+    // content is the file loaded in advance, or nullptr to read the file here.
+    void ProcessFile(const std::string* content = nullptr);
 
     // Process lines in the file
     void ProcessFileData(std::vector<std::string>& lines);
 
+    // Process lines from a stream with a sliding window. (e.g. stdin)
+    // Errors are printed as soon as lines are checked, and only the window is kept
+    // in memory. It only grows for comments and raw strings longer than the window.
+    // Unlike ProcessFileData, global suppressions (e.g. LINT_C_FILE) don't affect
+    // lines far before them, and header guards are not checked.
+    void ProcessStream(std::istream& stream);
+
     // Processes a single line in the file.
     void ProcessLine(bool is_header_extension,
                      const CleansedLines& clean_lines,
@@ -392,15 +592,56 @@ class FileLinter {
                      FunctionState* function_state,
                      NestingState* nesting_state);
 
+    // ProcessLine runs these groups of checks in this order.
+    // Groups with states run on one thread, and line-local groups can run on other threads.
+
+    // Updates the nesting state. Returns false for lines in assembly blocks.
+    bool ProcessLineNesting(const CleansedLines& clean_lines,
+                            const std::string& elided_line, size_t linenum,
+                            FunctionState* function_state,
+                            NestingState* nesting_state);
+
+    // Line-local style checks
+    void ProcessLineStyle(bool is_header_extension,
+                          const CleansedLines& clean_lines,
+                          const std::string& elided_line, size_t linenum);
+
+    // Checks that depend on include and nesting states
+    void ProcessLineWithState(bool is_header_extension,
+                              const CleansedLines& clean_lines,
+                              const std::string& elided_line, size_t linenum,
+                              IncludeState* include_state,
+                              NestingState* nesting_state);
+
+    // Line-local language checks
+    void ProcessLineLanguage(const CleansedLines& clean_lines,
+                             const std::string& elided_line, size_t linenum);
+
+    // Sets the number of lines per thread for large files. 0 disables threading.
+    void SetParallelChunkLines(size_t lines) { m_parallel_chunk_lines = lines; }
+
+    // Shares idle workers of the pipeline for chunks of large files.
+    // Without it, chunks use up to --threads - 1 threads.
+    void SetIdleWorkers(IdleWorkers* idle_workers) { m_idle_workers = idle_workers; }
+
+    // Sets the number of lines in a window for ProcessStream().
+    void SetStreamWindowLines(size_t lines) { m_stream_window_lines = lines; }
+
+    // Categories are interned at compile time. (e.g. Error(linenum, "whitespace/tab", ...))
     void Error(size_t linenum,
-               const std::string& category, int confidence,
-               const std::string& message) {
-        if (m_error_suppressions.IsSuppressed(category, linenum) ||
-            !m_options.ShouldPrintError(category, m_filename, linenum) ||
-            confidence < m_cpplint_state->VerboseLevel()) {
-            // The error is suppressed with NOLINT comments,
-            // or filtered with --filter options,
-            // or verbose level is higher than confidence.
+               ErrorCategory category, int confidence,
+               std::string_view message) {
+        if (confidence < m_cpplint_state->VerboseLevel() ||
+            IsFiltered(category, linenum) ||
+            m_error_suppressions.IsSuppressed(category, linenum)) {
+            // Verbose level is higher than confidence,
+            // or the error is filtered with --filter options,
+            // or suppressed with NOLINT comments.
+            return;
+        }
+        if (m_deferred_errors != nullptr) {
+            m_deferred_errors->push_back({ m_error_order, linenum, category, confidence,
+                                           std::string(message) });
             return;
         }
         m_has_error = true;
@@ -0,0 +1,68 @@
+#pragma once
+#include <cstddef>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+// A file loaded by the read stage.
+struct LoadedFile {
+    fs::path path;
+    std::string content;
+    bool loaded;  // false when the check stage should read the file by itself
+    size_t memory = 0;  // Estimated memory admitted by --max-memory
+};
+
+// Reads a whole file. Returns false when the file can't be opened.
+bool LoadFile(const fs::path& path, std::string* content);
+
+// Loads files in batches with io_uring.
+// Opens, reads, and closes of a batch are submitted with a few system calls
+// instead of several calls for each file.
+// It's only available on Linux builds with -Dio_uring=true.
+class UringLoader {
+ private:
+    int m_ring_fd;
+    unsigned m_entries;
+
+    // Memory mapped rings
+    void* m_sq_ptr;
+    size_t m_sq_size;
+    void* m_cq_ptr;
+    size_t m_cq_size;
+    void* m_sqes;
+    size_t m_sqes_size;
+
+    unsigned* m_sq_head;
+    unsigned* m_sq_tail;
+    unsigned* m_sq_mask;
+    unsigned* m_sq_array;
+    unsigned* m_cq_head;
+    unsigned* m_cq_tail;
+    unsigned* m_cq_mask;
+    void* m_cqes;
+
+    // The number of entries that are not submitted yet
+    unsigned m_to_submit;
+
+    void* GetSqe();
+    bool SubmitAndWait(unsigned wait_nr);
+    template <typename Func>
+    void ReapCompletions(Func on_complete);
+    void LoadBatch(LoadedFile* files, size_t count);
+
+ public:
+    UringLoader();
+    ~UringLoader();
+    UringLoader(const UringLoader&) = delete;
+    UringLoader& operator=(const UringLoader&) = delete;
+
+    // Sets up a ring. Returns false when io_uring is not available
+    // (e.g. non-Linux builds, old kernels, or blocked by seccomp.)
+    bool Init(unsigned entries);
+
+    // Loads files. LoadedFile::loaded is false for files that were not read,
+    // such as missing files and directories.
+    void Load(std::vector<LoadedFile>* files);
+};
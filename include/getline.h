@@ -2,6 +2,7 @@
 #include <iostream>
 #include <sstream>
 #include <string>
+#include <string_view>
 
 enum LineStatus : int {
     LINE_OK = 0,
@@ -20,6 +21,19 @@ enum LineStatus : int {
  */
 std::string GetLine(std::istream& stream, std::string* buffer, int* status);
 
+// Same as above, but it reuses the allocated memory of line.
+void GetLine(std::istream& stream, std::string* buffer, std::string* line, int* status);
+
+// A read-only stream buffer over a string.
+// You can read a string with GetLine() without copying it to std::istringstream.
+class StringReadBuf : public std::streambuf {
+ public:
+    explicit StringReadBuf(std::string_view str) {
+        char* data = const_cast<char*>(str.data());
+        setg(data, data, data + str.size());
+    }
+};
+
 // Gets the number of characters in a line that was read with GetLine().
 // It might crash when the line has broken bytes.
 size_t GetLineWidth(const std::string& line) noexcept;
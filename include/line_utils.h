@@ -1,6 +1,7 @@
 #pragma once
 #include <stack>
 #include <string>
+#include <string_view>
 #include "cleanse.h"
 
 // Return the number of leading spaces in line.
@@ -69,4 +70,4 @@ const std::string& ReverseCloseExpression(const CleansedLines& clean_lines,
     Does line terminate so, that the next symbol is in string constant.
     This function does not consider single-line nor multi-line comments.
 */
-bool IsCppString(const std::string& line);
+bool IsCppString(std::string_view line);
@@ -1,6 +1,10 @@
 #pragma once
+#include <cstddef>
+#include <memory>
+#include <new>
 #include <stack>
 #include <string>
+#include <type_traits>
 #include <utility>
 #include <vector>
 #include "cleanse.h"
@@ -151,20 +155,127 @@ class NamespaceInfo : public BlockInfo {
                   FileLinter* file_linter) override;
 };
 
+// Node of a persistent stack of blocks.
+// Nodes are never modified after creation, so snapshots of the nesting
+// stack can share them without copying the whole stack.
+struct BlockStackNode {
+    BlockInfo* block;
+    const BlockStackNode* parent;
+    size_t depth;
+
+    BlockStackNode(BlockInfo* block, const BlockStackNode* parent, size_t depth) :
+        block(block), parent(parent), depth(depth) {}
+};
+
+// Monotonic arena for BlockInfo objects and stack nodes of a file.
+// Objects are never freed one by one. They are destroyed at once by Clear()
+// or the destructor, and the chunks are reused for the next file.
+class BlockInfoArena {
+ private:
+    static constexpr size_t CHUNK_SIZE = 4096;
+    struct alignas(std::max_align_t) Chunk {
+        unsigned char data[CHUNK_SIZE];
+    };
+
+    std::vector<std::unique_ptr<Chunk>> m_chunks;
+    size_t m_chunk_id;  // The chunk currently used
+    size_t m_used;  // Used bytes in the current chunk
+
+    // BlockInfo objects to call destructors
+    std::vector<BlockInfo*> m_blocks;
+
+    void* Allocate(size_t size, size_t align) {
+        m_used = (m_used + align - 1) & ~(align - 1);
+        if (m_chunk_id >= m_chunks.size() || m_used + size > CHUNK_SIZE) {
+            if (m_chunk_id < m_chunks.size())
+                m_chunk_id++;
+            if (m_chunk_id == m_chunks.size())
+                m_chunks.emplace_back(new Chunk);
+            m_used = 0;
+        }
+        void* ptr = m_chunks[m_chunk_id]->data + m_used;
+        m_used += size;
+        return ptr;
+    }
+
+    void DestroyBlocks() {
+        for (BlockInfo* block : m_blocks)
+            block->~BlockInfo();
+        m_blocks.clear();
+    }
+
+ public:
+    BlockInfoArena() : m_chunks(), m_chunk_id(0), m_used(0), m_blocks() {}
+    BlockInfoArena(const BlockInfoArena&) = delete;
+    BlockInfoArena& operator=(const BlockInfoArena&) = delete;
+
+    BlockInfoArena(BlockInfoArena&& other) noexcept : BlockInfoArena() {
+        *this = std::move(other);
+    }
+
+    BlockInfoArena& operator=(BlockInfoArena&& other) noexcept {
+        if (this != &other) {
+            DestroyBlocks();
+            m_chunks = std::move(other.m_chunks);
+            m_chunk_id = other.m_chunk_id;
+            m_used = other.m_used;
+            m_blocks = std::move(other.m_blocks);
+            other.m_chunks.clear();
+            other.m_chunk_id = 0;
+            other.m_used = 0;
+            other.m_blocks.clear();
+        }
+        return *this;
+    }
+
+    ~BlockInfoArena() {
+        DestroyBlocks();
+    }
+
+    // Destroys all objects but keeps allocated chunks for reuse.
+    void Clear() {
+        DestroyBlocks();
+        m_chunk_id = 0;
+        m_used = 0;
+    }
+
+    template <typename T, typename... Args>
+    T* New(Args&&... args) {
+        static_assert(sizeof(T) <= CHUNK_SIZE && alignof(T) <= alignof(std::max_align_t));
+        T* obj = new (Allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+        if constexpr (std::is_base_of_v<BlockInfo, T>)
+            m_blocks.push_back(obj);
+        else
+            static_assert(std::is_trivially_destructible_v<T>);
+        return obj;
+    }
+
+    // Moves a block from another arena into this one.
+    BlockInfo* MoveBlock(BlockInfo* block) {
+        if (block->IsClassInfo())
+            return New<ClassInfo>(std::move(*static_cast<ClassInfo*>(block)));
+        if (block->IsNamespaceInfo())
+            return New<NamespaceInfo>(std::move(*static_cast<NamespaceInfo*>(block)));
+        if (block->IsExternCInfo())
+            return New<ExternCInfo>(std::move(*static_cast<ExternCInfo*>(block)));
+        return New<BlockInfo>(std::move(*block));
+    }
+};
+
 // Stores checkpoints of nesting stacks when #if/#else is seen.
 class PreprocessorInfo {
  private:
     bool m_seen_else;
-    std::vector<BlockInfo*> m_stack_before_if;
-    std::vector<BlockInfo*> m_stack_before_else;
+    const BlockStackNode* m_stack_before_if;
+    const BlockStackNode* m_stack_before_else;
 
  public:
-    explicit PreprocessorInfo(const std::vector<BlockInfo*>& stack_before_if) {
+    explicit PreprocessorInfo(const BlockStackNode* stack_before_if) {
         // The entire nesting stack before #if
         m_stack_before_if = stack_before_if;
 
         // The entire nesting stack up to #else
-        m_stack_before_else = {};
+        m_stack_before_else = nullptr;
 
         // Whether we have already seen #else or #elif
         m_seen_else = false;
@@ -173,15 +284,15 @@ class PreprocessorInfo {
     bool SeenElse() { return m_seen_else; }
     void SetSeenElse(bool seen_else) { m_seen_else = seen_else; }
 
-    const std::vector<BlockInfo*>& StackBeforeIf() {
+    const BlockStackNode* StackBeforeIf() {
         return m_stack_before_if;
     }
 
-    const std::vector<BlockInfo*>& StackBeforeElse() {
+    const BlockStackNode* StackBeforeElse() {
         return m_stack_before_else;
     }
 
-    void SetStackBeforeElse(const std::vector<BlockInfo*>& stack_before_else) {
+    void SetStackBeforeElse(const BlockStackNode* stack_before_else) {
         m_stack_before_else = stack_before_else;
     }
 };
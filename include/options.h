@@ -1,9 +1,13 @@
 #pragma once
 #include <filesystem>
+#include <functional>
+#include <istream>
 #include <set>
 #include <string>
+#include <unordered_set>
 #include <vector>
 #include "cpplint_state.h"
+#include "error_categories.h"
 #include "glob_match.h"
 
 namespace fs = std::filesystem;
@@ -15,26 +19,41 @@ class Filter {
     std::string m_file;
     size_t m_linenum;
 
+    // Categories that start with m_category
+    ErrorCategorySet m_categories;
+
+    void MatchCategories();
+
  public:
     Filter() :
         m_sign(false),
         m_category(""),
         m_file(""),
-        m_linenum(INDEX_NONE) {}
+        m_linenum(INDEX_NONE),
+        m_categories() {
+        MatchCategories();
+    }
 
     explicit Filter(const std::string& filter) {
         ParseFilterSelector(filter);
+        MatchCategories();
     }
 
     void ParseFilterSelector(const std::string& filter);
 
     bool IsPositive() const { return m_sign; }
+    size_t Linenum() const { return m_linenum; }
+    const ErrorCategorySet& Categories() const { return m_categories; }
 
-    bool IsMatched(const std::string& category,
+    bool IsMatchedFile(const std::string& file) const {
+        return m_file.empty() || m_file == file;
+    }
+
+    bool IsMatched(ErrorCategory category,
                    const std::string& file,
                    size_t linenum) const {
-        return category.starts_with(m_category) &&
-               (m_file.empty() || m_file == file) &&
+        return m_categories[category.Id()] &&
+               IsMatchedFile(file) &&
                (m_linenum == linenum || m_linenum == INDEX_NONE);
     }
 };
@@ -64,6 +83,29 @@ class Options {
     std::set<std::string> m_hpp_headers;
     int m_include_order;
     bool m_timing;
+    bool m_profile;
+
+    // --shard=i/N
+    size_t m_shard_index;
+    size_t m_shard_count;
+    // --shard-summary=path
+    std::string m_shard_summary;
+
+    // --file-list=path and --compile-commands=path
+    std::string m_file_list;
+    std::string m_compile_commands;
+    // Files from the command line, including ones in other shards
+    std::vector<fs::path> m_command_line_files;
+
+    // --exclude=path (canonicalized)
+    std::vector<std::string> m_excludes;
+
+    // --watch
+    bool m_watch;
+    // --max-memory=size in bytes (0 means no limit)
+    size_t m_max_memory;
+    // Directories given with --recursive. New files in them are linted in watch mode.
+    std::vector<fs::path> m_recursive_dirs;
 
     // filters to apply when emitting error messages
     std::vector<Filter> m_filters;
@@ -85,6 +127,11 @@ class Options {
     std::vector<fs::path> FilterExcludedFiles(std::vector<fs::path> filenames,
                                               const std::vector<GlobPattern>& excludes);
 
+    // Selects files for the current shard. Files are distributed to shards
+    // by their sizes, so every process gets a similar amount of work.
+    // The result only depends on the file list and the file sizes.
+    std::vector<fs::path> SelectShardFiles(const std::vector<fs::path>& filenames);
+
  public:
     Options() :
         m_root(""),
@@ -95,6 +142,17 @@ class Options {
         m_hpp_headers({}),
         m_include_order(INCLUDE_ORDER_DEFAULT),
         m_timing(false),
+        m_profile(false),
+        m_shard_index(0),
+        m_shard_count(1),
+        m_shard_summary(""),
+        m_file_list(""),
+        m_compile_commands(""),
+        m_command_line_files({}),
+        m_excludes({}),
+        m_watch(false),
+        m_max_memory(0),
+        m_recursive_dirs({}),
         m_filters(DEFAULT_FILTERS)
         {}
 
@@ -107,6 +165,7 @@ class Options {
     const fs::path& Root() const { return m_root; }
     const fs::path& Repository() const { return m_repository; }
     size_t LineLength() const { return m_line_length; }
+    const std::string& ConfigFilename() const { return m_config_filename; }
 
     std::set<std::string> GetAllExtensions() const;
     std::set<std::string> GetHeaderExtensions() const;
@@ -124,8 +183,69 @@ class Options {
     bool AddFilters(const std::string& filters);
 
     // Checks if the error is filtered or not.
-    bool ShouldPrintError(const std::string& category,
+    bool ShouldPrintError(ErrorCategory category,
                           const std::string& filename, size_t linenum) const;
 
+    // Runs ShouldPrintError() for all categories of a file at once, so file names
+    // are compared once for each file instead of for each error.
+    // Results of categories in line_specific also depend on line numbers.
+    // ShouldPrintError() should be called for them.
+    void FilterCategories(const std::string& filename,
+                          ErrorCategorySet* filtered,
+                          ErrorCategorySet* line_specific) const;
+
     bool Timing() const { return m_timing; }
+    bool Profile() const { return m_profile; }
+
+    size_t ShardIndex() const { return m_shard_index; }
+    size_t ShardCount() const { return m_shard_count; }
+    const std::string& ShardSummary() const { return m_shard_summary; }
+
+    const std::string& FileList() const { return m_file_list; }
+    const std::string& CompileCommands() const { return m_compile_commands; }
+    const std::vector<fs::path>& CommandLineFiles() const { return m_command_line_files; }
+    const std::vector<std::string>& Excludes() const { return m_excludes; }
+
+    bool Watch() const { return m_watch; }
+    const std::vector<fs::path>& RecursiveDirs() const { return m_recursive_dirs; }
+
+    size_t MaxMemory() const { return m_max_memory; }
+
+    // Checks if a file is excluded by --exclude.
+    bool IsExcluded(const fs::path& file) const;
+};
+
+// Drops a cached config file, so it will be read again. (e.g. When --watch finds changes.)
+void ForgetCfg(const fs::path& file);
+
+/* Reads file paths from --file-list and --compile-commands.
+
+  Paths are passed to a callback as soon as they are read, so linting can
+  start before reading the whole list. Listed files are filtered with
+  --exclude, and files that have already been passed are skipped.
+  With --shard, listed files are distributed by hashes of their canonical paths
+  relative to --repository or the current directory, since we can't know all
+  the file sizes in advance.
+*/
+class FileListReader {
+ private:
+    using Callback = std::function<void(const fs::path&)>;
+
+    const Options& m_options;
+    CppLintState* m_cpplint_state;
+    std::vector<GlobPattern> m_excludes;
+    std::unordered_set<std::string> m_seen;
+    // Listed files are hashed with paths relative to this directory.
+    fs::path m_shard_root;
+
+    void AddFile(const std::string& file, const fs::path& directory,
+                 const Callback& callback);
+    void ReadFileList(std::istream& stream, const Callback& callback);
+    void ReadCompileCommands(std::istream& stream, const Callback& callback);
+
+ public:
+    // Files from the command line are never passed, even if they are in other shards.
+    FileListReader(const Options& options, CppLintState* cpplint_state);
+
+    void Read(const Callback& callback);
 };
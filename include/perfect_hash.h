@@ -0,0 +1,125 @@
+#pragma once
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <string_view>
+
+// Counts strings in a null terminated array of char*.
+constexpr size_t CountStrArray(const char* const *str_vec) {
+    size_t count = 0;
+    while (str_vec[count] != nullptr)
+        count++;
+    return count;
+}
+
+// FNV-1a with a seed and a finalizer of murmur3.
+constexpr uint32_t HashStrWithSeed(std::string_view str, uint32_t seed) {
+    uint32_t hash = 2166136261u ^ (seed * 0x9e3779b9u);
+    for (char c : str) {
+        hash ^= static_cast<uint8_t>(c);
+        hash *= 16777619u;
+    }
+    hash ^= hash >> 16;
+    hash *= 0x85ebca6bu;
+    hash ^= hash >> 13;
+    hash *= 0xc2b2ae35u;
+    hash ^= hash >> 16;
+    return hash;
+}
+
+// Set of strings with a perfect hash function generated at compile time.
+// Keys are split into buckets, and each bucket has a seed that
+// puts its keys into empty slots without collisions (hash and displace).
+// A lookup costs two hashes and one string comparison.
+template <size_t N>
+class PerfectHashSet {
+ private:
+    static constexpr size_t TABLE_SIZE = std::bit_ceil(N * 2 + 1);
+    static constexpr size_t BUCKET_COUNT = N / 4 + 1;
+    static constexpr uint32_t SEED_MAX = 0x10000;
+
+    std::array<const char*, TABLE_SIZE> m_table{};
+    std::array<uint32_t, BUCKET_COUNT> m_seeds{};
+
+    static constexpr size_t GetBucket(std::string_view str) {
+        return HashStrWithSeed(str, 0) % BUCKET_COUNT;
+    }
+
+    static constexpr size_t GetSlot(std::string_view str, uint32_t seed) {
+        return HashStrWithSeed(str, seed) & (TABLE_SIZE - 1);
+    }
+
+    // Returns false if keys in the bucket collide with each other or placed keys.
+    constexpr bool TryPlace(const char* const *str_vec,
+                            const std::array<size_t, N>& buckets,
+                            size_t bucket, uint32_t seed) {
+        std::array<size_t, N> slots{};
+        size_t count = 0;
+        for (size_t i = 0; i < N; i++) {
+            if (buckets[i] != bucket)
+                continue;
+            size_t slot = GetSlot(str_vec[i], seed);
+            if (m_table[slot] != nullptr)
+                return false;
+            for (size_t j = 0; j < count; j++) {
+                if (slots[j] == slot)
+                    return false;
+            }
+            slots[count] = slot;
+            count++;
+        }
+        count = 0;
+        for (size_t i = 0; i < N; i++) {
+            if (buckets[i] != bucket)
+                continue;
+            m_table[slots[count]] = str_vec[i];
+            count++;
+        }
+        return true;
+    }
+
+ public:
+    // str_vec should be a null terminated array that has N strings.
+    // Duplicated strings are allowed.
+    consteval explicit PerfectHashSet(const char* const *str_vec) {
+        std::array<size_t, N> buckets{};
+        std::array<size_t, BUCKET_COUNT> sizes{};
+        size_t max_size = 0;
+        for (size_t i = 0; i < N; i++) {
+            buckets[i] = GetBucket(str_vec[i]);
+            // Skip duplicated keys. The header lists have some.
+            for (size_t j = 0; j < i; j++) {
+                if (std::string_view(str_vec[i]) == str_vec[j]) {
+                    buckets[i] = BUCKET_COUNT;
+                    break;
+                }
+            }
+            if (buckets[i] == BUCKET_COUNT)
+                continue;
+            sizes[buckets[i]]++;
+            if (sizes[buckets[i]] > max_size)
+                max_size = sizes[buckets[i]];
+        }
+
+        // Place larger buckets first.
+        for (size_t size = max_size; size > 0; size--) {
+            for (size_t bucket = 0; bucket < BUCKET_COUNT; bucket++) {
+                if (sizes[bucket] != size)
+                    continue;
+                uint32_t seed = 1;
+                while (!TryPlace(str_vec, buckets, bucket, seed)) {
+                    seed++;
+                    // Throwing in consteval makes a compile error.
+                    if (seed >= SEED_MAX)
+                        throw "Failed to generate a perfect hash function.";
+                }
+                m_seeds[bucket] = seed;
+            }
+        }
+    }
+
+    [[nodiscard]] constexpr bool Contains(std::string_view str) const {
+        const char* key = m_table[GetSlot(str, m_seeds[GetBucket(str)])];
+        return key != nullptr && str == key;
+    }
+};
@@ -0,0 +1,220 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <filesystem>
+#include <future>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <utility>
+#include <vector>
+#include "common.h"
+#include "cpplint_state.h"
+#include "file_linter.h"
+#include "file_loader.h"
+#include "options.h"
+#include "ThreadPool.h"
+
+namespace fs = std::filesystem;
+
+// A blocking queue with a capacity.
+// Push() waits while the queue is full, so a stage can't run too far ahead of the next one.
+template <typename T>
+class BoundedQueue {
+ private:
+    std::mutex m_mtx;
+    std::condition_variable m_not_empty;
+    std::condition_variable m_not_full;
+    std::queue<T> m_queue;
+    size_t m_capacity;
+    bool m_closed;
+
+ public:
+    explicit BoundedQueue(size_t capacity) :
+        m_mtx(),
+        m_not_empty(),
+        m_not_full(),
+        m_queue(),
+        m_capacity(capacity),
+        m_closed(false) {}
+
+    void Push(T item) {
+        std::unique_lock<std::mutex> lock(m_mtx);
+        m_not_full.wait(lock, [this] { return m_queue.size() < m_capacity; });
+        m_queue.push(std::move(item));
+        m_not_empty.notify_one();
+    }
+
+    // Returns false when the queue is closed and empty.
+    bool Pop(T* item) {
+        std::unique_lock<std::mutex> lock(m_mtx);
+        m_not_empty.wait(lock, [this] { return m_closed || !m_queue.empty(); });
+        if (m_queue.empty())
+            return false;
+        *item = std::move(m_queue.front());
+        m_queue.pop();
+        m_not_full.notify_one();
+        return true;
+    }
+
+    // Pops at most max_count items. It waits only for the first one.
+    // Returns false when the queue is closed and empty.
+    bool PopSome(std::vector<T>* items, size_t max_count) {
+        items->clear();
+        std::unique_lock<std::mutex> lock(m_mtx);
+        m_not_empty.wait(lock, [this] { return m_closed || !m_queue.empty(); });
+        while (!m_queue.empty() && items->size() < max_count) {
+            items->push_back(std::move(m_queue.front()));
+            m_queue.pop();
+        }
+        m_not_full.notify_all();
+        return !items->empty();
+    }
+
+    // Consumers stop after the rest of the items.
+    void Close() {
+        std::lock_guard<std::mutex> lock(m_mtx);
+        m_closed = true;
+        m_not_empty.notify_all();
+    }
+};
+
+// Admission control of memory for files being linted. (--max-memory)
+// Files are admitted in order while their estimated memory fits in the budget.
+// A file larger than the budget is admitted alone when nothing else is in use.
+class MemoryBudget {
+ private:
+    std::mutex m_mtx;
+    std::condition_variable m_released;
+    size_t m_max;  // 0 means no limit
+    size_t m_used;
+    size_t m_peak;
+
+    // Tickets to admit waiting files in order
+    uint64_t m_next_ticket;
+    uint64_t m_serving;
+
+    bool Fits(size_t size) const {
+        return m_max == 0 || m_used == 0 || m_used + size <= m_max;
+    }
+
+    void Use(size_t size) {
+        m_used += size;
+        m_peak = MAX(m_peak, m_used);
+    }
+
+ public:
+    explicit MemoryBudget(size_t max) :
+        m_mtx(),
+        m_released(),
+        m_max(max),
+        m_used(0),
+        m_peak(0),
+        m_next_ticket(0),
+        m_serving(0) {}
+
+    // Waits until size bytes fit in the budget.
+    void Acquire(size_t size) {
+        std::unique_lock<std::mutex> lock(m_mtx);
+        uint64_t ticket = m_next_ticket++;
+        m_released.wait(lock, [this, ticket, size] {
+            return ticket == m_serving && Fits(size);
+        });
+        m_serving++;
+        Use(size);
+        m_released.notify_all();
+    }
+
+    // Acquires size bytes only when it doesn't have to wait.
+    bool TryAcquire(size_t size) {
+        std::lock_guard<std::mutex> lock(m_mtx);
+        if (m_next_ticket != m_serving || !Fits(size))
+            return false;
+        m_next_ticket++;
+        m_serving++;
+        Use(size);
+        return true;
+    }
+
+    void Release(size_t size) {
+        std::lock_guard<std::mutex> lock(m_mtx);
+        m_used -= size;
+        m_released.notify_all();
+    }
+
+    size_t Max() const { return m_max; }
+
+    // The high-water mark of the estimated memory
+    size_t Peak() {
+        std::lock_guard<std::mutex> lock(m_mtx);
+        return m_peak;
+    }
+};
+
+// Lints files with three stages.
+//   read:  I/O threads load files into memory. They use io_uring when it's available.
+//   check: workers lint loaded files.
+//   write: the writer thread of CppLintState prints outputs.
+// Queues between stages are bounded, so loaded files don't use too much memory
+// when workers are slower than disks. With --max-memory, files are also loaded
+// only when their estimated memory fits in the budget.
+class LintPipeline {
+ private:
+    CppLintState* m_cpplint_state;
+    const Options& m_options;
+    BoundedQueue<fs::path> m_paths;
+    BoundedQueue<LoadedFile> m_files;
+    MemoryBudget m_memory;
+    size_t m_num_readers;
+    size_t m_num_workers;
+    IdleWorkers m_idle_workers;
+    ThreadPool m_pool;
+    std::vector<std::future<void>> m_readers;
+    std::vector<std::future<void>> m_workers;
+    bool m_finished;
+
+    // Files pushed and checked, for Wait()
+    std::mutex m_done_mtx;
+    std::condition_variable m_done_cv;
+    size_t m_num_pushed;
+    size_t m_num_done;
+    std::exception_ptr m_error;  // The first exception thrown by workers
+    std::atomic<bool> m_uring_used;  // true when a reader used io_uring
+
+    // Time spent on each stage
+    std::atomic<int64_t> m_read_ns;
+    std::atomic<int64_t> m_check_ns;
+
+    // Estimates memory to lint a file. It's 0 without --max-memory.
+    size_t EstimateMemory(const fs::path& file) const;
+
+    void ReadLoop();
+    bool ReadLoopWithUring();
+    void CheckLoop();
+
+    // Waits for all files to be processed and stops threads.
+    void Stop();
+
+ public:
+    LintPipeline(CppLintState* cpplint_state, const Options& options, int num_threads);
+    ~LintPipeline();
+
+    // Adds a file to lint. It blocks when the read stage is far behind.
+    void Push(const fs::path& file);
+
+    // Waits for all pushed files to be checked. Threads keep running for more files.
+    // It rethrows an exception that workers threw for the files.
+    void Wait();
+
+    // Waits for all files to be processed and stops threads.
+    // It rethrows an exception that workers threw for the files.
+    void Finish();
+
+    // Returns how busy each stage was. It should be called after Finish().
+    std::string GetUtilizationReport(double elapsed_sec) const;
+
+    // Returns the high-water marks of the estimated memory and the peak RSS.
+    std::string GetMemoryReport();
+};
@@ -0,0 +1,91 @@
+#pragma once
+
+// Profiler for --profile.
+// It's compiled out unless cpplint-cpp is built with -Dprofiler=true.
+
+#ifdef CPPLINT_PROFILE
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+// Timers do nothing until ProfilerEnable() is called.
+extern bool g_profiler_enabled;
+
+// Enables timers. It should be called before starting threads.
+void ProfilerEnable(size_t num_slowest_files);
+
+// Returns an ID for a section name.
+// PROFILE_SCOPE() calls this only once for each section.
+int ProfilerRegister(const char* name);
+
+// Adds elapsed time to the accumulator of the current thread.
+void ProfilerAdd(int id, int64_t elapsed_ns);
+void ProfilerAddFile(const std::string& filename, int64_t elapsed_ns);
+
+// Merges accumulators of all threads and returns a report.
+// It should be called after all threads finished their jobs.
+std::string ProfilerReport();
+
+// Measures the lifetime of the object.
+class ProfileTimer {
+ private:
+    int m_id;
+    std::chrono::steady_clock::time_point m_start;
+
+ public:
+    explicit ProfileTimer(int id) : m_id(id) {
+        if (g_profiler_enabled)
+            m_start = std::chrono::steady_clock::now();
+        else
+            m_id = -1;
+    }
+
+    ~ProfileTimer() {
+        if (m_id < 0)
+            return;
+        auto elapsed = std::chrono::steady_clock::now() - m_start;
+        ProfilerAdd(m_id, std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+    }
+};
+
+// Measures processing time of a file.
+class ProfileFileTimer {
+ private:
+    std::string m_filename;
+    std::chrono::steady_clock::time_point m_start;
+
+ public:
+    explicit ProfileFileTimer(const std::string& filename) : m_filename() {
+        if (!g_profiler_enabled)
+            return;
+        m_filename = filename;
+        m_start = std::chrono::steady_clock::now();
+    }
+
+    ~ProfileFileTimer() {
+        if (!g_profiler_enabled)
+            return;
+        auto elapsed = std::chrono::steady_clock::now() - m_start;
+        ProfilerAddFile(m_filename,
+                        std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+    }
+};
+
+#define PROFILE_CONCAT_IMPL(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_IMPL(a, b)
+
+// Measures the rest of the current scope as a section.
+#define PROFILE_SCOPE(name) \
+    static const int PROFILE_CONCAT(profile_id_, __LINE__) = ProfilerRegister(name); \
+    ProfileTimer PROFILE_CONCAT(profile_timer_, __LINE__)(PROFILE_CONCAT(profile_id_, __LINE__))
+
+// Measures the rest of the current scope as processing time of a file.
+#define PROFILE_FILE(filename) \
+    ProfileFileTimer PROFILE_CONCAT(profile_file_timer_, __LINE__)(filename)
+
+#else  // CPPLINT_PROFILE
+
+#define PROFILE_SCOPE(name)
+#define PROFILE_FILE(filename)
+
+#endif  // CPPLINT_PROFILE
@@ -1,4 +1,5 @@
 #pragma once
+#include <initializer_list>
 #include <memory>
 #include <string>
 #include <string_view>
@@ -267,6 +268,34 @@ inline std::string RegexEscape(const std::string_view& str) {
 // Split a string by a regex pattern.
 std::vector<std::string> RegexSplit(const std::string& regex, const std::string& str);
 
+// A set of JIT compiled patterns that are searched at once.
+// Search() returns which patterns matched as a bit mask, so checks can skip
+// their work when nothing matched.
+// Note: Joining patterns into one alternation was slower than this.
+//       An alternation disables the start-of-match optimizations of pcre2.
+class RegexSet {
+ private:
+    std::vector<regex_code> m_codes;
+
+ public:
+    explicit RegexSet(std::initializer_list<const char*> patterns);
+
+    size_t Size() const noexcept { return m_codes.size(); }
+
+    // Returns the compiled pattern of the i-th pattern.
+    // Use it to get captured groups after Search().
+    const regex_code& Get(size_t i) const noexcept { return m_codes[i]; }
+
+    // Returns a bit mask of patterns that match the string.
+    // The i-th bit is set when RegexSearch(Get(i), str) is true.
+    uint64_t Search(std::string_view str) const noexcept;
+
+    // Returns true if the i-th bit of the return value of Search() is set.
+    static constexpr bool Matched(uint64_t hits, size_t i) noexcept {
+        return (hits >> i) & 1;
+    }
+};
+
 #ifdef SUPPORT_JIT
 // Uses jit compiler for regex
 // It makes matching faster when using complex patterns in RegexSearch.
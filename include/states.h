@@ -46,6 +46,13 @@ class IncludeState {
         ResetSection("");
     }
 
+    // Reset states for a new file.
+    void Clear() {
+        m_include_list.resize(1);
+        m_include_list[0].clear();
+        ResetSection("");
+    }
+
     // Check if a header has already been included.
     // It returns line number of previous occurrence,
     // or -1 if the header has not been seen before.
@@ -131,7 +138,7 @@ class FunctionState {
 class NestingState {
  private:
     // Store all BlockInfo objects here to free them with destructor.
-    std::stack<BlockInfo*> m_block_info_buffer;
+    BlockInfoArena m_arena;
 
     // Stack for tracking all braces.  An object is pushed whenever we
     // see a "{", and popped when we see a "}".  Only 3 types of
@@ -141,6 +148,10 @@ class NestingState {
     // - _BlockInfo: some other type of block.
     std::vector<BlockInfo*> m_stack;
 
+    // The same stack as m_stack but in a persistent form.
+    // Preprocessor snapshots refer to this instead of copying m_stack.
+    const BlockStackNode* m_stack_top;
+
     // Top of the previous stack before each Update().
     //
     // Because the nesting_stack is updated at the end of each line, we
@@ -153,25 +164,48 @@ class NestingState {
     BlockInfo* m_previous_stack_top;
 
     // Stack of _PreprocessorInfo objects.
-    std::stack<PreprocessorInfo> m_pp_stack;
+    std::stack<PreprocessorInfo, std::vector<PreprocessorInfo>> m_pp_stack;
     regex_match m_re_result;
 
  public:
     NestingState() :
+        m_arena(),
         m_stack({}),
+        m_stack_top(nullptr),
         m_previous_stack_top(nullptr),
         m_pp_stack(),
         m_re_result(RegexCreateMatchData(16)) {}
 
-    ~NestingState() {
-        // Free block info objects
-        while (!m_block_info_buffer.empty()) {
-            BlockInfo* block = m_block_info_buffer.top();
-            delete block;
-            m_block_info_buffer.pop();
-        }
+    // Reset states for a new file.
+    void Clear() {
+        m_arena.Clear();
+        m_stack.clear();
+        m_stack_top = nullptr;
+        m_previous_stack_top = nullptr;
+        while (!m_pp_stack.empty())
+            m_pp_stack.pop();
     }
 
+    // Push a block onto the nesting stack.
+    void PushBlock(BlockInfo* block) {
+        m_stack.push_back(block);
+        m_stack_top = m_arena.New<BlockStackNode>(block, m_stack_top, m_stack.size());
+    }
+
+    // Pop a block from the nesting stack.
+    void PopBlock() {
+        m_stack.pop_back();
+        m_stack_top = m_stack_top->parent;
+    }
+
+    // Restore the nesting stack from a snapshot.
+    void RestoreStack(const BlockStackNode* stack_top);
+
+    // Move blocks that are still reachable to a new arena, and free the others.
+    // The arena keeps popped blocks until Clear(), so ProcessStream() calls this
+    // to bound memory for long streams.
+    void Compact();
+
     bool SeenOpenBrace() {
         /*Check if we have seen the opening brace for the innermost block.
 
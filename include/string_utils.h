@@ -1,4 +1,5 @@
 #pragma once
+#include <cstdint>
 #include <set>
 #include <string>
 #include <string_view>
@@ -146,6 +147,116 @@ char GetLastNonSpace(const std::string& str) noexcept;
 // Returns index to the last non-space character or INDEX_NONE.
 size_t GetLastNonSpacePos(const std::string& str) noexcept;
 
+// Hand-written matchers for simple regex patterns.
+// pcre2_match has a fixed overhead that is large for short lines.
+// Each matcher returns the position after the match or INDEX_NONE.
+// They return INDEX_NONE for INDEX_NONE, so you can nest them.
+// e.g. RegexMatch(R"( {4}:)", str) is MatchChar(str, MatchChar(str, 0, ' ', 4), ':')
+
+// Same as \s in regex patterns. (isspace is not constexpr.)
+constexpr bool IsSpaceChar(char c) noexcept {
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+// Same as \w in regex patterns.
+constexpr bool IsWordChar(char c) noexcept {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+           (c >= '0' && c <= '9') || c == '_';
+}
+
+// \s*
+constexpr size_t MatchSpaces(std::string_view str, size_t pos) noexcept {
+    if (pos == INDEX_NONE) return INDEX_NONE;
+    while (pos < str.size() && IsSpaceChar(str[pos]))
+        pos++;
+    return pos;
+}
+
+// c{count}
+constexpr size_t MatchChar(std::string_view str, size_t pos,
+                           char c, size_t count = 1) noexcept {
+    if (pos == INDEX_NONE || count > str.size() || pos > str.size() - count)
+        return INDEX_NONE;
+    for (size_t i = 0; i < count; i++) {
+        if (str[pos + i] != c)
+            return INDEX_NONE;
+    }
+    return pos + count;
+}
+
+// \w
+constexpr size_t MatchWordChar(std::string_view str, size_t pos) noexcept {
+    if (pos >= str.size() || !IsWordChar(str[pos]))
+        return INDEX_NONE;
+    return pos + 1;
+}
+
+// A string without special characters
+constexpr size_t MatchStr(std::string_view str, size_t pos,
+                          std::string_view target) noexcept {
+    if (pos > str.size() || str.substr(pos, target.size()) != target)
+        return INDEX_NONE;
+    return pos + target.size();
+}
+
+// \s*$
+constexpr bool MatchSpacesToEnd(std::string_view str, size_t pos) noexcept {
+    return pos != INDEX_NONE && MatchSpaces(str, pos) == str.size();
+}
+
+// \b
+constexpr bool IsWordBoundary(std::string_view str, size_t pos) noexcept {
+    bool prev = pos > 0 && pos <= str.size() && IsWordChar(str[pos - 1]);
+    bool next = pos < str.size() && IsWordChar(str[pos]);
+    return prev != next;
+}
+
+// Returns the start of the first "\bword\b" after pos, or INDEX_NONE.
+// word should consist of \w characters.
+constexpr size_t FindWord(std::string_view str, std::string_view word,
+                          size_t pos = 0) noexcept {
+    while (pos != INDEX_NONE) {
+        pos = str.find(word, pos);
+        if (pos == std::string_view::npos)
+            return INDEX_NONE;
+        if (IsWordBoundary(str, pos) && IsWordBoundary(str, pos + word.size()))
+            return pos;
+        pos++;
+    }
+    return INDEX_NONE;
+}
+
+// A set of bytes for FindFirstOf. Same as [...] in regex patterns.
+class CharSet {
+ public:
+    constexpr explicit CharSet(std::string_view chars) noexcept : m_bits() {
+        for (char c : chars) {
+            unsigned char u = static_cast<unsigned char>(c);
+            m_bits[u >> 6] |= static_cast<uint64_t>(1) << (u & 63);
+        }
+    }
+
+    constexpr bool Contains(char c) const noexcept {
+        unsigned char u = static_cast<unsigned char>(c);
+        return (m_bits[u >> 6] >> (u & 63)) & 1;
+    }
+
+ private:
+    uint64_t m_bits[4];
+};
+
+// Returns index to the first character in the set after pos, or INDEX_NONE.
+// This is faster than std::string_view::find_first_of,
+// which compares each character with every item in the set.
+constexpr size_t FindFirstOf(std::string_view str, const CharSet& set,
+                             size_t pos = 0) noexcept {
+    for (; pos < str.size(); pos++) {
+        if (set.Contains(str[pos]))
+            return pos;
+    }
+    return INDEX_NONE;
+}
+
 // Returns true if the string consists of only digits.
 bool StrIsDigit(const std::string& str) noexcept;
 bool StrIsDigit(const std::string_view& str) noexcept;
@@ -0,0 +1,65 @@
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+#include "cpplint_state.h"
+#include "options.h"
+#include "pipeline.h"
+
+namespace fs = std::filesystem;
+
+// Compares errors of a file between two runs.
+// Errors with the same category and message are matched by line numbers first.
+// The rest of them are matched in order, so errors moved by inserted or deleted
+// lines are not reported as new ones.
+void DiffErrors(const std::vector<ErrorRecord>& old_errors,
+                const std::vector<ErrorRecord>& new_errors,
+                std::vector<ErrorRecord>* added,
+                std::vector<ErrorRecord>* resolved);
+
+// Lints files again when they are changed. (--watch)
+// It watches directories with inotify, so it's only available on Linux.
+class Watcher {
+ private:
+    CppLintState* m_cpplint_state;
+    const Options& m_options;
+    LintPipeline* m_pipeline;
+    int m_inotify_fd;
+    std::set<std::string> m_extensions;
+    std::set<std::string> m_header_extensions;
+
+    // Watched directories for each watch descriptor
+    std::map<int, fs::path> m_dirs;
+
+    // Errors of each linted file from the last run
+    std::map<fs::path, std::vector<ErrorRecord>> m_errors;
+
+    // Watches a directory. With recursive, sub-directories are watched as well,
+    // and files found in them are added to new_files.
+    void WatchDirectory(const fs::path& dir, bool recursive, std::set<fs::path>* new_files);
+
+    bool IsInRecursiveDir(const fs::path& path) const;
+    bool ShouldLint(const fs::path& file) const;
+
+    // Adds files affected by an inotify event to changed.
+    void HandleEvent(int wd, uint32_t mask, const char* name, std::set<fs::path>* changed);
+
+    // Lints changed files and prints the differences.
+    void Relint(const std::set<fs::path>& changed);
+
+ public:
+    Watcher(CppLintState* cpplint_state, const Options& options, LintPipeline* pipeline);
+    ~Watcher();
+    Watcher(const Watcher&) = delete;
+    Watcher& operator=(const Watcher&) = delete;
+
+    // Starts watching directories of linted files.
+    // records are errors of the first run. Returns false when inotify is not available.
+    bool Init(const std::vector<fs::path>& files, std::vector<ErrorRecord> records);
+
+    // Waits for changes and lints files again. It only returns when it fails to read events.
+    void Run();
+};
@@ -0,0 +1,256 @@
+#include "binary_report.h"
+#include <cstdint>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "common.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+void BinaryWriter::WriteUint32(uint32_t val) {
+    char bytes[4] = {
+        static_cast<char>(val & 0xff),
+        static_cast<char>((val >> 8) & 0xff),
+        static_cast<char>((val >> 16) & 0xff),
+        static_cast<char>((val >> 24) & 0xff),
+    };
+    m_buffer.append(bytes, 4);
+}
+
+void BinaryWriter::WriteRecordHeader(uint32_t payload_size, uint8_t type) {
+    WriteUint32(payload_size);
+    m_buffer.push_back(static_cast<char>(type));
+}
+
+uint32_t BinaryWriter::InternString(std::string_view str) {
+    auto it = m_string_ids.find(str);
+    if (it != m_string_ids.end())
+        return it->second;
+
+    uint32_t id = static_cast<uint32_t>(m_string_ids.size());
+    m_string_ids.emplace(str, id);
+    WriteRecordHeader(static_cast<uint32_t>(str.size()), BINARY_RECORD_STRING);
+    m_buffer += str;
+    return id;
+}
+
+void BinaryWriter::WriteHeader() {
+    m_buffer.append(BINARY_MAGIC, BINARY_MAGIC_SIZE);
+    WriteUint32(BINARY_VERSION);
+}
+
+// Numbers in messages are arguments of templates.
+// Numbers in words (e.g. int64) and numbers with leading zeros are kept.
+static bool IsArgument(std::string_view message, size_t begin, size_t end) {
+    if (begin > 0 && IS_WORD_CHAR(message[begin - 1]))
+        return false;
+    if (end < message.size() && IS_WORD_CHAR(message[end]))
+        return false;
+    return (end - begin == 1 || message[begin] != '0') && end - begin <= 9;
+}
+
+void BinaryWriter::WriteError(std::string_view filename, size_t linenum,
+                              std::string_view category, int confidence,
+                              std::string_view message) {
+    m_template.clear();
+    m_args.clear();
+    size_t i = 0;
+    while (i < message.size()) {
+        if (!IS_DIGIT(message[i]) || m_args.size() == UINT8_MAX) {
+            m_template.push_back(message[i]);
+            i++;
+            continue;
+        }
+        size_t end = i;
+        uint32_t value = 0;
+        while (end < message.size() && IS_DIGIT(message[end])) {
+            value = value * 10 + static_cast<uint32_t>(message[end] - '0');
+            end++;
+        }
+        if (IsArgument(message, i, end))
+            m_args.emplace_back(static_cast<uint32_t>(m_template.size()), value);
+        else
+            m_template.append(message, i, end - i);
+        i = end;
+    }
+
+    uint32_t file_id = InternString(filename);
+    uint32_t category_id = InternString(category);
+    uint32_t template_id = InternString(m_template);
+    uint32_t num_args = static_cast<uint32_t>(m_args.size());
+    WriteRecordHeader(BINARY_ERROR_SIZE + num_args * BINARY_ARG_SIZE, BINARY_RECORD_ERROR);
+    WriteUint32(file_id);
+    WriteUint32(static_cast<uint32_t>(linenum));
+    WriteUint32(category_id);
+    WriteUint32(template_id);
+    m_buffer.push_back(static_cast<char>(confidence));
+    m_buffer.push_back(static_cast<char>(num_args));
+    for (const auto& [offset, value] : m_args) {
+        WriteUint32(offset);
+        WriteUint32(value);
+    }
+}
+
+bool MappedFile::Open(const std::string& filename) {
+    Close();
+#ifdef _WIN32
+    HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+    LARGE_INTEGER size = {};
+    if (GetFileSizeEx(file, &size) && size.QuadPart > 0) {
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping != nullptr) {
+            m_ptr = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+            CloseHandle(mapping);
+            if (m_ptr != nullptr)
+                m_size = static_cast<size_t>(size.QuadPart);
+        }
+    }
+    CloseHandle(file);
+    if (m_ptr != nullptr || size.QuadPart == 0)
+        return true;
+#else
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+    struct stat st;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode)) {
+        if (st.st_size == 0) {
+            close(fd);
+            return true;
+        }
+        void* ptr = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        if (ptr != MAP_FAILED) {
+            m_ptr = ptr;
+            m_size = static_cast<size_t>(st.st_size);
+            close(fd);
+            return true;
+        }
+    }
+    close(fd);
+#endif
+    // e.g. pipes
+    std::ifstream file(filename, std::ios::binary);
+    if (!file)
+        return false;
+    m_content.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    return true;
+}
+
+void MappedFile::Close() {
+    if (m_ptr != nullptr) {
+#ifdef _WIN32
+        UnmapViewOfFile(m_ptr);
+#else
+        munmap(m_ptr, m_size);
+#endif
+    }
+    m_ptr = nullptr;
+    m_size = 0;
+    m_content.clear();
+}
+
+std::string_view MappedFile::Data() const {
+    if (m_ptr != nullptr)
+        return std::string_view(static_cast<const char*>(m_ptr), m_size);
+    return m_content;
+}
+
+BinaryReader::BinaryReader(std::string_view data) :
+        m_data(data),
+        m_pos(0),
+        m_strings({}),
+        m_message(""),
+        m_error_message("") {
+    uint32_t version = 0;
+    if (!m_data.starts_with(std::string_view(BINARY_MAGIC, BINARY_MAGIC_SIZE))) {
+        SetError("Not a binary output of cpplint-cpp.");
+    } else {
+        m_pos = BINARY_MAGIC_SIZE;
+        if (!ReadUint32(&version) || version != BINARY_VERSION)
+            SetError("Unsupported version of binary output.");
+    }
+}
+
+bool BinaryReader::ReadUint32(uint32_t* val) {
+    if (m_data.size() - m_pos < 4)
+        return false;
+    const unsigned char* bytes =
+        reinterpret_cast<const unsigned char*>(m_data.data() + m_pos);
+    *val = static_cast<uint32_t>(bytes[0]) |
+           (static_cast<uint32_t>(bytes[1]) << 8) |
+           (static_cast<uint32_t>(bytes[2]) << 16) |
+           (static_cast<uint32_t>(bytes[3]) << 24);
+    m_pos += 4;
+    return true;
+}
+
+bool BinaryReader::ReadError(BinaryError* error) {
+    while (m_pos < m_data.size()) {
+        uint32_t size;
+        if (!ReadUint32(&size) || m_pos >= m_data.size() ||
+            m_data.size() - m_pos - 1 < size)
+            return SetError("Unexpected end of binary output.");
+        uint8_t type = static_cast<uint8_t>(m_data[m_pos]);
+        m_pos++;
+        size_t record_end = m_pos + size;
+
+        if (type == BINARY_RECORD_STRING) {
+            m_strings.emplace_back(m_data.substr(m_pos, size));
+        } else if (type == BINARY_RECORD_ERROR) {
+            if (size < BINARY_ERROR_SIZE)
+                return SetError("Broken error record in binary output.");
+            uint32_t ids[4];
+            for (uint32_t& id : ids)
+                ReadUint32(&id);
+            if (ids[0] >= m_strings.size() || ids[2] >= m_strings.size() ||
+                ids[3] >= m_strings.size())
+                return SetError("Undefined string in binary output.");
+            error->filename = m_strings[ids[0]];
+            error->linenum = ids[1];
+            error->category = m_strings[ids[2]];
+            error->confidence = static_cast<uint8_t>(m_data[m_pos]);
+            size_t num_args = static_cast<uint8_t>(m_data[m_pos + 1]);
+            m_pos += 2;
+            if (size < BINARY_ERROR_SIZE + num_args * BINARY_ARG_SIZE)
+                return SetError("Broken error record in binary output.");
+
+            // Fill the template with arguments.
+            std::string_view tmpl = m_strings[ids[3]];
+            m_message.clear();
+            size_t copied = 0;
+            for (size_t i = 0; i < num_args; i++) {
+                uint32_t offset;
+                uint32_t value;
+                ReadUint32(&offset);
+                ReadUint32(&value);
+                if (offset < copied || offset > tmpl.size())
+                    return SetError("Broken error record in binary output.");
+                m_message.append(tmpl, copied, offset - copied);
+                m_message += std::to_string(value);
+                copied = offset;
+            }
+            m_message.append(tmpl, copied);
+            error->message = m_message;
+            m_pos = record_end;
+            return true;
+        }
+        // Skip unknown records for forward compatibility.
+        m_pos = record_end;
+    }
+    return false;
+}
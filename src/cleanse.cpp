@@ -1,4 +1,5 @@
 #include "cleanse.h"
+#include <algorithm>
 #include <cassert>
 #include <map>
 #include <string>
@@ -6,6 +7,7 @@
 #include <vector>
 #include "cpplint_state.h"
 #include "line_utils.h"
+#include "profiler.h"
 #include "regex_utils.h"
 #include "string_utils.h"
 
@@ -53,18 +55,22 @@ std::string GetReAltTokenReplacement() {
     return pattern;
 }
 
-const regex_code RE_PATTERN_INCLUDE = RegexCompile(R"(^\s*#\s*include\s*([<"])([^>"]*)[>"].*$)");
-static const regex_code RE_PATTERN_ALT_TOKEN_REPLACEMENT =
-    RegexCompile(GetReAltTokenReplacement());
+const regex_code& GetIncludePattern() {
+    static const regex_code RE_PATTERN_INCLUDE =
+        RegexCompile(R"(^\s*#\s*include\s*([<"])([^>"]*)[>"].*$)");
+    return RE_PATTERN_INCLUDE;
+}
 
-std::vector<std::string>
-CleansedLines::CleanseRawStrings(const std::vector<std::string>& raw_lines) {
+void CleansedLines::CleanseRawStrings(const std::vector<std::string>& raw_lines,
+                                      std::vector<std::string>* lines_without_raw_strings) {
     std::string delimiter = "";
-    std::vector<std::string> lines_without_raw_strings;
-    lines_without_raw_strings.reserve(raw_lines.size());
+    // Existing elements are overwritten to reuse their buffers.
+    lines_without_raw_strings->resize(raw_lines.size());
 
-    for (const std::string& line : raw_lines) {
-        std::string new_line = line;
+    for (size_t i = 0; i < raw_lines.size(); i++) {
+        const std::string& line = raw_lines[i];
+        std::string& new_line = (*lines_without_raw_strings)[i];
+        new_line.assign(line);
         if (!delimiter.empty()) {
             // Inside a raw string, look for the end
             size_t end = line.find(delimiter);
@@ -124,27 +130,25 @@ CleansedLines::CleanseRawStrings(const std::vector<std::string>& raw_lines) {
                 break;
             }
         }
-
-        lines_without_raw_strings.emplace_back(std::move(new_line));
     }
 
   // TODO(unknown): if delimiter is not None here, we might want to
   // emit a warning for unterminated string.
-  return lines_without_raw_strings;
 }
 
 // Match a single C style comment on the same line.
 #define RE_PATTERN_C_COMMENTS R"(/\*(?:[^*]|\*(?!/))*\*/)"
 
-std::string CleanseComments(const std::string& line, bool* is_comment) {
+void CleanseComments(const std::string& line, bool* is_comment, std::string* new_line) {
     size_t commentpos = line.find("//");
-    std::string new_line = line;
-    if (commentpos != std::string::npos) {
-        std::string sub_line = line.substr(0, commentpos);
-        if (!IsCppString(sub_line)) {
-            new_line = StrRstrip(sub_line);
-            *is_comment = true;
-        }
+    if (commentpos != std::string::npos &&
+        !IsCppString(std::string_view(line).substr(0, commentpos))) {
+        while (commentpos > 0 && IS_SPACE(line[commentpos - 1]))
+            commentpos--;
+        new_line->assign(line, 0, commentpos);
+        *is_comment = true;
+    } else {
+        new_line->assign(line);
     }
 
     /* Matches multi-line C style comments.
@@ -165,15 +169,18 @@ std::string CleanseComments(const std::string& line, bool* is_comment) {
 
     // get rid of /* ... */
     bool replaced = false;
-    RegexReplace(RE_PATTERN_CLEANSE_LINE_C_COMMENTS, "", &new_line, &replaced);
+    RegexReplace(RE_PATTERN_CLEANSE_LINE_C_COMMENTS, "", new_line, &replaced);
     if (replaced)
         *is_comment = true;
-    return new_line;
 }
 
-std::string CleansedLines::ReplaceAlternateTokens(const std::string& line) {
-    std::string str = line;
-    std::string ret = line;
+void CleansedLines::ReplaceAlternateTokens(std::string* line) {
+    static const regex_code RE_PATTERN_ALT_TOKEN_REPLACEMENT =
+        RegexCompile(GetReAltTokenReplacement());
+    // Most lines have no tokens. Copy the line only when it has them.
+    if (!RegexMatch(RE_PATTERN_ALT_TOKEN_REPLACEMENT, *line))
+        return;
+    std::string str = *line;
     while (!str.empty()) {
         bool match = RegexMatch(RE_PATTERN_ALT_TOKEN_REPLACEMENT, str, m_re_result);
         if (!match)
@@ -184,22 +191,24 @@ std::string CleansedLines::ReplaceAlternateTokens(const std::string& line) {
                             StrIsChar(GetMatchStrView(m_re_result, str, 3), ' ')) ? "" : "\\3";
         // replace the found token
         RegexReplace(RE_PATTERN_ALT_TOKEN_REPLACEMENT,
-                     std::string("\\1") + token + tail, &ret, false);
+                     std::string("\\1") + token + tail, line, false);
         // remove the replaced part from str
         str = str.substr(GetMatchEnd(m_re_result, 0));
     }
-    return ret;
 }
 
-std::string CleansedLines::CollapseStrings(const std::string& elided) {
-    if (RegexMatch(RE_PATTERN_INCLUDE, elided))
-        return elided;
+void CleansedLines::CollapseStrings(const std::string& elided, std::string* collapsed) {
+    if (RegexMatch(GetIncludePattern(), elided)) {
+        collapsed->assign(elided);
+        return;
+    }
 
     // Matches standard C++ escape sequences per 2.13.2.3 of the C++ standard.
     static const regex_code RE_PATTERN_CLEANSE_LINE_ESCAPES =
         RegexCompile(R"(\\([abfnrtv?"\\\']|\d+|x[0-9a-fA-F]+))");
 
-    std::string new_elided = elided;
+    std::string& new_elided = m_collapse_buffer;
+    new_elided.assign(elided);
     // Remove escaped characters first to make quote/single quote collapsing
     // basic.  Things that look like escaped characters shouldn't occur
     // outside of strings and chars.
@@ -208,14 +217,14 @@ std::string CleansedLines::CollapseStrings(const std::string& elided) {
     // Replace quoted strings and digit separators.  Both single quotes
     // and double quotes are processed in the same loop, otherwise
     // nested quotes wouldn't work.
-    std::string collapsed = "";
+    collapsed->clear();
     while (1) {
         // Find the first quote character
         static const regex_code RE_PATTERN_QUOTE =
             RegexCompile(R"(^([^\'"]*)([\'"])(.*)$)");
         bool match = RegexMatch(RE_PATTERN_QUOTE, new_elided, m_re_result);
         if (!match) {
-            collapsed += new_elided;
+            collapsed->append(new_elided);
             break;
         }
         std::string_view head = GetMatchStrView(m_re_result, new_elided, 1);
@@ -226,12 +235,13 @@ std::string CleansedLines::CollapseStrings(const std::string& elided) {
             // Collapse double quoted strings
             size_t second_quote = tail.find('"');
             if (second_quote != std::string::npos) {
-                collapsed += std::string(head) + R"("")";
-                new_elided = tail.substr(second_quote + 1);
+                collapsed->append(head);
+                collapsed->append(R"("")");
+                new_elided.erase(0, GetMatchStart(m_re_result, 3) + second_quote + 1);
             } else {
                 // Unmatched double quote, don't bother processing the rest
                 // of the line since this is probably a multiline string.
-                collapsed += new_elided;
+                collapsed->append(new_elided);
                 break;
             }
         } else {
@@ -249,50 +259,112 @@ std::string CleansedLines::CollapseStrings(const std::string& elided) {
                 static const regex_code RE_PATTERN_DIGIT2 =
                     RegexCompile(R"(^((?:\'?[0-9a-zA-Z_])*)(.*)$)");
                 RegexMatch(RE_PATTERN_DIGIT2, subject, m_re_result);
-                collapsed += std::string(head) +
-                             StrReplaceAll(GetMatchStr(m_re_result, subject, 1), "'", "");
+                collapsed->append(head);
+                collapsed->append(StrReplaceAll(GetMatchStr(m_re_result, subject, 1), "'", ""));
                 new_elided = GetMatchStr(m_re_result, subject, 2);
             } else {
                 size_t second_quote = tail.find("\'");
                 if (second_quote != std::string::npos) {
-                    collapsed += std::string(head) + "''";
-                    new_elided = tail.substr(second_quote + 1);
+                    collapsed->append(head);
+                    collapsed->append("''");
+                    new_elided.erase(0, GetMatchStart(m_re_result, 3) + second_quote + 1);
                 } else {
                     // Unmatched single quote
-                    collapsed += new_elided;
+                    collapsed->append(new_elided);
                     break;
                 }
             }
         }
     }
-    return collapsed;
 }
 
-CleansedLines::CleansedLines(std::vector<std::string>& lines,
-                             const Options& options) :
-                             m_elided({}),
-                             m_lines({}),
-                             m_raw_lines(lines),
-                             m_has_comment(lines.size(), false),
-                             m_re_result(RegexCreateMatchData(16)) {
+void CleansedLines::Reset(std::vector<std::string>& lines,
+                          const Options& options,
+                          size_t first_line) {
+    PROFILE_SCOPE("CleansedLines");
+    m_first_line = first_line;
+    m_raw_lines = &lines;
+    m_has_comment.assign(lines.size(), false);
     if (!options.ShouldPrintError("readability/alt_tokens", "", INDEX_NONE)) {
-        for (std::string& line : m_raw_lines) {
-            line = ReplaceAlternateTokens(line);
+        for (std::string& line : lines) {
+            ReplaceAlternateTokens(&line);
         }
     }
-    m_lines.reserve(lines.size());
-    m_elided.reserve(lines.size());
-    m_lines_without_raw_strings = CleanseRawStrings(m_raw_lines);
-    size_t linenum = 0;
-    for (const std::string& line : m_lines_without_raw_strings) {
+    // Strings in the vectors are overwritten to reuse their buffers.
+    CleanseRawStrings(lines, &m_lines_without_raw_strings);
+    m_lines.resize(lines.size());
+    m_elided.resize(lines.size());
+    for (size_t linenum = 0; linenum < lines.size(); linenum++) {
         bool is_comment = false;
-        std::string comment_removed = CleanseComments(line, &is_comment);
+        CleanseComments(m_lines_without_raw_strings[linenum], &is_comment, &m_lines[linenum]);
         if (is_comment) {
             m_has_comment[linenum] = true;
         }
-        std::string elided = CollapseStrings(comment_removed);
-        m_lines.emplace_back(std::move(comment_removed));
-        m_elided.emplace_back(std::move(elided));
-        linenum++;
+        CollapseStrings(m_lines[linenum], &m_elided[linenum]);
+    }
+    ComputeBlockExtents();
+    ComputeStatementBoundaries();
+}
+
+void CleansedLines::ComputeBlockExtents() {
+    // Forward scans for the end of a block cost O(lines) for each block.
+    // We compute them for all lines at once instead.
+    size_t num_lines = m_elided.size();
+
+    // m_brace_depths[i] is the number of { minus the number of } before line i.
+    // The block from line i ends at line j - 1 where j is the first index
+    // after i that has the same depth.
+    m_brace_depths.resize(num_lines + 1);
+    ptrdiff_t depth = 0;
+    ptrdiff_t min_depth = 0;
+    ptrdiff_t max_depth = 0;
+    for (size_t i = 0; i < num_lines; i++) {
+        m_brace_depths[i] = depth;
+        const std::string& line = m_elided[i];
+        depth += StrCount(line, '{') - StrCount(line, '}');
+        min_depth = std::min(min_depth, depth);
+        max_depth = std::max(max_depth, depth);
+    }
+    m_brace_depths[num_lines] = depth;
+
+    // m_depth_lines[depth - min_depth] is the last seen index with the depth.
+    m_depth_lines.assign(static_cast<size_t>(max_depth - min_depth + 1), INDEX_NONE);
+    m_block_ends.resize(num_lines);
+    m_depth_lines[static_cast<size_t>(depth - min_depth)] = num_lines;
+    for (size_t i = num_lines; i-- > 0;) {
+        size_t& next = m_depth_lines[static_cast<size_t>(m_brace_depths[i] - min_depth)];
+        m_block_ends[i] = next == INDEX_NONE ? INDEX_NONE : m_first_line + next - 1;
+        next = i;
+    }
+
+    // Lines for function bodies
+    m_body_starts.resize(num_lines);
+    size_t body_start = INDEX_NONE;
+    for (size_t i = num_lines; i-- > 0;) {
+        if (m_lines[i].find_first_of("{};") != std::string::npos)
+            body_start = m_first_line + i;
+        m_body_starts[i] = body_start;
+    }
+}
+
+void CleansedLines::ComputeStatementBoundaries() {
+    size_t num_lines = m_elided.size();
+    m_prev_non_blank_lines.resize(num_lines);
+    m_prev_statement_ends.resize(num_lines);
+    m_disallow_lines.clear();
+    size_t prev_non_blank = INDEX_NONE;
+    size_t prev_statement_end = INDEX_NONE;
+    for (size_t i = 0; i < num_lines; i++) {
+        m_prev_non_blank_lines[i] = prev_non_blank;
+        m_prev_statement_ends[i] = prev_statement_end;
+        const std::string& line = m_elided[i];
+        if (StrIsBlank(line))
+            continue;
+        prev_non_blank = m_first_line + i;
+        char c = GetLastNonSpace(line);
+        if (c == '{' || c == '}' || c == ';')
+            prev_statement_end = m_first_line + i;
+        if (StrContain(line, "DISALLOW_"))
+            m_disallow_lines.push_back(m_first_line + i);
     }
 }
@@ -1,26 +1,14 @@
 #include <chrono>
-#include <future>
 #include <iostream>
-#include <thread>
 #include <vector>
 #include "cpplint_state.h"
-#include "file_linter.h"
 #include "options.h"
-#include "ThreadPool.h"
+#include "pipeline.h"
+#include "profiler.h"
+#include "watcher.h"
 
 namespace fs = std::filesystem;
 
-static void ProcessFile(const fs::path& filename,
-                        CppLintState* cpplint_state,
-                        const Options& global_options) {
-    FileLinter linter(filename, cpplint_state, global_options);
-    linter.ProcessFile();
-
-    // All outputs are stored in thread local streams.
-    // We flush them here.
-    cpplint_state->FlushThreadStream();
-}
-
 int main(int argc, char** argv) {
     // We don't use cstdio
     std::ios_base::sync_with_stdio(false);
@@ -35,27 +23,53 @@ int main(int argc, char** argv) {
     // Parse argv
     filenames = global_options.ParseArguments(argc, argv, &cpplint_state);
 
-    // Generate a future for each file
-    int num_threads = cpplint_state.GetNumThreads();
-    if (num_threads == 1) {
-        // Single-threading
-        for (const fs::path& filename : filenames)
-            ProcessFile(filename, &cpplint_state, global_options);
-    } else {
-        // Multi-threading
-        ThreadPool pool(num_threads);
-        std::vector<std::future<void>> futures;
-        for (const fs::path& filename : filenames) {
-            futures.push_back(pool.enqueue([&filename, &cpplint_state, &global_options]() {
-                ProcessFile(filename, &cpplint_state, global_options);
-            }));
-        }
+    // Print the beginning of a document for structured outputs (e.g. SARIF)
+    cpplint_state.PrintOutputHeader();
+
+    // Files from --file-list and --compile-commands are processed as they are read.
+    FileListReader list_reader(global_options, &cpplint_state);
+    size_t num_files = filenames.size();
+
+    // Print messages of the main thread (e.g. skipped inputs) before outputs for files.
+    cpplint_state.FlushThreadStream();
 
-        // Wait for all futures to complete
-        for (auto&& future : futures) {
-            future.get();
+    // --watch compares errors with the last run.
+    std::vector<fs::path> listed_files;
+    if (global_options.Watch())
+        cpplint_state.SetErrorRecording(true);
+
+    // Files are read, linted, and printed on different threads.
+    // With a single worker, files are still processed in the given order.
+    LintPipeline pipeline(&cpplint_state, global_options, cpplint_state.GetNumThreads());
+    for (const fs::path& filename : filenames)
+        pipeline.Push(filename);
+    list_reader.Read([&cpplint_state, &global_options, &pipeline, &num_files,
+                      &listed_files](const fs::path& filename) {
+        cpplint_state.FlushThreadStream();
+        pipeline.Push(filename);
+        num_files++;
+        if (global_options.Watch())
+            listed_files.push_back(filename);
+    });
+
+    if (global_options.Watch()) {
+        pipeline.Wait();
+        cpplint_state.SetErrorRecording(false);
+        if (!cpplint_state.Quiet() || cpplint_state.ErrorCount() > 0)
+            cpplint_state.PrintErrorCounts();
+        filenames.insert(filenames.end(), listed_files.begin(), listed_files.end());
+
+        // Keeps the pipeline and cached configs for changed files.
+        Watcher watcher(&cpplint_state, global_options, &pipeline);
+        if (!watcher.Init(filenames, cpplint_state.TakeErrorRecords())) {
+            cpplint_state.PrintError("Failed to watch files.\n");
+            cpplint_state.FlushThreadStream();
+            return 1;
         }
+        watcher.Run();
+        return 1;
     }
+    pipeline.Finish();
 
     // If --quiet is passed, suppress printing error count unless there are errors.
     if (!cpplint_state.Quiet() || cpplint_state.ErrorCount() > 0)
@@ -68,9 +82,27 @@ int main(int argc, char** argv) {
         double elapsed_sec = static_cast<double>(elapsed_ms) / 1000;
         cpplint_state.PrintInfo(
             "Runtime: " + std::to_string(elapsed_sec) + "(s)\n");
+        cpplint_state.PrintInfo(pipeline.GetUtilizationReport(elapsed_sec));
+        cpplint_state.PrintInfo(pipeline.GetMemoryReport());
     }
 
+#ifdef CPPLINT_PROFILE
+    if (global_options.Profile())
+        cpplint_state.PrintInfo(ProfilerReport());
+#endif
+
     cpplint_state.FlushThreadStream();
+    cpplint_state.PrintOutputFooter();
+
+    if (!global_options.ShardSummary().empty()) {
+        bool written = cpplint_state.WriteShardSummary(
+            global_options.ShardSummary(), global_options.ShardIndex(),
+            global_options.ShardCount(), num_files);
+        if (!written) {
+            std::cerr << "Failed to write shard summary: " <<
+                         global_options.ShardSummary() << "\n";
+        }
+    }
 
     if (cpplint_state.OutputFormat() == OUTPUT_JUNIT)
         std::cerr << cpplint_state.FormatJUnitXML();
@@ -0,0 +1,186 @@
+#include <cstdlib>
+#include <iostream>
+#include <set>
+#include <string>
+#include <vector>
+#include "binary_report.h"
+#include "cpplint_state.h"
+#include "string_utils.h"
+
+// Merges binary outputs of cpplint-cpp (--output=binary) and prints them.
+
+static const char USAGE[] =
+    "Syntax: cpplint-report [--output=emacs|eclipse|vs7|sed|gsed|sarif|ndjson|binary]\n"
+    "                       [--counting=total|toplevel|detailed]\n"
+    "                       [--counts] [--summary]\n"
+    "                       [--quiet]\n"
+    "                       <file> [file] ...\n"
+    "\n"
+    "  Merges binary outputs of cpplint-cpp (--output=binary) and prints the errors\n"
+    "  in the same way as cpplint-cpp does.\n"
+    "\n"
+    "  Flags:\n"
+    "\n"
+    "    output=emacs|eclipse|vs7|sed|gsed|sarif|ndjson|binary\n"
+    "      Output format for errors. Use binary to merge files into one.\n"
+    "\n"
+    "    counting=total|toplevel|detailed\n"
+    "      The total number of errors found is always printed. If\n"
+    "      'toplevel' is provided, then the count of errors in each of\n"
+    "      the top-level categories like 'build' and 'whitespace' will\n"
+    "      also be printed. If 'detailed' is provided, then a count\n"
+    "      is provided for each category like 'build/class'.\n"
+    "\n"
+    "    counts\n"
+    "      Print only the error counts. --counting=detailed is used by default.\n"
+    "\n"
+    "    summary\n"
+    "      Read files written by --shard-summary instead of binary outputs, and\n"
+    "      print the error counts of all shards. --counts is implied.\n"
+    "\n"
+    "    quiet\n"
+    "      Don't print the error counts if no errors are found.\n";
+
+[[noreturn]] static void PrintUsage(const std::string& message = "") {
+    std::cerr << USAGE;
+    if (!message.empty()) {
+        std::cerr << "\nFATAL ERROR: " << message << "\n";
+        exit(1);
+    }
+    exit(0);
+}
+
+static std::string ArgToValue(const std::string& arg) {
+    return StrAfterChar(arg, '=');
+}
+
+// Returns false when some files are broken.
+static bool MergeBinaryFiles(const std::vector<std::string>& filenames, bool counts_only,
+                             CppLintState* cpplint_state) {
+    bool ok = true;
+    MappedFile data;
+    for (const std::string& filename : filenames) {
+        if (!data.Open(filename)) {
+            std::cerr << "Skipping input '" << filename << "': Can't open for reading\n";
+            ok = false;
+            continue;
+        }
+
+        BinaryReader reader(data.Data());
+        BinaryError error;
+        while (reader.ReadError(&error)) {
+            std::string category(error.category);
+            if (counts_only) {
+                cpplint_state->IncrementErrorCount(category);
+            } else {
+                cpplint_state->Error(std::string(error.filename), error.linenum,
+                                     category, error.confidence,
+                                     std::string(error.message));
+            }
+        }
+        if (!reader.ErrorMessage().empty()) {
+            std::cerr << "Broken input '" << filename << "': " << reader.ErrorMessage() << "\n";
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+// Merges shard summaries and checks that no shards are missing.
+// Returns false when some files are broken.
+static bool MergeShardSummaries(const std::vector<std::string>& filenames,
+                                CppLintState* cpplint_state) {
+    bool ok = true;
+    std::set<std::string> shards;
+    std::string shard_count;
+    for (const std::string& filename : filenames) {
+        std::string shard = "0/1";
+        if (!cpplint_state->ReadShardSummary(filename, &shard)) {
+            std::cerr << "Broken input '" << filename << "': Not a shard summary\n";
+            ok = false;
+            continue;
+        }
+        if (!shards.insert(shard).second)
+            std::cerr << "Warning: Shard " << shard << " is merged more than once.\n";
+        shard_count = StrAfterChar(shard, '/');
+    }
+    size_t count = StrToUint(shard_count);
+    if (count != INDEX_NONE && count > shards.size()) {
+        std::cerr << "Warning: Only " << shards.size() << " of " <<
+                     count << " shards are merged.\n";
+    }
+    return ok;
+}
+
+int main(int argc, char** argv) {
+    std::ios_base::sync_with_stdio(false);
+
+    std::string output_format = "emacs";
+    std::string counting_style = "";
+    bool counts_only = false;
+    bool summary = false;
+    bool quiet = false;
+
+    char** argp = argv + 1;
+    for (; argp < argv + argc; argp++) {
+        std::string opt = argp[0];
+        if (!opt.starts_with("--"))
+            break;  // opt is not an option
+        if (opt == "--help") {
+            PrintUsage();
+        } else if (opt.starts_with("--output=")) {
+            output_format = ArgToValue(opt);
+            if (!InStrVec({ "emacs", "vs7", "eclipse", "sed", "gsed",
+                            "sarif", "ndjson", "binary" }, output_format)) {
+                PrintUsage("The only allowed output formats are "
+                           "emacs, vs7, eclipse, sed, gsed, sarif, ndjson and binary.");
+            }
+        } else if (opt.starts_with("--counting=")) {
+            counting_style = ArgToValue(opt);
+            if (!InStrVec({ "total", "toplevel", "detailed" }, counting_style)) {
+                PrintUsage("Valid counting options are total, toplevel, and detailed");
+            }
+        } else if (opt == "--counts") {
+            counts_only = true;
+        } else if (opt == "--summary") {
+            summary = true;
+            counts_only = true;
+        } else if (opt == "--quiet") {
+            quiet = true;
+        } else {
+            PrintUsage("Invalid arguments. (" + opt + ")");
+        }
+    }
+
+    if (argp == argv + argc)
+        PrintUsage("No files were specified.");
+
+    CppLintState cpplint_state = CppLintState();
+    if (counts_only) {
+        // Counts are printed as infos
+        output_format = "emacs";
+        if (counting_style.empty())
+            counting_style = "detailed";
+    }
+    cpplint_state.SetOutputFormat(output_format);
+    cpplint_state.SetCountingStyle(counting_style);
+    cpplint_state.SetQuiet(quiet);
+    cpplint_state.PrintOutputHeader();
+
+    std::vector<std::string> filenames(argp, argv + argc);
+    bool merged;
+    if (summary)
+        merged = MergeShardSummaries(filenames, &cpplint_state);
+    else
+        merged = MergeBinaryFiles(filenames, counts_only, &cpplint_state);
+
+    if (!cpplint_state.Quiet() || cpplint_state.ErrorCount() > 0)
+        cpplint_state.PrintErrorCounts();
+
+    cpplint_state.FlushThreadStream();
+    cpplint_state.PrintOutputFooter();
+
+    if (!merged)
+        return 2;
+    return cpplint_state.ErrorCount() > 0;
+}
@@ -1,5 +1,9 @@
 #include "cpplint_state.h"
 #include <cassert>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <functional>
 #include <iostream>
 #include <map>
 #include <mutex>
@@ -7,29 +11,65 @@
 #include <string>
 #include <utility>
 #include <vector>
+#include "binary_report.h"
 #include "string_utils.h"
+#include "version.h"
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#endif
 
 CppLintState::CppLintState() :
     m_verbose_level(1),
     m_error_count(0),
     m_counting(COUNT_TOTAL),
     m_errors_by_category({}),
+    m_shard_summary(false),
+    m_shard_counts({}),
+    m_category_counts(),
     m_quiet(false),
     m_output_format(OUTPUT_EMACS),
-    m_num_threads(0) {}
+    m_num_threads(0),
+    m_sarif_has_result(false),
+    m_writer(),
+    m_writer_cv(),
+    m_writer_space_cv(),
+    m_writer_running(false),
+    m_pending_out(),
+    m_pending_err(),
+    m_writer_busy_ns(0),
+    m_sync_requested(false),
+    m_record_errors(false),
+    m_print_errors(true),
+    m_error_records() {}
+
+void CppLintState::IncrementErrorCount(const std::string& category, int count) {
+    m_error_count += count;
+    AddCategoryCount(category, count);
+}
 
-void CppLintState::IncrementErrorCount(const std::string& category) {
+void CppLintState::AddCategoryCount(const std::string& category, int count) {
     std::string cat = category;
-    m_error_count += 1;
+    if (m_shard_summary)
+        m_shard_counts[cat] += count;
     if (m_counting == COUNT_TOTAL)
         return;  // No need for detailed error counts.
     if (m_counting == COUNT_TOPLEVEL)
         cat = StrBeforeChar(cat, '/');
     auto it = m_errors_by_category.find(cat);
     if (it == m_errors_by_category.end())
-        m_errors_by_category[cat] = 1;
+        m_errors_by_category[cat] = count;
     else
-        it->second += 1;
+        it->second += count;
+}
+
+void CppLintState::MergeCategoryCounts() {
+    for (size_t i = 0; i < NUM_ERROR_CATEGORIES; i++) {
+        if (m_category_counts[i] > 0)
+            AddCategoryCount(ERROR_CATEGORIES[i], m_category_counts[i]);
+    }
+    m_category_counts.fill(0);
 }
 
 int CppLintState::ErrorCount(const std::string& category) const {
@@ -38,14 +78,26 @@ int CppLintState::ErrorCount(const std::string& category) const {
         return 0;
     if (m_counting == COUNT_TOPLEVEL)
         cat = StrBeforeChar(cat, '/');
+    int count = 0;
     auto it = m_errors_by_category.find(cat);
-    if (it == m_errors_by_category.end())
-        return 0;
-    else
-        return it->second;
+    if (it != m_errors_by_category.end())
+        count = it->second;
+
+    // Counts of interned categories that are not merged yet
+    for (size_t i = 0; i < NUM_ERROR_CATEGORIES; i++) {
+        if (m_category_counts[i] == 0)
+            continue;
+        std::string_view name = ERROR_CATEGORIES[i];
+        if (m_counting == COUNT_TOPLEVEL)
+            name = name.substr(0, name.find('/'));
+        if (name == cat)
+            count += m_category_counts[i];
+    }
+    return count;
 }
 
 void CppLintState::PrintErrorCounts() {
+    MergeCategoryCounts();
     for (const auto& item : m_errors_by_category) {
         PrintInfo("Category \'" + item.first +
                   "\' errors found: " + std::to_string(item.second) + "\n");
@@ -55,6 +107,44 @@ void CppLintState::PrintErrorCounts() {
     }
 }
 
+static const char SHARD_SUMMARY_HEADER[] = "cpplint-cpp shard summary 1";
+
+bool CppLintState::WriteShardSummary(const std::string& path, size_t shard_index,
+                                     size_t shard_count, size_t num_files) {
+    std::ofstream file(path);
+    if (!file)
+        return false;
+    MergeCategoryCounts();
+    file << SHARD_SUMMARY_HEADER << "\n"
+         << "shard " << shard_index << "/" << shard_count << "\n"
+         << "files " << num_files << "\n"
+         << "total " << m_error_count << "\n";
+    for (const auto& item : m_shard_counts)
+        file << "category " << item.first << " " << item.second << "\n";
+    return static_cast<bool>(file);
+}
+
+bool CppLintState::ReadShardSummary(const std::string& path, std::string* shard) {
+    std::ifstream file(path);
+    std::string line;
+    if (!file || !std::getline(file, line) || line != SHARD_SUMMARY_HEADER)
+        return false;
+
+    while (std::getline(file, line)) {
+        std::vector<std::string> items = StrSplit(line);
+        if (items.size() == 2 && items[0] == "shard") {
+            *shard = items[1];
+        } else if (items.size() == 3 && items[0] == "category") {
+            size_t count = StrToUint(items[2]);
+            if (count == INDEX_NONE)
+                return false;
+            IncrementErrorCount(items[1], static_cast<int>(count));
+        }
+        // The total count is the sum of categories. Other lines are just infos.
+    }
+    return true;
+}
+
 // Use buffers to avoid mutex locks
 thread_local std::ostringstream cout_buffer;
 thread_local std::ostringstream cerr_buffer;
@@ -62,12 +152,18 @@ thread_local std::ostringstream cerr_buffer;
 // Flush streams when the buffer size is larger than this value
 static const std::streampos FLUSH_THRESHOLD = 1024;
 
+// FlushThreadStream() waits for the writer thread when it has more outputs than this.
+static const size_t MAX_PENDING_OUTPUT = 1 << 20;
+
 void CppLintState::PrintInfo(const std::string& message) {
     // _quiet does not represent --quiet flag.
     // Hide infos from stdout to keep stdout pure for machine consumption
     if (m_output_format != OUTPUT_JUNIT &&
         m_output_format != OUTPUT_SED &&
-        m_output_format != OUTPUT_GSED)
+        m_output_format != OUTPUT_GSED &&
+        m_output_format != OUTPUT_SARIF &&
+        m_output_format != OUTPUT_NDJSON &&
+        m_output_format != OUTPUT_BINARY)
         cout_buffer << message;
 }
 
@@ -79,7 +175,7 @@ void CppLintState::PrintError(const std::string& message) {
     }
 }
 
-const std::map<std::string, std::string> SED_FIXUPS = {
+const std::map<std::string, std::string, std::less<>> SED_FIXUPS = {
     { "Remove spaces around =", R"(s/ = /=/)" },
     { "Remove spaces around !=", R"(s/ != /!=/)" },
     { "Remove space before ( in if (", R"(s/if (/if(/)" },
@@ -94,9 +190,105 @@ const std::map<std::string, std::string> SED_FIXUPS = {
     { "Missing space after ,", R"(s/,\([^ ]\)/, \1/g)" },
 };
 
-void CppLintState::Error(const std::string& filename, size_t linenum,
-           const std::string& category, int confidence,
-           const std::string& message) {
+// Returns the size of a valid UTF-8 sequence at the start of str, or 0.
+static size_t Utf8SequenceSize(std::string_view str) {
+    const unsigned char c = static_cast<unsigned char>(str[0]);
+    size_t size;
+    unsigned char min = 0x80;  // Range of the second byte
+    unsigned char max = 0xBF;
+    if (c >= 0xC2 && c <= 0xDF) {
+        size = 2;
+    } else if (c >= 0xE0 && c <= 0xEF) {
+        size = 3;
+        if (c == 0xE0)
+            min = 0xA0;  // Overlong
+        else if (c == 0xED)
+            max = 0x9F;  // Surrogates
+    } else if (c >= 0xF0 && c <= 0xF4) {
+        size = 4;
+        if (c == 0xF0)
+            min = 0x90;  // Overlong
+        else if (c == 0xF4)
+            max = 0x8F;  // Larger than U+10FFFF
+    } else {
+        return 0;
+    }
+    if (str.size() < size)
+        return 0;
+    for (size_t i = 1; i < size; i++) {
+        const unsigned char next = static_cast<unsigned char>(str[i]);
+        if (next < min || next > max)
+            return 0;
+        min = 0x80;
+        max = 0xBF;
+    }
+    return size;
+}
+
+// Writes a string as a JSON string literal.
+// Invalid UTF-8 bytes are replaced with U+FFFD, so the document stays valid.
+static void WriteJsonString(std::ostream& stream, std::string_view str) {
+    static const char HEX_DIGITS[] = "0123456789abcdef";
+    stream << '"';
+    for (size_t i = 0; i < str.size(); i++) {
+        const char c = str[i];
+        if (static_cast<unsigned char>(c) >= 0x80) {
+            size_t size = Utf8SequenceSize(str.substr(i));
+            if (size == 0) {
+                stream << "\\ufffd";
+            } else {
+                stream << str.substr(i, size);
+                i += size - 1;
+            }
+            continue;
+        }
+        switch (c) {
+            case '"':
+                stream << "\\\"";
+                break;
+            case '\\':
+                stream << "\\\\";
+                break;
+            case '\n':
+                stream << "\\n";
+                break;
+            case '\r':
+                stream << "\\r";
+                break;
+            case '\t':
+                stream << "\\t";
+                break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    stream << "\\u00" << HEX_DIGITS[(c >> 4) & 0xf] << HEX_DIGITS[c & 0xf];
+                } else {
+                    stream << c;
+                }
+        }
+    }
+    stream << '"';
+}
+
+// Writes a file path as a relative URI reference for SARIF.
+static void WriteSarifUri(std::ostream& stream, const std::string& filename) {
+#ifdef _WIN32
+    WriteJsonString(stream, StrReplaceAll(filename, "\\", "/"));
+#else
+    WriteJsonString(stream, filename);
+#endif
+}
+
+bool CppLintState::FormatError(const std::string& filename, size_t linenum,
+                               std::string_view category, int confidence,
+                               std::string_view message) {
+    if (m_record_errors) {
+        std::lock_guard<std::mutex> lock(m_mtx);
+        m_error_records.push_back({ filename, linenum, std::string(category),
+                                    confidence, std::string(message) });
+        if (!m_print_errors)
+            return false;
+    }
+
     if (m_output_format == OUTPUT_VS7) {
         cerr_buffer << filename << "(" << linenum << "): error cpplint: [" <<
                        category << "] " << message << " [" << confidence << "]\n";
@@ -122,46 +314,265 @@ void CppLintState::Error(const std::string& filename, size_t linenum,
             cerr_buffer << "# " << filename << ":" << linenum << ": " <<
                            " \"" << message << "\"  [" << category << "] [" << confidence << "]\n";
         }
+    } else if (m_output_format == OUTPUT_SARIF) {
+        // Results are separated by commas. The first result in the buffer doesn't
+        // need a separator because FlushCoutBuffer() will add it if needed.
+        if (cout_buffer.tellp() > 0)
+            cout_buffer << ",\n";
+        cout_buffer << "        {\"ruleId\": ";
+        WriteJsonString(cout_buffer, category);
+        cout_buffer << ", \"level\": \"warning\", \"message\": {\"text\": ";
+        WriteJsonString(cout_buffer, message);
+        cout_buffer << "}, \"locations\": [{\"physicalLocation\": {"
+                       "\"artifactLocation\": {\"uri\": ";
+        WriteSarifUri(cout_buffer, filename);
+        cout_buffer << "}";
+        // SARIF requires startLine >= 1. Line 0 means the whole file.
+        if (linenum > 0)
+            cout_buffer << ", \"region\": {\"startLine\": " << linenum << "}";
+        cout_buffer << "}}], \"properties\": {\"confidence\": " << confidence << "}}";
+    } else if (m_output_format == OUTPUT_NDJSON) {
+        cout_buffer << "{\"file\": ";
+        WriteJsonString(cout_buffer, filename);
+        cout_buffer << ", \"line\": " << linenum << ", \"category\": ";
+        WriteJsonString(cout_buffer, category);
+        cout_buffer << ", \"confidence\": " << confidence << ", \"message\": ";
+        WriteJsonString(cout_buffer, message);
+        cout_buffer << "}\n";
+    } else if (m_output_format == OUTPUT_BINARY) {
+        // String IDs are shared by all threads.
+        // So, binary records are written with the lock below.
     } else {
         cerr_buffer << filename << ":" << linenum << ":  " << message << "  [" <<
                        category << "] [" << confidence << "]\n";
     }
+    return true;
+}
 
-    std::lock_guard<std::mutex> lock(m_mtx);
-    IncrementErrorCount(category);
+void CppLintState::FlushErrorBuffers(const std::string& filename, size_t linenum,
+                                     std::string_view category, int confidence,
+                                     std::string_view message) {
+    if (m_output_format == OUTPUT_BINARY) {
+        m_binary_writer.WriteError(filename, linenum, category, confidence, message);
+        if (m_binary_writer.Buffer().size() > static_cast<size_t>(FLUSH_THRESHOLD))
+            FlushBinaryBuffer();
+    }
 
     // Flush large buffers
-    if (cout_buffer.tellp() > FLUSH_THRESHOLD) {
-        std::cout << cout_buffer.str();
-        cout_buffer.str("");
-        cout_buffer.clear();
-    }
+    if (cout_buffer.tellp() > FLUSH_THRESHOLD)
+        FlushCoutBuffer();
     if (cerr_buffer.tellp() > FLUSH_THRESHOLD) {
-        std::cerr << cerr_buffer.str();
+        WriteErr(cerr_buffer.str());
         cerr_buffer.str("");
         cerr_buffer.clear();
     }
 }
 
-void CppLintState::FlushThreadStream() {
-    if (cout_buffer.tellp() == 0 && cerr_buffer.tellp() == 0)
+void CppLintState::Error(const std::string& filename, size_t linenum,
+                         ErrorCategory category, int confidence,
+                         std::string_view message) {
+    if (!FormatError(filename, linenum, category.Name(), confidence, message))
         return;
+    std::lock_guard<std::mutex> lock(m_mtx);
+    IncrementErrorCount(category);
+    FlushErrorBuffers(filename, linenum, category.Name(), confidence, message);
+}
+
+void CppLintState::Error(const std::string& filename, size_t linenum,
+                         const std::string& category, int confidence,
+                         const std::string& message) {
+    if (!FormatError(filename, linenum, category, confidence, message))
+        return;
+    std::lock_guard<std::mutex> lock(m_mtx);
+    IncrementErrorCount(category);
+    FlushErrorBuffers(filename, linenum, category, confidence, message);
+}
+
+void CppLintState::SetErrorRecording(bool record, bool print) {
+    std::lock_guard<std::mutex> lock(m_mtx);
+    m_record_errors = record;
+    m_print_errors = print || !record;
+}
 
+std::vector<ErrorRecord> CppLintState::TakeErrorRecords() {
     std::lock_guard<std::mutex> lock(m_mtx);
+    std::vector<ErrorRecord> records;
+    records.swap(m_error_records);
+    return records;
+}
+
+void CppLintState::WriteOut(const std::string& str) {
+    if (m_writer_running) {
+        m_pending_out += str;
+        m_writer_cv.notify_one();
+    } else {
+        std::cout << str;
+    }
+}
+
+void CppLintState::WriteErr(const std::string& str) {
+    if (m_writer_running) {
+        m_pending_err += str;
+        m_writer_cv.notify_one();
+    } else {
+        std::cerr << str;
+    }
+}
 
-    if (cout_buffer.tellp() > 0) {
-        std::cout << cout_buffer.str();
-        cout_buffer.str("");
-        cout_buffer.clear();
+void CppLintState::FlushCoutBuffer() {
+    if (m_output_format == OUTPUT_SARIF) {
+        // Other threads might have written results before.
+        if (m_sarif_has_result)
+            WriteOut(",\n");
+        m_sarif_has_result = true;
     }
+    WriteOut(cout_buffer.str());
+    cout_buffer.str("");
+    cout_buffer.clear();
+}
+
+void CppLintState::FlushBinaryBuffer() {
+    WriteOut(m_binary_writer.Buffer());
+    m_binary_writer.ClearBuffer();
+}
+
+void CppLintState::FlushThreadStream() {
+    if (cout_buffer.tellp() == 0 && cerr_buffer.tellp() == 0 &&
+        m_output_format != OUTPUT_BINARY)
+        return;
+
+    std::unique_lock<std::mutex> lock(m_mtx);
+
+    if (!m_binary_writer.Buffer().empty())
+        FlushBinaryBuffer();
+
+    if (cout_buffer.tellp() > 0)
+        FlushCoutBuffer();
     if (cerr_buffer.tellp() > 0) {
-        std::cerr << cerr_buffer.str();
+        WriteErr(cerr_buffer.str());
         cerr_buffer.str("");
         cerr_buffer.clear();
     }
+
+    // Back-pressure from the output stage
+    m_writer_space_cv.wait(lock, [this] {
+        return m_pending_out.size() + m_pending_err.size() <= MAX_PENDING_OUTPUT;
+    });
+}
+
+void CppLintState::StartWriter() {
+    std::lock_guard<std::mutex> lock(m_mtx);
+    if (m_writer_running)
+        return;
+    m_writer_running = true;
+    m_writer = std::thread([this]() { WriterLoop(); });
+}
+
+void CppLintState::StopWriter() {
+    {
+        std::lock_guard<std::mutex> lock(m_mtx);
+        if (!m_writer_running)
+            return;
+        m_writer_running = false;
+        m_writer_cv.notify_one();
+    }
+    m_writer.join();
+}
+
+void CppLintState::SyncWriter() {
+    std::unique_lock<std::mutex> lock(m_mtx);
+    if (!m_writer_running) {
+        std::cout.flush();
+        return;
+    }
+    m_sync_requested = true;
+    m_writer_cv.notify_one();
+    m_writer_space_cv.wait(lock, [this] { return !m_sync_requested; });
+}
+
+void CppLintState::WriterLoop() {
+    std::string out;
+    std::string err;
+    std::unique_lock<std::mutex> lock(m_mtx);
+    while (true) {
+        m_writer_cv.wait(lock, [this] {
+            return !m_writer_running || m_sync_requested ||
+                   !m_pending_out.empty() || !m_pending_err.empty();
+        });
+        if (!m_pending_out.empty() || !m_pending_err.empty()) {
+            out.swap(m_pending_out);
+            err.swap(m_pending_err);
+            m_writer_space_cv.notify_all();
+            lock.unlock();
+
+            auto start = std::chrono::steady_clock::now();
+            std::cout.write(out.data(), static_cast<std::streamsize>(out.size()));
+            std::cerr.write(err.data(), static_cast<std::streamsize>(err.size()));
+            auto elapsed = std::chrono::steady_clock::now() - start;
+            m_writer_busy_ns +=
+                std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+            out.clear();
+            err.clear();
+
+            lock.lock();
+            continue;
+        }
+        if (m_sync_requested) {
+            // All pending outputs are written.
+            std::cout.flush();
+            m_sync_requested = false;
+            m_writer_space_cv.notify_all();
+            continue;
+        }
+        break;  // Stopped and no outputs left.
+    }
+    std::cout.flush();
 }
 
 std::string CppLintState::GetErrorStreamAsStr() {
     std::lock_guard<std::mutex> lock(m_mtx);
     return cerr_buffer.str();
 }
+
+std::string CppLintState::GetOutputStreamAsStr() {
+    std::lock_guard<std::mutex> lock(m_mtx);
+    return cout_buffer.str();
+}
+
+void CppLintState::PrintOutputHeader() {
+    if (m_output_format == OUTPUT_BINARY) {
+#ifdef _WIN32
+        // Don't convert LF to CRLF
+        std::fflush(stdout);
+        _setmode(_fileno(stdout), _O_BINARY);
+#endif
+        std::lock_guard<std::mutex> lock(m_mtx);
+        m_binary_writer.WriteHeader();
+        FlushBinaryBuffer();
+        return;
+    }
+    if (m_output_format != OUTPUT_SARIF)
+        return;
+    std::cout <<
+        "{\n"
+        "  \"$schema\": \"https://json.schemastore.org/sarif-2.1.0.json\",\n"
+        "  \"version\": \"2.1.0\",\n"
+        "  \"runs\": [\n"
+        "    {\n"
+        "      \"tool\": {\"driver\": {\"name\": \"cpplint-cpp\", "
+        "\"version\": \"" CPPLINT_VERSION "\", "
+        "\"informationUri\": \"https://github.com/matyalatte/cpplint-cpp\"}},\n"
+        "      \"results\": [\n";
+}
+
+void CppLintState::PrintOutputFooter() {
+    if (m_output_format != OUTPUT_SARIF)
+        return;
+    if (m_sarif_has_result)
+        std::cout << "\n";
+    std::cout <<
+        "      ]\n"
+        "    }\n"
+        "  ]\n"
+        "}\n";
+}
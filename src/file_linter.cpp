@@ -1,27 +1,33 @@
 #include "file_linter.h"
+#include <algorithm>
 #include <array>
 #include <cassert>
 #include <filesystem>
 #include <fstream>
 #include <functional>
+#include <future>
 #include <iostream>
 #include <map>
+#include <optional>
 #include <set>
 #include <sstream>
 #include <stack>
 #include <string>
 #include <string_view>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 #include "c_header_list.h"
 #include "cleanse.h"
 #include "common.h"
 #include "cpplint_state.h"
+#include "error_categories.h"
 #include "error_suppressions.h"
 #include "getline.h"
 #include "line_utils.h"
 #include "nest_info.h"
 #include "options.h"
+#include "profiler.h"
 #include "regex_utils.h"
 #include "states.h"
 #include "string_utils.h"
@@ -29,6 +35,7 @@
 namespace fs = std::filesystem;
 
 void FileLinter::CheckForCopyright(const std::vector<std::string>& lines) {
+    PROFILE_SCOPE("CheckForCopyright");
     // We'll say it should occur by line 10. Don't forget there's a
     // placeholder line at the front.
     static const regex_code RE_PATTERN_COPYRIGHT =
@@ -80,18 +87,22 @@ static size_t FindNextMultiLineCommentEnd(const std::vector<std::string>& lines,
     return lines.size();
 }
 
-void FileLinter::RemoveMultiLineComments(std::vector<std::string>& lines) {
+size_t FileLinter::RemoveMultiLineComments(std::vector<std::string>& lines,
+                                           size_t first_line, bool more_lines) {
+    PROFILE_SCOPE("RemoveMultiLineComments");
     size_t lineix = 0;
     while (lineix < lines.size()) {
         size_t lineix_begin = FindNextMultiLineCommentStart(lines, lineix);
         if (lineix_begin >= lines.size()) {
-            return;
+            return INDEX_NONE;
         }
         size_t lineix_end = FindNextMultiLineCommentEnd(lines, lineix_begin);
         if (lineix_end >= lines.size()) {
-            Error(lineix_begin + 1, "readability/multiline_comment", 5,
-                  "Could not find end of multi-line comment");
-            return;
+            if (!more_lines) {
+                Error(first_line + lineix_begin + 1, "readability/multiline_comment", 5,
+                      "Could not find end of multi-line comment");
+            }
+            return lineix_begin;
         }
 
         // Clears a range of lines for multi-line comments.
@@ -106,14 +117,17 @@ void FileLinter::RemoveMultiLineComments(std::vector<std::string>& lines) {
 
         lineix = lineix_end + 1;
     }
+    return INDEX_NONE;
 }
 
-void FileLinter::CheckForNewlineAtEOF(const std::vector<std::string>& lines) {
+void FileLinter::CheckForNewlineAtEOF(const std::vector<std::string>& lines,
+                                      size_t first_line) {
+    PROFILE_SCOPE("CheckForNewlineAtEOF");
     // The array lines() was created by adding two newlines to the original file.
     // To verify that the file ends in \n, we just have to make sure the
     // last-but-two element of lines() exists and is not empty.
-    if (lines.size() < 3 || !lines[lines.size() - 2].empty()) {
-        Error(lines.size() - 2, "whitespace/ending_newline", 5,
+    if (first_line + lines.size() < 3 || !lines[lines.size() - 2].empty()) {
+        Error(first_line + lines.size() - 2, "whitespace/ending_newline", 5,
               "Could not find a newline character at the end of the file.");
     }
 
@@ -127,31 +141,32 @@ void FileLinter::CheckForNewlineAtEOF(const std::vector<std::string>& lines) {
 
 static void ProcessCategoryNextline(FileLinter* linter,
                                     ErrorSuppressions* error_suppressions,
-                                    const std::string& category, size_t linenum) {
+                                    std::optional<ErrorCategory> category, size_t linenum) {
     UNUSED(linter);
     error_suppressions->AddLineSuppression(category, linenum + 1);
 }
 
 static void ProcessCategoryBegin(FileLinter* linter,
                                  ErrorSuppressions* error_suppressions,
-                                 const std::string& category, size_t linenum) {
+                                 std::optional<ErrorCategory> category, size_t linenum) {
     UNUSED(linter);
     error_suppressions->StartBlockSuppression(category, linenum);
 }
 
 static void ProcessCategoryEnd(FileLinter* linter,
                                ErrorSuppressions* error_suppressions,
-                               const std::string& category, size_t linenum) {
-    if (!category.empty()) {
+                               std::optional<ErrorCategory> category, size_t linenum) {
+    if (category) {
         linter->Error(linenum, "readability/nolint", 5,
-                      "NOLINT categories not supported in block END: " + category);
+                      "NOLINT categories not supported in block END: " +
+                      std::string(category->Name()));
     }
     error_suppressions->EndBlockSuppression(linenum);
 }
 
 static void ProcessCategoryDefault(FileLinter* linter,
                                    ErrorSuppressions* error_suppressions,
-                                   const std::string& category, size_t linenum) {
+                                   std::optional<ErrorCategory> category, size_t linenum) {
     UNUSED(linter);
     error_suppressions->AddLineSuppression(category, linenum);
 }
@@ -164,7 +179,7 @@ void FileLinter::ParseNolintSuppressions(const std::string& raw_line,
     if (match) {
         std::string_view no_lint_type = GetMatchStrView(m_re_result, raw_line, 1);
         std::function<void(FileLinter*, ErrorSuppressions*,
-                           const std::string&, size_t)> ProcessCategory;
+                           std::optional<ErrorCategory>, size_t)> ProcessCategory;
 
         if (no_lint_type == "NEXTLINE") {
             ProcessCategory = ProcessCategoryNextline;
@@ -185,13 +200,14 @@ void FileLinter::ParseNolintSuppressions(const std::string& raw_line,
         }
         std::string_view categories = GetMatchStrView(m_re_result, raw_line, 2);
         if (categories.empty() || categories == "(*)") {  // => "suppress all"
-            ProcessCategory(this, &m_error_suppressions, "", linenum);
+            ProcessCategory(this, &m_error_suppressions, std::nullopt, linenum);
         } else if (categories.starts_with('(') && categories.ends_with(')')) {
             categories = categories.substr(1, categories.size() - 2);
             std::set<std::string> category_set = ParseCommaSeparetedList(categories);
             for (const std::string& category : category_set) {
-                if (InErrorCategories(category)) {
-                    ProcessCategory(this, &m_error_suppressions, category, linenum);
+                size_t id = FindErrorCategory(category);
+                if (id != INDEX_NONE) {
+                    ProcessCategory(this, &m_error_suppressions, ErrorCategory(id), linenum);
                 } else if (!InOtherNolintCategories(category) &&
                            !InLegacyErrorCategories(category)) {
                     Error(linenum, "readability/nolint", 5,
@@ -324,6 +340,7 @@ std::string FileLinter::GetHeaderGuardCPPVariable() {
 }
 
 void FileLinter::CheckForHeaderGuard(const CleansedLines& clean_lines) {
+    PROFILE_SCOPE("CheckForHeaderGuard");
     // Don't check for header guards if there are error suppression
     // comments somewhere in this file.
     //
@@ -458,6 +475,7 @@ bool FileLinter::IsMacroDefinition(const CleansedLines& clean_lines,
 void FileLinter::CheckForNamespaceIndentation(const CleansedLines& clean_lines,
                                               const std::string& elided_line, size_t linenum,
                                               NestingState* nesting_state) {
+    PROFILE_SCOPE("CheckForNamespaceIndentation");
     bool is_namespace_indent_item = nesting_state->IsNamespaceIndentInfo();
     bool is_forward_declaration = IsForwardClassDeclaration(elided_line);
     if (!is_namespace_indent_item && !is_forward_declaration)
@@ -475,6 +493,7 @@ void FileLinter::CheckForNamespaceIndentation(const CleansedLines& clean_lines,
 
 void FileLinter::CheckForFunctionLengths(const CleansedLines& clean_lines, size_t linenum,
                                          FunctionState* function_state) {
+    PROFILE_SCOPE("CheckForFunctionLengths");
     const std::string& line = clean_lines.GetLineAt(linenum);
 
     bool starting_func = false;
@@ -495,27 +514,23 @@ void FileLinter::CheckForFunctionLengths(const CleansedLines& clean_lines, size_
     }
 
     if (starting_func) {
-        bool body_found = false;
-        std::string joined_line = "";
-        for (size_t start_linenum = linenum;
-                start_linenum < clean_lines.NumLines(); start_linenum++) {
-            const std::string& start_line = clean_lines.GetLineAt(start_linenum);
-            joined_line += " " + StrLstrip(start_line);
-            if (StrContain(start_line, ';') || StrContain(start_line, '}')) {
-                // Declarations and trivial functions
-                body_found = true;
-                break;
-            }
-            if (StrContain(start_line, '{')) {
-                body_found = true;
-                static const regex_code RE_PATTERN_FUNC_BRACE =
-                    RegexCompile(R"(((\w|:)*)\()");
-                bool search = RegexSearch(RE_PATTERN_FUNC_BRACE,
-                                          line, m_re_result);
-                if (!search)
-                    break;
+        // The first line that has {, } or ; is precomputed.
+        size_t body_linenum = clean_lines.FindBodyStart(linenum);
+        bool body_found = body_linenum != INDEX_NONE;
+        // Declarations and trivial functions have ; or } instead of {.
+        if (body_found &&
+                !StrContain(clean_lines.GetLineAt(body_linenum), ';') &&
+                !StrContain(clean_lines.GetLineAt(body_linenum), '}')) {
+            static const regex_code RE_PATTERN_FUNC_BRACE =
+                RegexCompile(R"(((\w|:)*)\()");
+            bool search = RegexSearch(RE_PATTERN_FUNC_BRACE,
+                                      line, m_re_result);
+            if (search) {
                 std::string function = GetMatchStr(m_re_result, line, 1);
                 if (function.starts_with("TEST")) {    // Handle TEST... macros
+                    std::string joined_line = "";
+                    for (size_t i = linenum; i <= body_linenum; i++)
+                        joined_line += " " + StrLstrip(clean_lines.GetLineAt(i));
                     search = RegexSearch(R"((\(.*\)))",
                                          joined_line, m_re_result);
                     if (search)             // Ignore bad syntax
@@ -524,7 +539,6 @@ void FileLinter::CheckForFunctionLengths(const CleansedLines& clean_lines, size_
                     function += "()";
                 }
                 function_state->Begin(function);
-                break;
             }
         }
         if (!body_found) {
@@ -542,6 +556,7 @@ void FileLinter::CheckForFunctionLengths(const CleansedLines& clean_lines, size_
 
 void FileLinter::CheckForMultilineCommentsAndStrings(const std::string& elided_line,
                                                      size_t linenum) {
+    PROFILE_SCOPE("CheckForMultilineCommentsAndStrings");
     // Checks the number of ", /*, and */
     bool escaped = false;
     char last_char = ' ';
@@ -588,25 +603,17 @@ void FileLinter::CheckForMultilineCommentsAndStrings(const std::string& elided_l
 
 static const std::string& GetPreviousNonBlankLine(const CleansedLines& clean_lines,
                                                   size_t linenum) {
-    // Return the most recent non-blank line and its line number.
+    // Return the most recent non-blank line.
     static const std::string empty("");
-    if (linenum == 0)
+    size_t prevlinenum = clean_lines.GetPrevNonBlankLine(linenum);
+    if (prevlinenum == INDEX_NONE)
         return empty;
-
-    size_t prevlinenum = linenum - 1;
-    while (true) {
-        const std::string& prevline = clean_lines.GetElidedAt(prevlinenum);
-        if (!StrIsBlank(prevline))     // if not a blank line...
-            return prevline;
-        if (prevlinenum == 0)
-            break;
-        prevlinenum--;
-    }
-    return empty;
+    return clean_lines.GetElidedAt(prevlinenum);
 }
 
 void FileLinter::CheckBraces(const CleansedLines& clean_lines,
                              const std::string& elided_line, size_t linenum) {
+    PROFILE_SCOPE("CheckBraces");
     // get rid of comments and strings
     const std::string& line = elided_line;
 
@@ -638,7 +645,7 @@ void FileLinter::CheckBraces(const CleansedLines& clean_lines,
         bool last_wrong = RegexMatch(RE_PATTERN_ELSE_AFTER_BRACE, line, m_re_result);
         if (last_wrong) {
             const std::string& prevline = GetPreviousNonBlankLine(clean_lines, linenum);
-            if (RegexMatch(R"(\s*}\s*$)", prevline)) {
+            if (MatchSpacesToEnd(prevline, MatchChar(prevline, MatchSpaces(prevline, 0), '}'))) {
                 Error(linenum, "whitespace/newline", 4,
                     "An else should appear on the same line as the preceding }");
             } else {
@@ -796,6 +803,7 @@ void FileLinter::CheckBraces(const CleansedLines& clean_lines,
 
 void FileLinter::CheckTrailingSemicolon(const CleansedLines& clean_lines,
                                         const std::string& elided_line, size_t linenum) {
+    PROFILE_SCOPE("CheckTrailingSemicolon");
     const std::string& line = elided_line;
 
     // Block bodies should not be followed by a semicolon.  Due to C++11
@@ -967,6 +975,7 @@ void FileLinter::CheckTrailingSemicolon(const CleansedLines& clean_lines,
 
 void FileLinter::CheckEmptyBlockBody(const CleansedLines& clean_lines,
                                      const std::string& elided_line, size_t linenum) {
+    PROFILE_SCOPE("CheckEmptyBlockBody");
     // Search for loop keywords at the beginning of the line.  Because only
     // whitespaces are allowed before the keywords, this will also ignore most
     // do-while-loops, since those lines should start with closing brace.
@@ -1165,12 +1174,16 @@ void FileLinter::CheckComment(const std::string& line,
     }
 }
 
-static const regex_code RE_PATTERN_CLASS_SECTION =
-    RegexCompile(R"(\s*(public|protected|private):)");
+static const regex_code& GetClassSectionPattern() {
+    static const regex_code RE_PATTERN_CLASS_SECTION =
+        RegexCompile(R"(\s*(public|protected|private):)");
+    return RE_PATTERN_CLASS_SECTION;
+}
 
 void FileLinter::CheckSpacing(const CleansedLines& clean_lines,
                               const std::string& elided_line, size_t linenum,
                               NestingState* nesting_state) {
+    PROFILE_SCOPE("CheckSpacing");
     // Don't use "elided" lines here, otherwise we can't check commented lines.
     // Don't want to use "raw" either, because we don't want to check inside C++11
     // raw strings,
@@ -1210,15 +1223,20 @@ void FileLinter::CheckSpacing(const CleansedLines& clean_lines,
             // the previous line is indented 6 spaces, which may happen when the
             // initializers of a constructor do not fit into a 80 column line.
             bool exception = false;
-            if (RegexMatch(R"( {6}\w)", prev_line)) {  // Initializer list?
+            if (MatchWordChar(prev_line, MatchChar(prev_line, 0, ' ', 6)) != INDEX_NONE) {
+                // Initializer list?
                 // We are looking for the opening column of initializer list, which
                 // should be indented 4 spaces to cause 6 space indentation afterwards.
                 size_t search_position = (linenum >= 2) ? linenum - 2 : INDEX_NONE;
                 while (search_position != INDEX_NONE &&
-                       RegexMatch(R"( {6}\w)", clean_lines.GetElidedAt(search_position))) {
+                       search_position >= clean_lines.FirstLine()) {
+                    const std::string& elided = clean_lines.GetElidedAt(search_position);
+                    if (MatchWordChar(elided, MatchChar(elided, 0, ' ', 6)) == INDEX_NONE)
+                        break;
                     search_position--;
                 }
                 exception = (search_position != INDEX_NONE &&
+                             search_position >= clean_lines.FirstLine() &&
                              clean_lines.GetElidedAt(search_position).starts_with("    :"));
             } else {
                 // Search for the function arguments or an initializer list.  We use a
@@ -1227,9 +1245,10 @@ void FileLinter::CheckSpacing(const CleansedLines& clean_lines,
                 // or colon (for initializer lists) we assume that it is the last line of
                 // a function header.  If we have a colon indented 4 spaces, it is an
                 // initializer list.
-                exception = (RegexMatch(R"( {4}\w[^\(]*\)\s*(const\s*)?(\{\s*$|:))",
-                                           prev_line) ||
-                             RegexMatch(R"( {4}:)", prev_line));
+                size_t indent_end = MatchChar(prev_line, 0, ' ', 4);
+                exception = (MatchChar(prev_line, indent_end, ':') != INDEX_NONE ||
+                             RegexMatch(R"( {4}\w[^\(]*\)\s*(const\s*)?(\{\s*$|:))",
+                                        prev_line));
             }
 
             if (!exception) {
@@ -1257,7 +1276,7 @@ void FileLinter::CheckSpacing(const CleansedLines& clean_lines,
             }
         }
 
-        bool matched = RegexMatch(RE_PATTERN_CLASS_SECTION,
+        bool matched = RegexMatch(GetClassSectionPattern(),
                                   prev_line, m_re_result);
         if (matched) {
             Error(linenum, "whitespace/blank_line", 3,
@@ -1304,6 +1323,7 @@ void FileLinter::CheckSpacing(const CleansedLines& clean_lines,
 
 void FileLinter::CheckOperatorSpacing(const CleansedLines& clean_lines,
                                       const std::string& elided_line, size_t linenum) {
+    PROFILE_SCOPE("CheckOperatorSpacing");
     const std::string& line = elided_line;
 
     // Don't try to do spacing checks for operator methods.  Do this by
@@ -1452,6 +1472,7 @@ void FileLinter::CheckOperatorSpacing(const CleansedLines& clean_lines,
 }
 
 void FileLinter::CheckParenthesisSpacing(const std::string& elided_line, size_t linenum) {
+    PROFILE_SCOPE("CheckParenthesisSpacing");
     const std::string& line = elided_line;
 
     // No spaces after an if, while, switch, or for
@@ -1492,6 +1513,7 @@ void FileLinter::CheckParenthesisSpacing(const std::string& elided_line, size_t
 
 void FileLinter::CheckCommaSpacing(const CleansedLines& clean_lines,
                                    const std::string& elided_line, size_t linenum) {
+    PROFILE_SCOPE("CheckCommaSpacing");
     const std::string& line = elided_line;
 
     // You should always have a space after a comma (either as fn arg or operator)
@@ -1539,19 +1561,6 @@ void FileLinter::CheckCommaSpacing(const CleansedLines& clean_lines,
     }
 }
 
-const regex_code RE_PATTERN_TYPES =
-    RegexCompile(
-        "^(?:"
-        // [dcl.type.simple]
-        "(char(16_t|32_t)?)|wchar_t|"
-        "bool|short|int|long|signed|unsigned|float|double|"
-        // [support.types]
-        "(ptrdiff_t|size_t|max_align_t|nullptr_t)|"
-        // [cstdint.syn]
-        "(u?int(_fast|_least)?(8|16|32|64)_t)|"
-        "(u?int(max|ptr)_t)|"
-        ")$");
-
 static bool IsType(const CleansedLines& clean_lines,
                    NestingState* nesting_state,
                    const std::string_view& expr,
@@ -1566,6 +1575,18 @@ static bool IsType(const CleansedLines& clean_lines,
         token = expr;
 
     // Match native types and stdint types
+    static const regex_code RE_PATTERN_TYPES =
+        RegexCompile(
+            "^(?:"
+            // [dcl.type.simple]
+            "(char(16_t|32_t)?)|wchar_t|"
+            "bool|short|int|long|signed|unsigned|float|double|"
+            // [support.types]
+            "(ptrdiff_t|size_t|max_align_t|nullptr_t)|"
+            // [cstdint.syn]
+            "(u?int(_fast|_least)?(8|16|32|64)_t)|"
+            "(u?int(max|ptr)_t)|"
+            ")$");
     if (RegexMatch(RE_PATTERN_TYPES, token))
         return true;
 
@@ -1591,6 +1612,8 @@ static bool IsType(const CleansedLines& clean_lines,
         size_t next_block_start = 0;
         if (block_index > 0)
             next_block_start = nesting_state->GetStackAt(block_index - 1)->StartingLinenum();
+        // Lines before the window of a stream are not available.
+        next_block_start = MAX(next_block_start, clean_lines.FirstLine());
         size_t first_line = last_line;
         while (first_line >= next_block_start && first_line != INDEX_NONE) {
             if (clean_lines.GetElidedAt(first_line).find("template") != std::string::npos)
@@ -1618,6 +1641,7 @@ static bool IsType(const CleansedLines& clean_lines,
 void FileLinter::CheckBracesSpacing(const CleansedLines& clean_lines,
                                     const std::string& elided_line, size_t linenum,
                                     NestingState* nesting_state) {
+    PROFILE_SCOPE("CheckBracesSpacing");
     const std::string& line = elided_line;
 
     // Except after an opening paren, or after another opening brace (in case of
@@ -1714,6 +1738,7 @@ void FileLinter::CheckBracesSpacing(const CleansedLines& clean_lines,
 }
 
 void FileLinter::CheckSpacingForFunctionCall(const std::string& elided_line, size_t linenum) {
+    PROFILE_SCOPE("CheckSpacingForFunctionCall");
     const std::string& line = elided_line;
 
     // Since function calls often occur inside if/for/while/switch
@@ -1743,6 +1768,21 @@ void FileLinter::CheckSpacingForFunctionCall(const std::string& elided_line, siz
     CheckSpacingForFunctionCallBase(line, line, linenum);
 }
 
+// RegexSearch(R"(\boperator_*\b)", line)
+static bool HasOperatorKeyword(const std::string& line) {
+    for (size_t pos = line.find("operator"); pos != std::string::npos;
+         pos = line.find("operator", pos + 1)) {
+        if (!IsWordBoundary(line, pos))
+            continue;
+        size_t end = pos + 8;
+        while (end < line.size() && line[end] == '_')
+            end++;
+        if (IsWordBoundary(line, end))
+            return true;
+    }
+    return false;
+}
+
 void FileLinter::CheckSpacingForFunctionCallBase(const std::string& line,
                                                  const std::string& fncall, size_t linenum) {
     // Except in if/for/while/switch, there should never be space
@@ -1802,7 +1842,7 @@ void FileLinter::CheckSpacingForFunctionCallBase(const std::string& line,
         !RegexSearch(RE_PATTERN_CASE, fncall)) {
         // TODO(unknown): Space after an operator function seem to be a common
         // error, silence those for now by restricting them to highest verbosity.
-        if (RegexSearch(R"(\boperator_*\b)", line)) {
+        if (HasOperatorKeyword(line)) {
             Error(linenum, "whitespace/parens", 0,
                   "Extra space before ( in function call");
         } else {
@@ -1867,8 +1907,6 @@ macro_map_t InitializeMacroMap() {
     return macros;
 }
 
-macro_map_t CHECK_REPLACEMENT = InitializeMacroMap();
-
 static const std::string& FindCheckMacro(const std::string& line, size_t* start_pos,
                                   regex_match& re_result) {
     // Find a replaceable CHECK-like macro.
@@ -1894,6 +1932,7 @@ static const std::string& FindCheckMacro(const std::string& line, size_t* start_
 
 void FileLinter::CheckCheck(const CleansedLines& clean_lines,
                             const std::string& elided_line, size_t linenum) {
+    PROFILE_SCOPE("CheckCheck");
     // Decide the set of replacement macros that should be suggested
     size_t start_pos;
     const std::string& check_macro = FindCheckMacro(elided_line, &start_pos, m_re_result);
@@ -2010,6 +2049,7 @@ void FileLinter::CheckCheck(const CleansedLines& clean_lines,
         //
         // We are still keeping the less descriptive message because if lhs
         // or rhs gets long, the error message might become unreadable.
+        static macro_map_t CHECK_REPLACEMENT = InitializeMacroMap();
         Error(linenum, "readability/check", 2,
               "Consider using " + CHECK_REPLACEMENT[check_macro][op] +
               " instead of " + check_macro + "(a " + op + " b)");
@@ -2017,6 +2057,7 @@ void FileLinter::CheckCheck(const CleansedLines& clean_lines,
 }
 
 void FileLinter::CheckAltTokens(const std::string& elided_line, size_t linenum) {
+    PROFILE_SCOPE("CheckAltTokens");
     const std::string& line = elided_line;
     // Avoid preprocessor lines
     if (GetFirstNonSpace(line) == '#')
@@ -2062,6 +2103,7 @@ void FileLinter::CheckAltTokens(const std::string& elided_line, size_t linenum)
 
 void FileLinter::CheckSectionSpacing(const CleansedLines& clean_lines,
                                      ClassInfo* classinfo, size_t linenum) {
+    PROFILE_SCOPE("CheckSectionSpacing");
     // Skip checks if the class is small, where small means 25 lines or less.
     // 25 lines seems like a good cutoff since that's the usual height of
     // terminals, and any class that can't fit in one screen can't really
@@ -2078,7 +2120,7 @@ void FileLinter::CheckSectionSpacing(const CleansedLines& clean_lines,
         return;
 
     const std::string& line = clean_lines.GetLineAt(linenum);
-    bool matched = RegexMatch(RE_PATTERN_CLASS_SECTION,
+    bool matched = RegexMatch(GetClassSectionPattern(),
                               line, m_re_result);
     if (!matched)
         return;
@@ -2100,7 +2142,8 @@ void FileLinter::CheckSectionSpacing(const CleansedLines& clean_lines,
         //   class Derived
         //       : public Base {
         size_t end_class_head = classinfo->StartingLinenum();
-        for (size_t i = end_class_head; i < linenum; i++) {
+        size_t first_line = MAX(end_class_head, clean_lines.FirstLine());
+        for (size_t i = first_line; i < linenum; i++) {
             if (GetLastNonSpace(clean_lines.GetLineAt(i)) == '}') {
                 end_class_head = i;
                 break;
@@ -2114,10 +2157,43 @@ void FileLinter::CheckSectionSpacing(const CleansedLines& clean_lines,
     }
 }
 
+// RegexSearch(R"([",=><] *$)", line)
+static bool IsContinuationLine(const std::string& line) {
+    size_t last = line.find_last_not_of(' ');
+    return last != std::string::npos &&
+           std::string_view(R"(",=><)").find(line[last]) != std::string_view::npos;
+}
+
+// RegexMatch(R"(^\s*//.*http(s?)://\S*$)", line) ||
+// RegexMatch(R"(^\s*//\s*[^\s]*$)", line)
+static bool IsLongCommentAllowed(const std::string& line) {
+    size_t comment_start = MatchStr(line, MatchSpaces(line, 0), "//");
+    if (comment_start == INDEX_NONE)
+        return false;
+
+    // Find the last part of the comment that has no spaces.
+    size_t word_start = comment_start;
+    for (size_t i = comment_start; i < line.size(); i++) {
+        if (IsSpaceChar(line[i]))
+            word_start = i + 1;
+    }
+    if (MatchSpaces(line, comment_start) == word_start)
+        return true;
+
+    for (size_t pos = line.find("http", word_start); pos != std::string::npos;
+         pos = line.find("http", pos + 1)) {
+        if (MatchStr(line, pos, "http://") != INDEX_NONE ||
+            MatchStr(line, pos, "https://") != INDEX_NONE)
+            return true;
+    }
+    return false;
+}
+
 void FileLinter::CheckStyle(const CleansedLines& clean_lines,
                             const std::string& elided_line,
                             size_t linenum,
                             bool is_header_extension) {
+    PROFILE_SCOPE("CheckStyle");
     // Don't use "elided" lines here, otherwise we can't check commented lines.
     // Don't want to use "raw" either, because we don't want to check inside C++11
     // raw strings,
@@ -2149,17 +2225,14 @@ void FileLinter::CheckStyle(const CleansedLines& clean_lines,
     // We also don't check for lines that look like continuation lines
     // (of lines ending in double quotes, commas, equals, or angle brackets)
     // because the rules for how to indent those are non-trivial.
-    static const regex_code RE_PATTERN_SPACES =
-        RegexCompile(R"([",=><] *$)");
     static const regex_code RE_PATTERN_SCOPE_OR_LABEL =
         RegexCompile(R"(\s*(?:public|private|protected|signals)(?:\s+(?:slots\s*)?)?:\s*\\?$)");
-    if (!(linenum > 0 &&
-          RegexSearch(RE_PATTERN_SPACES,
-                      clean_lines.GetLineWithoutRawStringAt(linenum - 1))) &&
-        (initial_spaces == 1 || initial_spaces == 3) &&
+    if ((initial_spaces == 1 || initial_spaces == 3) &&
+        !(linenum > 0 &&
+          IsContinuationLine(clean_lines.GetLineWithoutRawStringAt(linenum - 1))) &&
         !RegexMatch(RE_PATTERN_SCOPE_OR_LABEL, cleansed_line) &&
         !(clean_lines.GetRawLineAt(linenum) != line &&
-          RegexMatch(R"(^\s*"")", line))) {
+          MatchStr(line, MatchSpaces(line, 0), R"("")") != INDEX_NONE)) {
         Error(linenum, "whitespace/indent", 3,
               "Weird number of spaces at line-start.  "
               "Are you using a 2-space indent?");
@@ -2191,25 +2264,19 @@ void FileLinter::CheckStyle(const CleansedLines& clean_lines,
     //
     // Doxygen documentation copying can get pretty long when using an overloaded
     // function declaration
-    static const regex_code RE_PATTERN_URL =
-        RegexCompile(R"(^\s*//.*http(s?)://\S*$)");
-    static const regex_code RE_PATTERN_COMMENT =
-        RegexCompile(R"(^\s*//\s*[^\s]*$)");
     static const regex_code RE_PATTERN_ID =
         RegexCompile(R"(^// \$Id:.*#[0-9]+ \$$)");
     static const regex_code RE_PATTERN_DOC =
         RegexCompile(R"(^\s*/// [@\\](copydoc|copydetails|copybrief) .*$)");
-    if (!line.starts_with("#include") && !is_header_guard &&
-        !RegexMatch(RE_PATTERN_URL, line) &&
-        !RegexMatch(RE_PATTERN_COMMENT, line) &&
+    size_t line_length = m_options.LineLength();
+    // Check the width first since most lines are short enough.
+    if (GetLineWidth(line) > line_length &&
+        !line.starts_with("#include") && !is_header_guard &&
+        !IsLongCommentAllowed(line) &&
         !RegexMatch(RE_PATTERN_ID, line) &&
         !RegexMatch(RE_PATTERN_DOC, line)) {
-        size_t line_width = GetLineWidth(line);
-        size_t line_length = m_options.LineLength();
-        if (line_width > line_length) {
-            Error(linenum, "whitespace/line_length", 2,
-                  "Lines should be <= " + std::to_string(line_length) + " characters long");
-        }
+        Error(linenum, "whitespace/line_length", 2,
+              "Lines should be <= " + std::to_string(line_length) + " characters long");
     }
 
     static const regex_code RE_PATTERN_LAMBDA =
@@ -2248,6 +2315,7 @@ void FileLinter::CheckStyleWithState(
                             const std::string& elided_line,
                             size_t linenum,
                             NestingState* nesting_state) {
+    PROFILE_SCOPE("CheckStyleWithState");
     CheckSpacing(clean_lines, elided_line, linenum, nesting_state);
     CheckBracesSpacing(clean_lines, elided_line, linenum, nesting_state);
 
@@ -2290,13 +2358,13 @@ int FileLinter::ClassifyInclude(const fs::path& path_from_repo,
     std::string include_str = include.string();
     // This is a list of all standard c++ header files, except
     // those already checked for above.
-    bool is_cpp_header = InStrVec(CPP_HEADERS, include_str);
+    bool is_cpp_header = CPP_HEADER_SET.Contains(include_str);
 
     // Mark include as C header if in list or in a known folder for standard-ish C headers.
     bool is_std_c_header = (include_order == INCLUDE_ORDER_DEFAULT) ||
-                            (InStrVec(C_HEADERS, include_str) ||
+                            (C_HEADER_SET.Contains(include_str) ||
                             // additional linux glibc header folders
-                            RegexSearch(GetHeaderFoldersPattern(), include_str));
+                            InHeaderFolders(include_str));
 
     // Headers with C++ extensions shouldn't be considered C system headers
     std::string include_ext = include.extension().string();
@@ -2348,6 +2416,7 @@ int FileLinter::ClassifyInclude(const fs::path& path_from_repo,
 
 void FileLinter::CheckIncludeLine(const CleansedLines& clean_lines, size_t linenum,
                                   IncludeState* include_state) {
+    PROFILE_SCOPE("CheckIncludeLine");
     const std::string& line = clean_lines.GetLineAt(linenum);
 
     // "include" should use the new style "foo/bar.h" instead of just "bar.h"
@@ -2374,7 +2443,7 @@ void FileLinter::CheckIncludeLine(const CleansedLines& clean_lines, size_t linen
     // we shouldn't include a file more than once. actually, there are a
     // handful of instances where doing so is okay, but in general it's
     // not.
-    match = RegexSearch(RE_PATTERN_INCLUDE, line, m_re_result);
+    match = RegexSearch(GetIncludePattern(), line, m_re_result);
     if (match) {
         std::string include = GetMatchStr(m_re_result, line, 2);
         bool used_angle_brackets = StrIsChar(GetMatchStrView(m_re_result, line, 1), '<');
@@ -2512,18 +2581,40 @@ bool FileLinter::CheckCStyleCast(const CleansedLines& clean_lines,
 
 void FileLinter::CheckCasts(const CleansedLines& clean_lines,
                             const std::string& elided_line, size_t linenum) {
+    PROFILE_SCOPE("CheckCasts");
     const std::string& line = elided_line;
 
+    // Search the patterns of cast checks in one pass.
+    // Most lines match none of them.
+    // The pattern of reinterpret_cast is not in the set. It runs only when
+    // the const_cast check doesn't report the line.
+    enum : size_t {
+        CAST_FUNCTION,
+        CAST_STATIC,
+        CAST_CONST,
+        CAST_ADDRESS,
+    };
+    static const RegexSet RE_SET_CASTS({
+        R"((\bnew\s+(?:const\s+)?|\S<\s*(?:const\s+)?)?\b)"
+        R"((int|float|double|bool|char|int16_t|uint16_t|int32_t|uint32_t|int64_t|uint64_t))"
+        R"((\([^)].*))",
+        R"(\((int|float|double|bool|char|u?int(16|32|64)_t|size_t)\))",
+        R"(\((char\s?\*+\s?)\)\s*")",
+        R"((?:[^\w]&\(([^)*][^)]*)\)[\w(])|)"
+        R"((?:[^\w]&(static|dynamic|down|reinterpret)_cast\b))",
+    });
+    uint64_t hits = RE_SET_CASTS.Search(line);
+
     // Check to see if they're using an conversion function cast.
     // I just try to capture the most common basic types, though there are more.
     // Parameterless conversion functions, such as bool(), are allowed as they are
     // probably a member operator declaration or default constructor.
-    static const regex_code RE_PATTERN_CAST =
-        RegexJitCompile(R"((\bnew\s+(?:const\s+)?|\S<\s*(?:const\s+)?)?\b)"
-                        R"((int|float|double|bool|char|int16_t|uint16_t|int32_t|uint32_t|int64_t|uint64_t))"
-                        R"((\([^)].*))");
-    bool match = RegexJitSearch(RE_PATTERN_CAST, line, m_re_result);
-    bool expecting_function = ExpectingFunctionArgs(clean_lines, elided_line, linenum);
+    bool match = RegexSet::Matched(hits, CAST_FUNCTION) &&
+                 RegexSearch(RE_SET_CASTS.Get(CAST_FUNCTION), line, m_re_result);
+    // ExpectingFunctionArgs runs several regexes. Only the first two checks use it.
+    bool expecting_function =
+        (RegexSet::Matched(hits, CAST_FUNCTION) || RegexSet::Matched(hits, CAST_STATIC)) &&
+        ExpectingFunctionArgs(clean_lines, elided_line, linenum);
     if (match && !expecting_function) {
         std::string matched_funcptr = GetMatchStr(m_re_result, line, 3);
 
@@ -2566,27 +2657,24 @@ void FileLinter::CheckCasts(const CleansedLines& clean_lines,
         }
     }
 
-    if (!expecting_function) {
-        static const regex_code RE_PATTERN_STATIC_CAST =
-            RegexCompile(R"(\((int|float|double|bool|char|u?int(16|32|64)_t|size_t)\))");
+    if (!expecting_function && RegexSet::Matched(hits, CAST_STATIC)) {
         CheckCStyleCast(clean_lines,
                         elided_line, linenum, "static_cast",
-                        RE_PATTERN_STATIC_CAST);
+                        RE_SET_CASTS.Get(CAST_STATIC));
     }
 
     // This doesn't catch all cases. Consider (const char * const)"hello".
     //
     // (char *) "foo" should always be a const_cast (reinterpret_cast won't
     // compile).
-    static const regex_code RE_PATTERN_CONST_CAST =
-        RegexCompile(R"(\((char\s?\*+\s?)\)\s*")");
-    if (CheckCStyleCast(clean_lines,
+    if (RegexSet::Matched(hits, CAST_CONST) &&
+        CheckCStyleCast(clean_lines,
                         elided_line, linenum, "const_cast",
-                        RE_PATTERN_CONST_CAST)) {
+                        RE_SET_CASTS.Get(CAST_CONST))) {
     } else {
         // Check pointer casts for other than string constants
         static const regex_code RE_PATTERN_REINTERPRET_CAST =
-            RegexCompile(R"(\((\w+\s?\*+\s?)\))");
+            RegexJitCompile(R"(\((\w+\s?\*+\s?)\))");
         CheckCStyleCast(clean_lines,
                         elided_line, linenum, "reinterpret_cast",
                         RE_PATTERN_REINTERPRET_CAST);
@@ -2603,11 +2691,7 @@ void FileLinter::CheckCasts(const CleansedLines& clean_lines,
     //
     // This is not a cast:
     //   reference_type&(int* function_param);
-    static const regex_code RE_PATTERN_CAST_TYPE =
-        RegexJitCompile(R"((?:[^\w]&\(([^)*][^)]*)\)[\w(])|)"
-                        R"((?:[^\w]&(static|dynamic|down|reinterpret)_cast\b))");
-    match = RegexJitSearch(RE_PATTERN_CAST_TYPE, line);
-    if (match) {
+    if (RegexSet::Matched(hits, CAST_ADDRESS)) {
         // Try a better error message when the & is bound to something
         // dereferenced by the casted pointer, as opposed to the casted
         // pointer itself.
@@ -2648,6 +2732,7 @@ void FileLinter::CheckCasts(const CleansedLines& clean_lines,
 }
 
 void FileLinter::CheckGlobalStatic(const std::string& elided_line, size_t linenum) {
+    PROFILE_SCOPE("CheckGlobalStatic");
     const std::string& line = elided_line;
 
     // Check for people declaring static/global STL strings at the top level.
@@ -2683,7 +2768,7 @@ void FileLinter::CheckGlobalStatic(const std::string& elided_line, size_t linenu
         !RegexSearch(R"(\boperator\W)", line) &&
         !RegexMatch(R"(\s*(<.*>)?(::[a-zA-Z0-9_]+)*\s*\(([^"]|$))",
                     GetMatchStr(m_re_result, line, 4))) {
-        if (RegexSearch(R"(\bconst\b)", line)) {
+        if (FindWord(line, "const") != INDEX_NONE) {
             Error(linenum, "runtime/string", 4,
                   "For a static/global string constant, use a C style string instead:"
                   " \"" + GetMatchStr(m_re_result, line, 1) + "char" +
@@ -2704,6 +2789,7 @@ void FileLinter::CheckGlobalStatic(const std::string& elided_line, size_t linenu
 }
 
 void FileLinter::CheckPrintf(const std::string& elided_line, size_t linenum) {
+    PROFILE_SCOPE("CheckPrintf");
     const std::string& line = elided_line;
     bool match;
 
@@ -2810,13 +2896,14 @@ void FileLinter::CheckLanguage(const CleansedLines& clean_lines,
                                const std::string& elided_line, size_t linenum,
                                bool is_header_extension,
                                IncludeState* include_state) {
+    PROFILE_SCOPE("CheckLanguage");
     // If the line is empty or consists of entirely a comment, no need to
     // check it.
     const std::string& line = elided_line;
     if (line.empty())
         return;
 
-    bool match = RegexSearch(RE_PATTERN_INCLUDE, line);
+    bool match = RegexSearch(GetIncludePattern(), line);
     if (match) {
         CheckIncludeLine(clean_lines, linenum, include_state);
         return;
@@ -2854,19 +2941,41 @@ void FileLinter::CheckLanguage(const CleansedLines& clean_lines,
         //                (level 1 error)
     }
 
+    // Search the patterns of the following checks in one pass.
+    // Most lines match none of them.
+    // Patterns of runtime/int and build/namespaces_headers are not in the set.
+    // They run only after their preconditions are met.
+    enum : size_t {
+        LANGUAGE_SHORT_PORT,
+        LANGUAGE_UNARY_OP,
+        LANGUAGE_IF_AFTER_BRACE,
+        LANGUAGE_PRINTF,
+        LANGUAGE_MEMSET,
+        LANGUAGE_NAMESPACE_USING,
+        LANGUAGE_VARIABLE_LENGTH_ARRAY,
+    };
+    static const RegexSet RE_SET_LANGUAGE({
+        R"(\bshort port\b)",
+        R"(\boperator\s*&\s*\(\s*\))",
+        R"(\}\s*if\s*\()",
+        "(?i)printf",
+        R"(memset\s*\(([^,]*),\s*([^,]*),\s*0\s*\))",
+        R"(\busing namespace\b)",
+        R"(^\s*(.+::)?(\w+) [a-z]\w*\[(.+)];)",
+    });
+    uint64_t hits = RE_SET_LANGUAGE.Search(line);
+
     // Check if people are using the verboten C basic types.  The only exception
     // we regularly allow is "unsigned short port" for port.
-    static const regex_code RE_PATTERN_SHORT_PORT =
-        RegexCompile(R"(\bshort port\b)");
-    if (RegexSearch(RE_PATTERN_SHORT_PORT, line)) {
+    if (RegexSet::Matched(hits, LANGUAGE_SHORT_PORT)) {
         if (!RegexSearch(R"(\bunsigned short port\b)", line)) {
             Error(linenum, "runtime/int", 4,
                   "Use \"unsigned short\" for ports, not \"short\"");
         }
     } else {
         static const regex_code RE_PATTERN_CINT =
-            RegexCompile(R"(\b(short|long(?! +double)|long long)\b)");
-        match = RegexSearch(RE_PATTERN_CINT, line, m_re_result);
+            RegexJitCompile(R"(\b(short|long(?! +double)|long long)\b)");
+        match = RegexJitSearch(RE_PATTERN_CINT, line, m_re_result);
         if (match) {
             Error(linenum, "runtime/int", 4,
                   "Use int16_t/int64_t/etc, rather than the C type " +
@@ -2880,18 +2989,14 @@ void FileLinter::CheckLanguage(const CleansedLines& clean_lines,
     //   int operator&(const X& x) { return 42; }  // unary operator&
     // The trick is it's hard to tell apart from binary operator&:
     //   class Y { int operator&(const Y& x) { return 23; } }; // binary operator&
-    static const regex_code RE_PATTERN_UNARY_OP =
-        RegexCompile(R"(\boperator\s*&\s*\(\s*\))");
-    if (RegexSearch(RE_PATTERN_UNARY_OP, line)) {
+    if (RegexSet::Matched(hits, LANGUAGE_UNARY_OP)) {
         Error(linenum, "runtime/operator", 4,
               "Unary operator& is dangerous.  Do not use it.");
     }
 
     // Check for suspicious usage of "if" like
     // } if (a == b) {
-    static const regex_code RE_PATTERN_IF_AFTER_BRACE =
-        RegexCompile(R"(\}\s*if\s*\()");
-    if (RegexSearch(RE_PATTERN_IF_AFTER_BRACE, line)) {
+    if (RegexSet::Matched(hits, LANGUAGE_IF_AFTER_BRACE)) {
         Error(linenum, "readability/braces", 4,
               "Did you mean \"else if\"? If not, start a new line for \"if\".");
     }
@@ -2903,9 +3008,7 @@ void FileLinter::CheckLanguage(const CleansedLines& clean_lines,
     // convention of the whole function to process multiple line to handle it.
     //   printf(
     //       boy_this_is_a_really_long_variable_that_cannot_fit_on_the_prev_line);
-    static const regex_code RE_PATTERN_PRINTF_ICASE =
-        RegexCompile("printf", REGEX_OPTIONS_ICASE | REGEX_OPTIONS_MULTILINE);
-    if (RegexSearch(RE_PATTERN_PRINTF_ICASE, line)) {
+    if (RegexSet::Matched(hits, LANGUAGE_PRINTF)) {
         static const regex_code RE_PATTERN_PRINTF_ARGS =
             RegexCompile(R"(\b(string)?printf\s*\()", REGEX_OPTIONS_ICASE | REGEX_OPTIONS_MULTILINE);
         std::string printf_args = GetTextInside(line, RE_PATTERN_PRINTF_ARGS, m_re_result);
@@ -2925,9 +3028,8 @@ void FileLinter::CheckLanguage(const CleansedLines& clean_lines,
     }
 
     // Check for potential memset bugs like memset(buf, sizeof(buf), 0).
-    static const regex_code RE_PATTERN_MEMSET =
-        RegexCompile(R"(memset\s*\(([^,]*),\s*([^,]*),\s*0\s*\))");
-    match = RegexSearch(RE_PATTERN_MEMSET, line, m_re_result);
+    match = RegexSet::Matched(hits, LANGUAGE_MEMSET) &&
+            RegexSearch(RE_SET_LANGUAGE.Get(LANGUAGE_MEMSET), line, m_re_result);
     if (match && !RegexMatch(R"(^''|-?[0-9]+|0x[0-9A-Fa-f]$)",
                              GetMatchStr(m_re_result, line, 2))) {
         Error(linenum, "runtime/memset", 4,
@@ -2935,10 +3037,8 @@ void FileLinter::CheckLanguage(const CleansedLines& clean_lines,
               ", 0, " + GetMatchStr(m_re_result, line, 2) + ")\"?");
     }
 
-    static const regex_code RE_PATTERN_NAMESPACE_USING =
-        RegexCompile(R"(\busing namespace\b)");
-    if (RegexSearch(RE_PATTERN_NAMESPACE_USING, line)) {
-        if (RegexSearch(R"(\bliterals\b)", line)) {
+    if (RegexSet::Matched(hits, LANGUAGE_NAMESPACE_USING)) {
+        if (FindWord(line, "literals") != INDEX_NONE) {
             Error(linenum, "build/namespaces_literals", 5,
                   "Do not use namespace using-directives.  "
                   "Use using-declarations instead.");
@@ -2950,9 +3050,9 @@ void FileLinter::CheckLanguage(const CleansedLines& clean_lines,
     }
 
     // Detect variable-length arrays.
-    static const regex_code RE_PATTERN_VARIABLE_LENGTH_ARRAY =
-        RegexJitCompile(R"(^\s*(.+::)?(\w+) [a-z]\w*\[(.+)];)");
-    match = RegexJitSearch(RE_PATTERN_VARIABLE_LENGTH_ARRAY, line, m_re_result);
+    match = RegexSet::Matched(hits, LANGUAGE_VARIABLE_LENGTH_ARRAY) &&
+            RegexSearch(RE_SET_LANGUAGE.Get(LANGUAGE_VARIABLE_LENGTH_ARRAY),
+                        line, m_re_result);
 
     if (match) {
         std::string_view str2 = GetMatchStrView(m_re_result, line, 2);
@@ -3018,97 +3118,110 @@ void FileLinter::CheckLanguage(const CleansedLines& clean_lines,
     }
 }
 
-static const regex_code RE_PATTERN_FUNC_START =
-    RegexCompile(R"(^([^()]*\w+)\()");
-static const regex_code RE_PATTERN_OVERRIDE =
-    RegexCompile(R"(\boverride\b)");
+static const regex_code& GetFuncStartPattern() {
+    static const regex_code RE_PATTERN_FUNC_START =
+        RegexCompile(R"(^([^()]*\w+)\()");
+    return RE_PATTERN_FUNC_START;
+}
 
-// Check if current line contains an inherited function.
-static bool IsDerivedFunction(const CleansedLines& clean_lines, size_t linenum,
-                              regex_match& re_result) {
-    // Scan back a few lines for start of current function
-    size_t min_line = (linenum >= 10) ? linenum - 10 : 0;
-    for (size_t i = linenum;; i--) {
-        const std::string& line = clean_lines.GetElidedAt(i);
-        bool match = RegexMatch(RE_PATTERN_FUNC_START, line, re_result);
-        if (match) {
-            // Look for "override" after the matching closing parenthesis
-            size_t closing_paren = GetMatchSize(re_result, 1);
-            size_t pos = i;
-            const std::string& close_line = CloseExpression(
-                                        clean_lines, &pos, &closing_paren);
-            return (closing_paren != INDEX_NONE &&
-                    RegexSearchWithRange(RE_PATTERN_OVERRIDE,
-                                         close_line, closing_paren,
-                                         close_line.size() - closing_paren));
-        }
-        if (i == min_line) break;
-    }
-    return false;
+static const regex_code& GetOverridePattern() {
+    static const regex_code RE_PATTERN_OVERRIDE =
+        RegexCompile(R"(\boverride\b)");
+    return RE_PATTERN_OVERRIDE;
 }
 
-// Check if current line contains an out-of-line method definition.
-static bool IsOutOfLineMethodDefinition(const CleansedLines& clean_lines, size_t linenum) {
-    // Scan back a few lines for start of current function
+// Scans back a few lines for start of current function.
+// Returns the line number or INDEX_NONE.
+static size_t FindFunctionStart(const CleansedLines& clean_lines, size_t linenum,
+                                regex_match& re_result) {
     size_t min_line = (linenum >= 10) ? linenum - 10 : 0;
     for (size_t i = linenum;; i--) {
-        const std::string& line = clean_lines.GetElidedAt(i);
-        if (RegexMatch(RE_PATTERN_FUNC_START, line)) {
-            static const regex_code RE_PATTERN_OUT_OF_LINE =
-                RegexCompile(R"(^[^()]*\w+::\w+\()");
-            return RegexMatch(RE_PATTERN_OUT_OF_LINE, line);
-        }
+        if (RegexMatch(GetFuncStartPattern(), clean_lines.GetElidedAt(i), re_result))
+            return i;
         if (i == min_line) break;
     }
-    return false;
+    return INDEX_NONE;
 }
 
-// Check if current line is inside constructor initializer list.
-static bool IsInitializerList(const CleansedLines& clean_lines, size_t linenum,
+// Check if a function that starts at func_start is an inherited function.
+// re_result should be the result of FindFunctionStart().
+static bool IsDerivedFunction(const CleansedLines& clean_lines, size_t func_start,
                               regex_match& re_result) {
-    for (size_t i = linenum; i > 1; i--) {
-        std::string line = clean_lines.GetElidedAt(i);
-
-        if (i == linenum) {
-            static const regex_code RE_PATTERN_LIST_PARENS =
-                RegexCompile(R"(^(.*)\{\s*$)");
-            bool remove_function_body = RegexMatch(RE_PATTERN_LIST_PARENS, line, re_result);
-            if (remove_function_body)
-                line = GetMatchStr(re_result, line, 1);
-        }
-        static const regex_code RE_PATTERN_COLON =
-            RegexCompile(R"(\s:\s*\w+[({])");
-        if (RegexSearch(RE_PATTERN_COLON, line, re_result)) {
-            // A lone colon tend to indicate the start of a constructor
-            // initializer list.  It could also be a ternary operator, which
-            // also tend to appear in constructor initializer lists as
-            // opposed to parameter lists.
-            return true;
-        }
-        static const regex_code RE_PATTERN_CLOSING_BRACE =
-            RegexCompile(R"(\}\s*,\s*$)");
-        if (RegexSearch(RE_PATTERN_CLOSING_BRACE, line, re_result)) {
-            // A closing brace followed by a comma is probably the end of a
-            // brace-initialized member in constructor initializer list.
-            return true;
-        }
+    // Look for "override" after the matching closing parenthesis
+    size_t closing_paren = GetMatchSize(re_result, 1);
+    size_t pos = func_start;
+    const std::string& close_line = CloseExpression(
+                                clean_lines, &pos, &closing_paren);
+    return (closing_paren != INDEX_NONE &&
+            RegexSearchWithRange(GetOverridePattern(),
+                                 close_line, closing_paren,
+                                 close_line.size() - closing_paren));
+}
 
-        char c = GetLastNonSpace(line);
-        if (c == '{' || c == '}' || c == ';') {
-            // Found one of the following:
-            // - A closing brace or semicolon, probably the end of the previous
-            //   function.
-            // - An opening brace, probably the start of current class or namespace.
-            //
-            // Current line is probably not inside an initializer list since
-            // we saw one of those things without seeing the starting colon.
-            return false;
-        }
+// Check if a function that starts at func_start is an out-of-line method definition.
+static bool IsOutOfLineMethodDefinition(const CleansedLines& clean_lines, size_t func_start) {
+    static const regex_code RE_PATTERN_OUT_OF_LINE =
+        RegexCompile(R"(^[^()]*\w+::\w+\()");
+    return RegexMatch(RE_PATTERN_OUT_OF_LINE, clean_lines.GetElidedAt(func_start));
+}
+
+// Check if a line looks like the start of constructor initializer list.
+static bool IsInitializerListStart(const std::string& line, regex_match& re_result) {
+    static const regex_code RE_PATTERN_COLON =
+        RegexCompile(R"(\s:\s*\w+[({])");
+    if (RegexSearch(RE_PATTERN_COLON, line, re_result)) {
+        // A lone colon tend to indicate the start of a constructor
+        // initializer list.  It could also be a ternary operator, which
+        // also tend to appear in constructor initializer lists as
+        // opposed to parameter lists.
+        return true;
     }
+    static const regex_code RE_PATTERN_CLOSING_BRACE =
+        RegexCompile(R"(\}\s*,\s*$)");
+    // A closing brace followed by a comma is probably the end of a
+    // brace-initialized member in constructor initializer list.
+    return RegexSearch(RE_PATTERN_CLOSING_BRACE, line, re_result);
+}
 
-    // Got to the beginning of the file without seeing the start of
-    // constructor initializer list.
-    return false;
+bool FileLinter::IsInitializerList(const CleansedLines& clean_lines, size_t linenum) {
+    if (linenum <= 1)
+        return false;
+
+    std::string line = clean_lines.GetElidedAt(linenum);
+    static const regex_code RE_PATTERN_LIST_PARENS =
+        RegexCompile(R"(^(.*)\{\s*$)");
+    bool remove_function_body = RegexMatch(RE_PATTERN_LIST_PARENS, line, m_re_result);
+    if (remove_function_body)
+        line = GetMatchStr(m_re_result, line, 1);
+    if (IsInitializerListStart(line, m_re_result))
+        return true;
+    char c = GetLastNonSpace(line);
+    if (c == '{' || c == '}' || c == ';')
+        return false;
+
+    // Scan back to the previous line that ends with a closing brace or semicolon
+    // (the end of the previous function), or an opening brace (the start of
+    // current class or namespace).  Current line is probably not inside an
+    // initializer list if we saw one of those things without seeing the
+    // starting colon.
+    //
+    // Lines of a statement are scanned only once.  The results are kept
+    // for the following lines, or long initializer lists would be quadratic.
+    size_t statement_end = clean_lines.GetPrevStatementEnd(linenum);
+    size_t first_line = (statement_end == INDEX_NONE || statement_end < 2) ? 2 : statement_end;
+    first_line = MAX(first_line, clean_lines.FirstLine());
+    if (m_init_list_statement_end != statement_end ||
+            m_init_list_scanned == INDEX_NONE || m_init_list_scanned >= linenum) {
+        m_init_list_statement_end = statement_end;
+        m_init_list_scanned = first_line - 1;
+        m_init_list_found = false;
+    }
+    size_t scan_start = MAX(m_init_list_scanned + 1, clean_lines.FirstLine());
+    for (size_t i = scan_start; i < linenum && !m_init_list_found; i++) {
+        m_init_list_found = IsInitializerListStart(clean_lines.GetElidedAt(i), m_re_result);
+        m_init_list_scanned = i;
+    }
+    return m_init_list_found;
 }
 
 // Patterns for matching call-by-reference parameters.
@@ -3127,30 +3240,10 @@ static bool IsInitializerList(const CleansedLines& clean_lines, size_t linenum,
         R"(\s*<(?:<(?:<[^<>]*>|[^<>])*>|[^<>])*>|)" \
         R"(::)+)"
 
-// A call-by-reference parameter ends with '& identifier'.
-const regex_code RE_REF_PARAM = RegexJitCompile(
-        "(" RE_PATTERN_TYPE R"((?:\s*(?:\bconst\b|[*]))*\s*)"
-        R"(&\s*)" RE_PATTERN_IDENT R"()\s*(?:=[^,()]+)?[,)])");
-// A call-by-const-reference parameter either ends with 'const& identifier'
-// or looks like 'const type& identifier' when 'type' is atomic.
-const regex_code RE_CONST_REF_PARAM = RegexCompile(
-        R"((?:.*\s*\bconst\s*&\s*)" RE_PATTERN_IDENT
-        R"(|const\s+)" RE_PATTERN_TYPE R"(\s*&\s*)" RE_PATTERN_IDENT ")");
-
-// Stream types.
-const regex_code RE_REF_STREAM_PARAM = RegexCompile(
-        R"((?:.*stream\s*&\s*)" RE_PATTERN_IDENT ")");
-
-const regex_code RE_PATTERN_ALLOWED_FUNCTIONS =
-    RegexCompile(
-        R"((?:[sS]wap(?:<\w:+>)?|)"
-        R"(operator\s*[<>][<>]|)"
-        R"(static_assert|COMPILE_ASSERT)"
-        R"()\s*\()");
-
 void FileLinter::CheckForNonConstReference(const CleansedLines& clean_lines,
                                            const std::string& elided_line, size_t linenum,
                                            NestingState* nesting_state) {
+    PROFILE_SCOPE("CheckForNonConstReference");
     // Do nothing if there is no '&' on current line.
     if (!StrContain(elided_line, '&'))
         return;
@@ -3158,12 +3251,15 @@ void FileLinter::CheckForNonConstReference(const CleansedLines& clean_lines,
     // If a function is inherited, current function doesn't have much of
     // a choice, so any non-const references should not be blamed on
     // derived function.
-    if (IsDerivedFunction(clean_lines, linenum, m_re_result))
+    size_t func_start = FindFunctionStart(clean_lines, linenum, m_re_result);
+    if (func_start != INDEX_NONE &&
+            IsDerivedFunction(clean_lines, func_start, m_re_result))
         return;
 
     // Don't warn on out-of-line method definitions, as we would warn on the
     // in-line declaration, if it isn't marked with 'override'.
-    if (IsOutOfLineMethodDefinition(clean_lines, linenum))
+    if (func_start != INDEX_NONE &&
+            IsOutOfLineMethodDefinition(clean_lines, func_start))
         return;
 
     std::string line = elided_line;
@@ -3260,7 +3356,7 @@ void FileLinter::CheckForNonConstReference(const CleansedLines& clean_lines,
         return;
 
     // Avoid constructor initializer lists
-    if (IsInitializerList(clean_lines, linenum, m_re_result))
+    if (IsInitializerList(clean_lines, linenum))
         return;
 
     // We allow non-const references in a few standard places, like functions
@@ -3270,6 +3366,12 @@ void FileLinter::CheckForNonConstReference(const CleansedLines& clean_lines,
     // We also accept & in static_assert, which looks like a function but
     // it's actually a declaration expression.
 
+    static const regex_code RE_PATTERN_ALLOWED_FUNCTIONS =
+        RegexCompile(
+            R"((?:[sS]wap(?:<\w:+>)?|)"
+            R"(operator\s*[<>][<>]|)"
+            R"(static_assert|COMPILE_ASSERT)"
+            R"()\s*\()");
     static const regex_code RE_PATTERN_MULTILINE_FUNC =
         RegexCompile(R"(\S+\([^)]*$)");
     if (RegexSearch(RE_PATTERN_ALLOWED_FUNCTIONS, line)) {
@@ -3289,6 +3391,21 @@ void FileLinter::CheckForNonConstReference(const CleansedLines& clean_lines,
     static const regex_code RE_PATTERN_FUNC_BODY =
         RegexCompile("{[^}]*}");
     RegexReplace(RE_PATTERN_FUNC_BODY, " ", &line);  // exclude function body
+
+    // A call-by-reference parameter ends with '& identifier'.
+    static const regex_code RE_REF_PARAM = RegexJitCompile(
+            "(" RE_PATTERN_TYPE R"((?:\s*(?:\bconst\b|[*]))*\s*)"
+            R"(&\s*)" RE_PATTERN_IDENT R"()\s*(?:=[^,()]+)?[,)])");
+    // A call-by-const-reference parameter either ends with 'const& identifier'
+    // or looks like 'const type& identifier' when 'type' is atomic.
+    static const regex_code RE_CONST_REF_PARAM = RegexCompile(
+            R"((?:.*\s*\bconst\s*&\s*)" RE_PATTERN_IDENT
+            R"(|const\s+)" RE_PATTERN_TYPE R"(\s*&\s*)" RE_PATTERN_IDENT ")");
+
+    // Stream types.
+    static const regex_code RE_REF_STREAM_PARAM = RegexCompile(
+            R"((?:.*stream\s*&\s*)" RE_PATTERN_IDENT ")");
+
     while (true) {
         bool matched = RegexJitSearch(RE_REF_PARAM, line, m_re_result);
         if (!matched)
@@ -3308,6 +3425,7 @@ void FileLinter::CheckForNonConstReference(const CleansedLines& clean_lines,
 void FileLinter::CheckForNonStandardConstructs(const CleansedLines& clean_lines,
                                                const std::string& elided_line, size_t linenum,
                                                NestingState* nesting_state) {
+    PROFILE_SCOPE("CheckForNonStandardConstructs");
     // Remove comments from the line, but leave in strings for now.
     const std::string& line = clean_lines.GetLineAt(linenum);
 
@@ -3498,6 +3616,7 @@ void FileLinter::CheckForNonStandardConstructs(const CleansedLines& clean_lines,
 }
 
 void FileLinter::CheckVlogArguments(const std::string& elided_line, size_t linenum) {
+    PROFILE_SCOPE("CheckVlogArguments");
     static const regex_code RE_PATTERN_VLOG_ARG =
         RegexCompile(R"(\bVLOG\((INFO|ERROR|WARNING|DFATAL|FATAL)\))");
     if (RegexSearch(RE_PATTERN_VLOG_ARG, elided_line)) {
@@ -3508,6 +3627,7 @@ void FileLinter::CheckVlogArguments(const std::string& elided_line, size_t linen
 }
 
 void FileLinter::CheckPosixThreading(const std::string& elided_line, size_t linenum) {
+    PROFILE_SCOPE("CheckPosixThreading");
     // Additional pattern matching check to confirm that this is the
     // function we are looking for
 
@@ -3541,6 +3661,7 @@ void FileLinter::CheckPosixThreading(const std::string& elided_line, size_t line
 }
 
 void FileLinter::CheckInvalidIncrement(const std::string& elided_line, size_t linenum) {
+    PROFILE_SCOPE("CheckInvalidIncrement");
     // Matches invalid increment: *count++, which moves pointer instead of
     // incrementing a value.
     static const regex_code RE_INVALID_INCREMENT = RegexCompile(R"(^\s*\*\w+(\+\+|--);)");
@@ -3551,6 +3672,7 @@ void FileLinter::CheckInvalidIncrement(const std::string& elided_line, size_t li
 }
 
 void FileLinter::CheckMakePairUsesDeduction(const std::string& elided_line, size_t linenum) {
+    PROFILE_SCOPE("CheckMakePairUsesDeduction");
     static const regex_code RE_EXPLICIT_MAKEPAIR = RegexCompile(R"(\bmake_pair\s*<)");
     if (RegexSearch(RE_EXPLICIT_MAKEPAIR, elided_line)) {
         Error(linenum, "build/explicit_make_pair",
@@ -3562,6 +3684,7 @@ void FileLinter::CheckMakePairUsesDeduction(const std::string& elided_line, size
 
 void FileLinter::CheckRedundantVirtual(const CleansedLines& clean_lines,
                                        const std::string& elided_line, size_t linenum) {
+    PROFILE_SCOPE("CheckRedundantVirtual");
     // Since RE_PATTERN_VIRTUAL is slow,
     // we check if the line has "virtual" or not.
     if (!StrContain(elided_line, "virtual"))
@@ -3638,6 +3761,7 @@ void FileLinter::CheckRedundantVirtual(const CleansedLines& clean_lines,
 
 void FileLinter::CheckRedundantOverrideOrFinal(const CleansedLines& clean_lines,
                                                const std::string& elided_line, size_t linenum) {
+    PROFILE_SCOPE("CheckRedundantOverrideOrFinal");
     // Look for closing parenthesis nearby.  We need one to confirm where
     // the declarator ends and where the virt-specifier starts to avoid
     // false positives.
@@ -3645,15 +3769,14 @@ void FileLinter::CheckRedundantOverrideOrFinal(const CleansedLines& clean_lines,
     size_t declarator_end = line.rfind(')');
     bool has_error = false;
     if (declarator_end != std::string::npos) {
-        has_error = RegexSearchWithRange(RE_PATTERN_OVERRIDE, line,
+        has_error = RegexSearchWithRange(GetOverridePattern(), line,
                                          declarator_end, line.length() - declarator_end) &&
-                    RegexSearchWithRange(R"(\bfinal\b)", line,
-                                         declarator_end, line.length() - declarator_end);
+                    FindWord(line, "final", declarator_end) != INDEX_NONE;
     } else {
         if (linenum > 1 &&
             clean_lines.GetElidedAt(linenum - 1).rfind(')') != std::string::npos) {
-            has_error = RegexSearch(RE_PATTERN_OVERRIDE, line) &&
-                        RegexSearch(R"(\bfinal\b)", line);
+            has_error = RegexSearch(GetOverridePattern(), line) &&
+                        FindWord(line, "final") != INDEX_NONE;
         } else {
             return;
         }
@@ -3668,6 +3791,7 @@ void FileLinter::CheckRedundantOverrideOrFinal(const CleansedLines& clean_lines,
 }
 
 void FileLinter::CheckCxxHeaders(const std::string& elided_line, size_t linenum) {
+    PROFILE_SCOPE("CheckCxxHeaders");
     static const regex_code RE_PATTERN_CXX_HEADER =
         RegexCompile(R"(\s*#\s*include\s+[<"]([^<"]+)[">])");
     bool include = RegexMatch(RE_PATTERN_CXX_HEADER, elided_line, m_re_result);
@@ -3689,20 +3813,56 @@ void FileLinter::CheckCxxHeaders(const std::string& elided_line, size_t linenum)
     }
 }
 
+// Groups of checks in ProcessLine.
+// Deferred errors are sorted by linenum * LINE_CHECKS_COUNT + group.
+enum : size_t {
+    LINE_CHECKS_NESTING,
+    LINE_CHECKS_STYLE,
+    LINE_CHECKS_WITH_STATE,
+    LINE_CHECKS_LANGUAGE,
+    LINE_CHECKS_COUNT,
+};
+
 void FileLinter::ProcessLine(bool is_header_extension,
                              const CleansedLines& clean_lines,
                              const std::string& elided_line, size_t linenum,
                              IncludeState* include_state,
                              FunctionState* function_state,
                              NestingState* nesting_state) {
+    if (!ProcessLineNesting(clean_lines, elided_line, linenum,
+                            function_state, nesting_state))
+        return;
+    ProcessLineStyle(is_header_extension, clean_lines, elided_line, linenum);
+    ProcessLineWithState(is_header_extension, clean_lines, elided_line, linenum,
+                         include_state, nesting_state);
+    ProcessLineLanguage(clean_lines, elided_line, linenum);
+}
+
+bool FileLinter::ProcessLineNesting(const CleansedLines& clean_lines,
+                                    const std::string& elided_line, size_t linenum,
+                                    FunctionState* function_state,
+                                    NestingState* nesting_state) {
     nesting_state->Update(clean_lines, elided_line, linenum, this);
     CheckForNamespaceIndentation(clean_lines,
                                  elided_line, linenum, nesting_state);
-    if (nesting_state->InAsmBlock()) return;
+    if (nesting_state->InAsmBlock()) return false;
     CheckForFunctionLengths(clean_lines, linenum, function_state);
+    return true;
+}
+
+void FileLinter::ProcessLineStyle(bool is_header_extension,
+                                  const CleansedLines& clean_lines,
+                                  const std::string& elided_line, size_t linenum) {
     CheckForMultilineCommentsAndStrings(elided_line, linenum);
     CheckStyle(clean_lines,
                elided_line, linenum, is_header_extension);
+}
+
+void FileLinter::ProcessLineWithState(bool is_header_extension,
+                                      const CleansedLines& clean_lines,
+                                      const std::string& elided_line, size_t linenum,
+                                      IncludeState* include_state,
+                                      NestingState* nesting_state) {
     CheckStyleWithState(clean_lines,
                         elided_line, linenum, nesting_state);
     CheckLanguage(clean_lines,
@@ -3712,6 +3872,10 @@ void FileLinter::ProcessLine(bool is_header_extension,
                               elided_line, linenum, nesting_state);
     CheckForNonStandardConstructs(clean_lines,
                                   elided_line, linenum, nesting_state);
+}
+
+void FileLinter::ProcessLineLanguage(const CleansedLines& clean_lines,
+                                     const std::string& elided_line, size_t linenum) {
     CheckVlogArguments(elided_line, linenum);
     CheckPosixThreading(elided_line, linenum);
     CheckInvalidIncrement(elided_line, linenum);
@@ -3721,205 +3885,392 @@ void FileLinter::ProcessLine(bool is_header_extension,
     CheckCxxHeaders(elided_line, linenum);
 }
 
-typedef std::vector<std::pair<std::string, regex_code>> header_patterns_t;
-
-// Other scripts may reach in and modify this pattern.
-static const header_patterns_t CompileContainingTemplatesPatterns() {
-    const std::vector<std::pair<std::string, std::set<std::string>>>
-    HEADERS_CONTAINING_TEMPLATES = {
-        { "deque", { "deque", } },
-        { "functional", { "unary_function", "binary_function",
-                            "plus", "minus", "multiplies", "divides", "modulus",
-                            "negate",
-                            "equal_to", "not_equal_to", "greater", "less",
-                            "greater_equal", "less_equal",
-                            "logical_and", "logical_or", "logical_not",
-                            "unary_negate", "not1", "binary_negate", "not2",
-                            "bind1st", "bind2nd",
-                            "pointer_to_unary_function",
-                            "pointer_to_binary_function",
-                            "ptr_fun",
-                            "mem_fun_t", "mem_fun", "mem_fun1_t", "mem_fun1_ref_t",
-                            "mem_fun_ref_t",
-                            "const_mem_fun_t", "const_mem_fun1_t",
-                            "const_mem_fun_ref_t", "const_mem_fun1_ref_t",
-                            "mem_fun_ref", } },
-        { "limits", { "numeric_limits", } },
-        { "list", { "list", } },
-        { "map", { "multimap", } },
-        { "memory", { "allocator", "make_shared", "make_unique", "shared_ptr",
-                        "unique_ptr", "weak_ptr" } },
-        { "queue", { "queue", "priority_queue", } },
-        { "set", { "set", "multiset", } },
-        { "stack", { "stack", } },
-        { "string", { "char_traits", "basic_string", } },
-        { "tuple", { "tuple", } },
-        { "unordered_map", { "unordered_map", "unordered_multimap" } },
-        { "unordered_set", { "unordered_set", "unordered_multiset" } },
-        { "utility", { "pair", } },
-        { "vector", { "vector", } },
-
-        // gcc extensions.
-        // Note: std::hash is their hash, ::hash is our hash
-        { "hash_map", { "hash_map", "hash_multimap", } },
-        { "hash_set", { "hash_set", "hash_multiset", } },
-        { "slist", { "slist", } },
-    };
-    header_patterns_t patterns;
-    patterns.reserve(HEADERS_CONTAINING_TEMPLATES.size());
-    for (const std::pair<std::string, std::set<std::string>>& p : HEADERS_CONTAINING_TEMPLATES) {
-        std::string regex = SetToStr(p.second, R"(((^|(^|\s|((^|\W)::))std::)|[^>.:]\b)()", "|", R"()\s*\<)");
-        patterns.emplace_back(p.first, std::move(RegexJitCompile(regex)));
-    }
-    return patterns;
+void FileLinter::InitLineWorker(const FileLinter& parent,
+                                std::vector<DeferredError>* errors) {
+    m_cpplint_state = parent.m_cpplint_state;
+    m_options = parent.m_options;
+    m_categories_filtered = false;
+    m_error_suppressions = parent.m_error_suppressions;
+    m_all_extensions = parent.m_all_extensions;
+    m_header_extensions = parent.m_header_extensions;
+    m_non_header_extensions = parent.m_non_header_extensions;
+    m_file = parent.m_file;
+    m_filename = parent.m_filename;
+    m_file_extension = parent.m_file_extension;
+    m_file_from_repo = parent.m_file_from_repo;
+    m_basefilename_relative = parent.m_basefilename_relative;
+    m_cppvar = parent.m_cppvar;
+    m_deferred_errors = errors;
 }
 
-static const header_patterns_t RE_PATTERNS_CONTAINING_TEMPLATES =
-    CompileContainingTemplatesPatterns();
+void FileLinter::ProcessLinesInParallel(bool is_header_extension,
+                                        const CleansedLines& clean_lines,
+                                        size_t num_workers) {
+    PROFILE_SCOPE("ProcessLinesInParallel");
+    const std::vector<std::string>& elided_lines = clean_lines.GetElidedLines();
+    size_t num_lines = elided_lines.size();
+    size_t chunk_size = (num_lines + num_workers - 1) / num_workers;
+
+    // Workers run line-local checks for each chunk.
+    // They have their own match data, so they don't share any buffers with this linter.
+    std::vector<std::vector<DeferredError>> worker_errors(num_workers);
+    std::vector<std::future<void>> futures;
+    for (size_t i = 0; i < num_workers; i++) {
+        size_t begin = i * chunk_size;
+        size_t end = MIN(begin + chunk_size, num_lines);
+        futures.push_back(std::async(std::launch::async,
+            [this, &clean_lines, &elided_lines, &worker_errors,
+             is_header_extension, i, begin, end]() {
+                FileLinter worker;
+                worker.InitLineWorker(*this, &worker_errors[i]);
+                for (size_t linenum = begin; linenum < end; linenum++) {
+                    const std::string& elided_line = elided_lines[linenum];
+                    worker.m_error_order = linenum * LINE_CHECKS_COUNT + LINE_CHECKS_STYLE;
+                    worker.ProcessLineStyle(is_header_extension, clean_lines,
+                                            elided_line, linenum);
+                    worker.m_error_order = linenum * LINE_CHECKS_COUNT + LINE_CHECKS_LANGUAGE;
+                    worker.ProcessLineLanguage(clean_lines, elided_line, linenum);
+                }
+            }));
+    }
+
+    // Checks with states run on this thread.
+    std::vector<DeferredError> errors;
+    std::vector<bool> in_asm_block(num_lines, false);
+    m_deferred_errors = &errors;
+    for (size_t linenum = 0; linenum < num_lines; linenum++) {
+        const std::string& elided_line = elided_lines[linenum];
+        m_error_order = linenum * LINE_CHECKS_COUNT + LINE_CHECKS_NESTING;
+        if (!ProcessLineNesting(clean_lines, elided_line, linenum,
+                                &m_function_state, &m_nesting_state)) {
+            in_asm_block[linenum] = true;
+            continue;
+        }
+        m_error_order = linenum * LINE_CHECKS_COUNT + LINE_CHECKS_WITH_STATE;
+        ProcessLineWithState(is_header_extension, clean_lines, elided_line, linenum,
+                             &m_include_state, &m_nesting_state);
+    }
+    m_deferred_errors = nullptr;
 
-static const header_patterns_t CompileMaybeTemplatesPatterns() {
-    const std::vector<std::pair<std::string, std::set<std::string>>>
-    HEADERS_MAYBE_TEMPLATES = {
-        { "algorithm", { "copy", "max", "min", "min_element", "sort", "transform" } },
-        { "utility", { "forward", "make_pair", "move", "swap" } },
-    };
-    header_patterns_t patterns;
-    patterns.reserve(HEADERS_MAYBE_TEMPLATES.size());
-    for (const std::pair<std::string, std::set<std::string>>& p : HEADERS_MAYBE_TEMPLATES) {
-        // Match max<type>(..., ...), max(..., ...), but not foo->max, foo.max or
-        // 'type::max()'.
-        std::string regex = SetToStr(p.second, R"(((\bstd::)|[^>.:])\b()", "|", R"()(<.*?>)?\([^\)])");
-        patterns.emplace_back(p.first, std::move(RegexJitCompile(regex)));
-    }
-    return patterns;
-}
+    for (std::future<void>& future : futures)
+        future.get();
 
-static const header_patterns_t RE_PATTERNS_MAYBE_TEMPLATES =
-    CompileMaybeTemplatesPatterns();
+    // ProcessLine skips line-local checks in assembly blocks.
+    for (std::vector<DeferredError>& chunk_errors : worker_errors) {
+        for (DeferredError& error : chunk_errors) {
+            if (!in_asm_block[error.order / LINE_CHECKS_COUNT])
+                errors.push_back(std::move(error));
+        }
+    }
 
-// Non templated types or global objects
-static const header_patterns_t CompileTypesOrObjsPatterns() {
-    const std::vector<std::pair<std::string, std::set<std::string>>>
-    HEADERS_TYPES_OR_OBJS = {
-        // String and others are special -- it is a non-templatized type in STL.
-        { "string",  {"string"} },
-        { "iostream", { "cin", "cout", "cerr", "clog", "wcin", "wcout",
-                        "wcerr", "wclog" } },
-        { "cstdio", { "FILE", "fpos_t" } },
-    };
-    header_patterns_t patterns;
-    patterns.reserve(HEADERS_TYPES_OR_OBJS.size());
-    for (const std::pair<std::string, std::set<std::string>>& p : HEADERS_TYPES_OR_OBJS) {
-        std::string regex = SetToStr(p.second, "\\b(", "|", ")\\b");
-        patterns.emplace_back(p.first, std::move(RegexJitCompile(regex)));
+    // Each order has errors from only one linter, so a stable sort keeps their order.
+    std::stable_sort(errors.begin(), errors.end(),
+                     [](const DeferredError& a, const DeferredError& b) {
+                         return a.order < b.order;
+                     });
+    for (const DeferredError& error : errors) {
+        m_has_error = true;
+        m_cpplint_state->Error(m_filename, error.linenum, error.category,
+                               error.confidence, error.message);
     }
-    return patterns;
 }
 
-static const header_patterns_t RE_PATTERNS_TYPES_OR_OBJS =
-    CompileTypesOrObjsPatterns();
+// Other scripts may reach in and modify this table.
+static const std::vector<std::pair<std::string, std::set<std::string>>>
+HEADERS_CONTAINING_TEMPLATES = {
+    { "deque", { "deque", } },
+    { "functional", { "unary_function", "binary_function",
+                        "plus", "minus", "multiplies", "divides", "modulus",
+                        "negate",
+                        "equal_to", "not_equal_to", "greater", "less",
+                        "greater_equal", "less_equal",
+                        "logical_and", "logical_or", "logical_not",
+                        "unary_negate", "not1", "binary_negate", "not2",
+                        "bind1st", "bind2nd",
+                        "pointer_to_unary_function",
+                        "pointer_to_binary_function",
+                        "ptr_fun",
+                        "mem_fun_t", "mem_fun", "mem_fun1_t", "mem_fun1_ref_t",
+                        "mem_fun_ref_t",
+                        "const_mem_fun_t", "const_mem_fun1_t",
+                        "const_mem_fun_ref_t", "const_mem_fun1_ref_t",
+                        "mem_fun_ref", } },
+    { "limits", { "numeric_limits", } },
+    { "list", { "list", } },
+    { "map", { "multimap", } },
+    { "memory", { "allocator", "make_shared", "make_unique", "shared_ptr",
+                    "unique_ptr", "weak_ptr" } },
+    { "queue", { "queue", "priority_queue", } },
+    { "set", { "set", "multiset", } },
+    { "stack", { "stack", } },
+    { "string", { "char_traits", "basic_string", } },
+    { "tuple", { "tuple", } },
+    { "unordered_map", { "unordered_map", "unordered_multimap" } },
+    { "unordered_set", { "unordered_set", "unordered_multiset" } },
+    { "utility", { "pair", } },
+    { "vector", { "vector", } },
+
+    // gcc extensions.
+    // Note: std::hash is their hash, ::hash is our hash
+    { "hash_map", { "hash_map", "hash_multimap", } },
+    { "hash_set", { "hash_set", "hash_multiset", } },
+    { "slist", { "slist", } },
+};
 
-// Non templated functions
-static const regex_code CompileCstdioPatterns() {
-    const std::set<std::string> HEADERS_CSTDIO_FUNCTIONS = {
-        "fopen", "freopen",
-        "fclose", "fflush", "setbuf", "setvbuf", "fread",
-        "fwrite", "fgetc", "getc", "fgets", "fputc", "putc",
-        "fputs", "getchar", "gets", "putchar", "puts", "ungetc",
-        "scanf", "fscanf", "sscanf", "vscanf", "vfscanf",
-        "vsscanf", "printf", "fprintf", "sprintf", "snprintf",
-        "vprintf", "vfprintf", "vsprintf", "vsnprintf",
-        "ftell", "fgetpos", "fseek", "fsetpos",
-        "clearerr", "feof", "ferror", "perror",
-        "tmpfile", "tmpnam"
-    };
+static const std::vector<std::pair<std::string, std::set<std::string>>>
+HEADERS_MAYBE_TEMPLATES = {
+    { "algorithm", { "copy", "max", "min", "min_element", "sort", "transform" } },
+    { "utility", { "forward", "make_pair", "move", "swap" } },
+};
 
-    std::string regex = SetToStr(HEADERS_CSTDIO_FUNCTIONS,
-                                 R"(([^>.]|^)\b()", "|", R"()\([^\)])");
+// Non templated types or global objects
+static const std::vector<std::pair<std::string, std::set<std::string>>>
+HEADERS_TYPES_OR_OBJS = {
+    // String and others are special -- it is a non-templatized type in STL.
+    { "string",  {"string"} },
+    { "iostream", { "cin", "cout", "cerr", "clog", "wcin", "wcout",
+                    "wcerr", "wclog" } },
+    { "cstdio", { "FILE", "fpos_t" } },
+};
 
-    return RegexJitCompile(regex);
-}
+// Non templated functions
+static const std::vector<std::pair<std::string, std::set<std::string>>>
+HEADERS_CSTDIO_FUNCTIONS = {
+    { "cstdio", { "fopen", "freopen",
+                  "fclose", "fflush", "setbuf", "setvbuf", "fread",
+                  "fwrite", "fgetc", "getc", "fgets", "fputc", "putc",
+                  "fputs", "getchar", "gets", "putchar", "puts", "ungetc",
+                  "scanf", "fscanf", "sscanf", "vscanf", "vfscanf",
+                  "vsscanf", "printf", "fprintf", "sprintf", "snprintf",
+                  "vprintf", "vfprintf", "vsprintf", "vsnprintf",
+                  "ftell", "fgetpos", "fseek", "fsetpos",
+                  "clearerr", "feof", "ferror", "perror",
+                  "tmpfile", "tmpnam" } },
+};
 
-static const regex_code RE_PATTERN_CSTDIO_FUNCTIONS =
-    CompileCstdioPatterns();
+// Map is often overloaded. Only check, if it is fully qualified.
+static const std::vector<std::pair<std::string, std::set<std::string>>>
+HEADERS_MAP_TEMPLATES = {
+    { "map", { "map" } },
+};
 
-void FileLinter::CheckForIncludeWhatYouUse(const CleansedLines& clean_lines,
-                                           IncludeState* include_state) {
-    // A map of header name to linenumber and the template entity.
-    // Example of required: { '<functional>': (1219, 'less<>') }
-    std::map<std::string, std::pair<size_t, std::string>> required = {};
+// Kinds of symbols for CheckForIncludeWhatYouUse.
+// Matches are applied in this order, so later kinds overwrite earlier ones.
+enum : int {
+    IWYU_TYPES_OR_OBJS,
+    IWYU_CSTDIO_FUNCTIONS,
+    IWYU_MAYBE_TEMPLATES,
+    IWYU_MAP_TEMPLATES,
+    IWYU_CONTAINING_TEMPLATES,
+};
 
-    size_t linenum = INDEX_NONE;  // -1
-    for (const std::string& line : clean_lines.GetElidedLines()) {
-        linenum++;
-        if (line.empty() || line[0] == '#')
-            continue;
+// A pair of a header and a kind of symbols.
+// We check only the first match per line for each slot; good enough.
+struct IwyuSlot {
+    int kind;
+    const std::string* header;
+};
 
-        // Non templated types or global objects
-        for (const std::pair<std::string, regex_code>& p : RE_PATTERNS_TYPES_OR_OBJS) {
-            bool matched = RegexJitSearch(p.second, line, m_re_result);
-            if (matched) {
-                // Don't warn about strings in non-STL namespaces:
-                // (We check only the first match per line; good enough.)
-                std::string_view prefix(line.data(), GetMatchStart(m_re_result, 0));
-                if (prefix.ends_with("std::") || !prefix.ends_with("::")) {
-                    std::string func = GetMatchStr(m_re_result, line, 1);
-                    required[p.first] = { linenum, func };
-                }
+// Symbol table for CheckForIncludeWhatYouUse.
+// Instead of running a regex pattern for each header,
+// lines are split into identifiers, and the identifiers are looked up in a hash map.
+struct IwyuTable {
+    std::vector<IwyuSlot> slots;
+    // Identifier to slot IDs
+    std::unordered_map<std::string_view, std::vector<size_t>> symbols;
+    size_t min_size = INDEX_NONE;
+    size_t max_size = 0;
+
+    void Add(int kind,
+             const std::vector<std::pair<std::string, std::set<std::string>>>& headers) {
+        for (const std::pair<std::string, std::set<std::string>>& p : headers) {
+            size_t slot = slots.size();
+            slots.push_back({ kind, &p.first });
+            for (const std::string& name : p.second) {
+                symbols[name].push_back(slot);
+                min_size = MIN(min_size, name.size());
+                max_size = MAX(max_size, name.size());
             }
         }
+    }
+};
+
+static const IwyuTable BuildIwyuTable() {
+    IwyuTable table;
+    table.Add(IWYU_TYPES_OR_OBJS, HEADERS_TYPES_OR_OBJS);
+    table.Add(IWYU_CSTDIO_FUNCTIONS, HEADERS_CSTDIO_FUNCTIONS);
+    table.Add(IWYU_MAYBE_TEMPLATES, HEADERS_MAYBE_TEMPLATES);
+    table.Add(IWYU_MAP_TEMPLATES, HEADERS_MAP_TEMPLATES);
+    table.Add(IWYU_CONTAINING_TEMPLATES, HEADERS_CONTAINING_TEMPLATES);
+    return table;
+}
+
+static bool IsStdQualifiedAt(const std::string& line, size_t pos) {
+    return pos >= 5 && line.compare(pos - 5, 5, "std::") == 0;
+}
+
+// Returns true if line[pos] is '(' for a function call with arguments.
+static bool IsCallWithArgsAt(const std::string& line, size_t pos) {
+    return pos + 1 < line.size() && line[pos] == '(' && line[pos + 1] != ')';
+}
 
-        // Non templated functions
-        {
-            bool matched = RegexJitSearch(RE_PATTERN_CSTDIO_FUNCTIONS, line, m_re_result);
-            if (matched) {
-                // Don't warn about strings in non-STL namespaces:
-                // (We check only the first match per line; good enough.)
-                std::string_view prefix(line.data(), GetMatchStart(m_re_result, 0));
-                if (prefix.ends_with("std::") || !prefix.ends_with("::")) {
-                    std::string func = GetMatchStr(m_re_result, line, 2);
-                    required["cstdio"] = { linenum, func };
+// Checks the context of an identifier line[start:end] that is in the symbol table.
+// Returns the start position of the match for the kind of symbols,
+// or INDEX_NONE if the identifier is not used as the kind of symbols.
+// The rules are the same as the following regex patterns.
+//   TYPES_OR_OBJS:       \b(name)\b
+//   CSTDIO_FUNCTIONS:    ([^>.]|^)\b(name)\([^\)]
+//   MAYBE_TEMPLATES:     ((\bstd::)|[^>.:])\b(name)(<.*?>)?\([^\)]
+//   MAP_TEMPLATES:       (std\b::\bmap\s*\<)|(^(std\b::\b)map\b\(\s*\<)
+//   CONTAINING_TEMPLATES: ((^|(^|\s|((^|\W)::))std::)|[^>.:]\b)(name)\s*\<
+static size_t FindIwyuMatchStart(const std::string& line, size_t start, size_t end,
+                                 int kind) {
+    size_t size = line.size();
+    // The previous character is not a word character because identifiers are whole tokens.
+    char prev = (start > 0) ? line[start - 1] : '\0';
+    switch (kind) {
+        case IWYU_TYPES_OR_OBJS:
+            return start;
+        case IWYU_CSTDIO_FUNCTIONS:
+            if (prev == '>' || prev == '.' || !IsCallWithArgsAt(line, end))
+                return INDEX_NONE;
+            return (start > 0) ? start - 1 : 0;
+        case IWYU_MAYBE_TEMPLATES: {
+            bool std_prefix = IsStdQualifiedAt(line, start) &&
+                              (start == 5 || !IS_WORD_CHAR(line[start - 6]));
+            if (!std_prefix && (start == 0 || prev == '>' || prev == '.' || prev == ':'))
+                return INDEX_NONE;
+            if (IsCallWithArgsAt(line, end))
+                return start;
+            if (end < size && line[end] == '<') {
+                // Lazy match for <.*?>
+                for (size_t i = end + 1; i < size && line[i] != '\n'; i++) {
+                    if (line[i] == '>' && IsCallWithArgsAt(line, i + 1))
+                        return start;
                 }
             }
+            return INDEX_NONE;
         }
-
-        for (const std::pair<std::string, regex_code>& p : RE_PATTERNS_MAYBE_TEMPLATES) {
-            bool matched = RegexJitSearch(p.second, line, m_re_result);
-            if (matched) {
-                std::string func = GetMatchStr(m_re_result, line, 3);
-                required[p.first] = { linenum, func };
+        case IWYU_MAP_TEMPLATES: {
+            if (!IsStdQualifiedAt(line, start))
+                return INDEX_NONE;
+            size_t pos = end;
+            if (start == 5 && pos < size && line[pos] == '(')
+                pos++;
+            pos = GetFirstNonSpacePos(line, pos);
+            if (pos < size && line[pos] == '<')
+                return start - 5;
+            return INDEX_NONE;
+        }
+        case IWYU_CONTAINING_TEMPLATES: {
+            size_t pos = GetFirstNonSpacePos(line, end);
+            if (pos >= size || line[pos] != '<')
+                return INDEX_NONE;
+            if (start == 0)
+                return 0;
+            // Find the leftmost match
+            size_t match_start = INDEX_NONE;
+            if (IsStdQualifiedAt(line, start)) {
+                size_t std_start = start - 5;
+                if (std_start == 0)
+                    return 0;
+                if (std_start >= 2 && line.compare(std_start - 2, 2, "::") == 0) {
+                    if (std_start == 2)
+                        return 0;
+                    if (!IS_WORD_CHAR(line[std_start - 3]))
+                        match_start = std_start - 3;
+                }
+                if (match_start == INDEX_NONE && IS_SPACE(line[std_start - 1]))
+                    match_start = std_start - 1;
             }
+            if (match_start == INDEX_NONE && prev != '>' && prev != '.' && prev != ':')
+                match_start = start - 1;
+            return match_start;
         }
+        default:
+            return INDEX_NONE;
+    }
+}
+
+void FileLinter::CheckForIncludeWhatYouUse(const CleansedLines& clean_lines,
+                                           IncludeState* include_state) {
+    PROFILE_SCOPE("CheckForIncludeWhatYouUse");
+    IwyuRequired required = {};
+    FindIncludeWhatYouUse(clean_lines, clean_lines.FirstLine(), clean_lines.NumLines(),
+                          &required);
+    ReportIncludeWhatYouUse(required, include_state);
+}
+
+void FileLinter::FindIncludeWhatYouUse(const CleansedLines& clean_lines,
+                                       size_t begin, size_t end,
+                                       IwyuRequired* required) {
+    static const IwyuTable IWYU_TABLE = BuildIwyuTable();
+
+    // Identifiers found for each slot in the current line.
+    size_t slot_count = IWYU_TABLE.slots.size();
+    std::vector<bool> slot_checked(slot_count);
+    std::vector<std::string_view> slot_funcs(slot_count);
 
-        // The following function is just a speed up, no semantics are changed.
-        if (!StrContain(line, '<'))  // Reduces the cpu time usage by skipping lines.
+    for (size_t linenum = begin; linenum < end; linenum++) {
+        const std::string& line = clean_lines.GetElidedAt(linenum);
+        if (line.empty() || line[0] == '#')
             continue;
 
-        // Map is often overloaded. Only check, if it is fully qualified.
-        // Match 'std::map<type>(...)', but not 'map<type>(...)''
-        static const regex_code RE_PATTERNS_MAP_TEMPLATES =
-            RegexJitCompile(R"((std\b::\bmap\s*\<)|(^(std\b::\b)map\b\(\s*\<))");
-        if (RegexJitSearch(RE_PATTERNS_MAP_TEMPLATES, line))
-            required["map"] = { linenum, "map<>" };
-
-        // Other scripts may reach in and modify this pattern.
-        for (const std::pair<std::string, regex_code>& p : RE_PATTERNS_CONTAINING_TEMPLATES) {
-            bool matched = RegexJitSearch(p.second, line, m_re_result);
-            if (matched) {
-                // Don't warn about IWYU in non-STL namespaces:
-                // (We check only the first match per line; good enough.)
-                std::string_view prefix(line.data(), GetMatchStart(m_re_result, 0));
-                if (prefix.ends_with("std::") || !prefix.ends_with("::")) {
-                    std::string func = GetMatchStr(m_re_result, line, 6) + "<>";
-                    required[p.first] = { linenum, func };
+        std::fill(slot_checked.begin(), slot_checked.end(), false);
+        std::fill(slot_funcs.begin(), slot_funcs.end(), std::string_view());
+
+        size_t size = line.size();
+        size_t end = 0;
+        while (end < size) {
+            if (!IS_WORD_CHAR(line[end])) {
+                end++;
+                continue;
+            }
+            size_t start = end;
+            while (end < size && IS_WORD_CHAR(line[end]))
+                end++;
+            size_t token_size = end - start;
+            if (token_size < IWYU_TABLE.min_size || token_size > IWYU_TABLE.max_size)
+                continue;
+            auto it = IWYU_TABLE.symbols.find(std::string_view(line.data() + start, token_size));
+            if (it == IWYU_TABLE.symbols.end())
+                continue;
+
+            for (size_t slot : it->second) {
+                if (slot_checked[slot])
+                    continue;
+                int kind = IWYU_TABLE.slots[slot].kind;
+                size_t match_start = FindIwyuMatchStart(line, start, end, kind);
+                if (match_start == INDEX_NONE)
+                    continue;
+                slot_checked[slot] = true;
+                if (kind != IWYU_MAYBE_TEMPLATES && kind != IWYU_MAP_TEMPLATES) {
+                    // Don't warn about IWYU in non-STL namespaces:
+                    std::string_view prefix(line.data(), match_start);
+                    if (!prefix.ends_with("std::") && prefix.ends_with("::"))
+                        continue;
                 }
+                slot_funcs[slot] = it->first;
             }
         }
+
+        for (size_t slot = 0; slot < slot_count; slot++) {
+            if (slot_funcs[slot].empty())
+                continue;
+            const IwyuSlot& iwyu_slot = IWYU_TABLE.slots[slot];
+            std::string func(slot_funcs[slot]);
+            if (iwyu_slot.kind >= IWYU_MAP_TEMPLATES)
+                func += "<>";
+            (*required)[*iwyu_slot.header] = { linenum, func };
+        }
     }
+}
 
+void FileLinter::ReportIncludeWhatYouUse(const IwyuRequired& required,
+                                         IncludeState* include_state) {
     // All the lines have been processed, report the errors found.
     for (const auto& required_header_unstripped : required) {
-        linenum = required_header_unstripped.second.first;
+        size_t linenum = required_header_unstripped.second.first;
         const std::string& func = required_header_unstripped.second.second;
         const std::string& header = required_header_unstripped.first;
         if (include_state->FindHeader(header) == INDEX_NONE) {
@@ -3931,6 +4282,7 @@ void FileLinter::CheckForIncludeWhatYouUse(const CleansedLines& clean_lines,
 }
 
 void FileLinter::CheckHeaderFileIncluded(IncludeState* include_state) {
+    PROFILE_SCOPE("CheckHeaderFileIncluded");
     // Do not check test files
     std::string path_from_repo = m_file_from_repo.string();
     fs::path filedir = m_file.parent_path();
@@ -4001,15 +4353,21 @@ void FileLinter::CacheVariables(const fs::path& file) {
 }
 
 void FileLinter::ProcessFileData(std::vector<std::string>& lines) {
-    IncludeState include_state = IncludeState();
-    FunctionState function_state = FunctionState();
-    NestingState nesting_state = NestingState();
+    PROFILE_SCOPE("ProcessFileData");
+    IncludeState& include_state = m_include_state;
+    FunctionState& function_state = m_function_state;
+    NestingState& nesting_state = m_nesting_state;
+    include_state.Clear();
+    function_state = FunctionState();
+    nesting_state.Clear();
 
     m_error_suppressions.Clear();
+    m_init_list_scanned = INDEX_NONE;
 
     CheckForCopyright(lines);
     RemoveMultiLineComments(lines);
-    CleansedLines clean_lines = CleansedLines(lines, m_options);
+    CleansedLines& clean_lines = m_clean_lines;
+    clean_lines.Reset(lines, m_options);
 
     {
         // Set error suppressions
@@ -4034,12 +4392,27 @@ void FileLinter::ProcessFileData(std::vector<std::string>& lines) {
         CheckForHeaderGuard(clean_lines);
     }
 
-    size_t linenum = 0;  // -1
-    for (const std::string& elided_line : clean_lines.GetElidedLines()) {
-        ProcessLine(is_header_extension, clean_lines,
-                    elided_line, linenum,
-                    &include_state, &function_state, &nesting_state);
-        linenum++;
+    size_t num_workers = 0;
+    int num_threads = m_cpplint_state->GetNumThreads();
+    if (num_threads > 1 && m_parallel_chunk_lines > 0) {
+        num_workers = MIN(static_cast<size_t>(num_threads - 1),
+                          clean_lines.NumLines() / m_parallel_chunk_lines);
+        if (m_idle_workers != nullptr)
+            num_workers = m_idle_workers->TryTake(num_workers);
+    }
+
+    if (num_workers > 0) {
+        ProcessLinesInParallel(is_header_extension, clean_lines, num_workers);
+        if (m_idle_workers != nullptr)
+            m_idle_workers->Release(num_workers);
+    } else {
+        size_t linenum = 0;  // -1
+        for (const std::string& elided_line : clean_lines.GetElidedLines()) {
+            ProcessLine(is_header_extension, clean_lines,
+                        elided_line, linenum,
+                        &include_state, &function_state, &nesting_state);
+            linenum++;
+        }
     }
 
     CheckForIncludeWhatYouUse(clean_lines, &include_state);
@@ -4051,23 +4424,215 @@ void FileLinter::ProcessFileData(std::vector<std::string>& lines) {
     CheckForNewlineAtEOF(lines);
 }
 
-void FileLinter::ProcessFile() {
+bool FileLinter::ReadStreamLine(std::istream& stream, std::string* line, size_t linenum,
+                                size_t* lf_lines_count) {
+    int status = LINE_OK;
+    GetLine(stream, &m_line_buffer, line, &status);
+    if (!line->empty() && line->back() == '\r') {
+        // line ends with \r.
+        m_crlf_lines.push_back(linenum);
+        line->pop_back();
+    } else {
+        (*lf_lines_count)++;
+    }
+    if (status & LINE_BAD_RUNE) {
+        // line contains bad runes.
+        m_bad_lines.push_back(linenum);
+    }
+    if (status & LINE_NULL) {
+        // line contains null bytes.
+        m_null_lines.push_back(linenum);
+    }
+    return (status & LINE_EOF) == 0;
+}
+
+void FileLinter::CheckLineEncodings(size_t lf_lines_count, size_t end) {
+    // If end-of-line sequences are a mix of LF and CR-LF, issue
+    // warnings on the lines with CR.
+    //
+    // Don't issue any warnings if all lines are uniformly LF or CR-LF,
+    // since critique can handle these just fine, and the style guide
+    // doesn't dictate a particular end of line sequence.
+    //
+    // We can't depend on os.linesep to determine what the desired
+    // end-of-line sequence should be, since that will return the
+    // server-side end-of-line sequence.
+    auto lines_end = [end](std::vector<size_t>& lines) {
+        return std::lower_bound(lines.begin(), lines.end(), end);
+    };
+    if (lf_lines_count > 0 && m_crlf_lines.size() > 0) {
+        // Warn on every line with CR.  An alternative approach might be to
+        // check whether the file is mostly CRLF or just LF, and warn on the
+        // minority, we bias toward LF here since most tools prefer LF.
+        auto crlf_end = lines_end(m_crlf_lines);
+        for (auto it = m_crlf_lines.begin(); it != crlf_end; it++) {
+            Error(*it, "whitespace/newline", 1,
+                  "Unexpected \\r (^M) found; better to use only \\n");
+        }
+        m_crlf_lines.erase(m_crlf_lines.begin(), crlf_end);
+    }
+    auto bad_end = lines_end(m_bad_lines);
+    for (auto it = m_bad_lines.begin(); it != bad_end; it++) {
+        Error(*it, "readability/utf8", 5,
+              "Line contains invalid UTF-8 (or Unicode replacement character).");
+    }
+    m_bad_lines.erase(m_bad_lines.begin(), bad_end);
+    auto null_end = lines_end(m_null_lines);
+    for (auto it = m_null_lines.begin(); it != null_end; it++) {
+        Error(*it, "readability/nul", 5,
+              "Line contains NUL byte.");
+    }
+    m_null_lines.erase(m_null_lines.begin(), null_end);
+}
+
+void FileLinter::ProcessStream(std::istream& stream) {
+    PROFILE_SCOPE("ProcessStream");
+    IncludeState& include_state = m_include_state;
+    FunctionState& function_state = m_function_state;
+    NestingState& nesting_state = m_nesting_state;
+    include_state.Clear();
+    function_state = FunctionState();
+    nesting_state.Clear();
+
+    m_error_suppressions.Clear();
+    m_init_list_scanned = INDEX_NONE;
+    m_crlf_lines.clear();
+    m_bad_lines.clear();
+    m_null_lines.clear();
+
+    // A quarter of the window is kept behind the checked lines,
+    // and another quarter is read ahead of them.
+    size_t window_lines = MAX(m_stream_window_lines, MIN_STREAM_WINDOW_LINES);
+    size_t margin = window_lines / 4;
+
+    std::vector<std::string>& lines = m_lines;
+    lines.clear();
+    lines.emplace_back("// marker so line numbers and indices both start at 1");
+    if (m_line_buffer.size() < 120)
+        m_line_buffer.resize(120);
+
+    CleansedLines& clean_lines = m_clean_lines;
+    bool is_header_extension = m_header_extensions.contains(m_file_extension);
+    IwyuRequired required = {};
+    size_t lf_lines_count = 0;
+    size_t first_line = 0;  // line number of lines[0]
+    size_t parsed_end = 0;  // NOLINT comments are parsed up to this line
+    size_t checked_end = 0;  // lines are checked up to this line
+    size_t read_size = window_lines;
+    bool eof = false;
+    while (true) {
+        while (!eof && lines.size() < read_size) {
+            size_t linenum = first_line + lines.size();
+            lines.emplace_back();
+            if (!ReadStreamLine(stream, &lines.back(), linenum, &lf_lines_count)) {
+                eof = true;
+                lines.emplace_back("// marker so line numbers end in a known way");
+            }
+        }
+
+        if (first_line == 0 && checked_end == 0)
+            CheckForCopyright(lines);
+
+        // Lines are cleansed again from the first line of the window.
+        // It's fine since removing comments and alternate tokens doesn't change
+        // lines that have been processed.
+        size_t unclosed = RemoveMultiLineComments(lines, first_line, !eof);
+        clean_lines.Reset(lines, m_options, first_line);
+
+        // Lines in a comment that is not closed yet are not ready.
+        size_t ready_end = clean_lines.NumLines();
+        if (!eof && unclosed != INDEX_NONE)
+            ready_end = first_line + unclosed;
+
+        // Set error suppressions
+        for (; parsed_end < ready_end; parsed_end++) {
+            if (clean_lines.HasComment(parsed_end)) {
+                const std::string& line = clean_lines.GetRawLineAt(parsed_end);
+                ParseNolintSuppressions(line, parsed_end);
+                ProcessGlobalSuppressions(line);
+            }
+        }
+
+        // Checks can look ahead a margin of lines.
+        size_t check_end = checked_end;
+        if (eof)
+            check_end = ready_end;
+        else if (ready_end > checked_end + margin)
+            check_end = ready_end - margin;
+
+        for (size_t linenum = checked_end; linenum < check_end; linenum++) {
+            ProcessLine(is_header_extension, clean_lines,
+                        clean_lines.GetElidedAt(linenum), linenum,
+                        &include_state, &function_state, &nesting_state);
+        }
+        FindIncludeWhatYouUse(clean_lines, checked_end, check_end, &required);
+        CheckLineEncodings(lf_lines_count, check_end);
+        checked_end = check_end;
+        if (eof)
+            break;
+
+        // Print errors of checked lines now, and free blocks that were closed.
+        m_cpplint_state->FlushThreadStream();
+        nesting_state.Compact();
+
+        // Slide the window. Lines of a multi-line raw string are kept
+        // from its first line, or they will be cleansed as code.
+        size_t keep = (checked_end > margin) ? checked_end - margin : 0;
+        while (keep > first_line &&
+               clean_lines.GetLineWithoutRawStringAt(keep - 1).ends_with("\"\""))
+            keep--;
+        lines.erase(lines.begin(), lines.begin() + static_cast<ptrdiff_t>(keep - first_line));
+        first_line = keep;
+
+        // The window grows when it can't be slid, e.g. for long comments.
+        read_size = MAX(window_lines, lines.size() + lines.size() / 2);
+    }
+
+    if (m_error_suppressions.HasOpenBlock()) {
+        Error(m_error_suppressions.GetOpenBlockStart(), "readability/nolint", 5,
+              "NOLINT block never ended");
+    }
+
+    ReportIncludeWhatYouUse(required, &include_state);
+
+    // Check that the .cc file has included its header if it exists.
+    if (m_non_header_extensions.contains(m_file_extension))
+        CheckHeaderFileIncluded(&include_state);
+
+    CheckForNewlineAtEOF(lines, first_line);
+}
+
+void FileLinter::ProcessFile(const std::string* content) {
     if (!m_options.ProcessConfigOverrides(m_file, m_cpplint_state)) {
         return;
     }
+    // Filters of config files are added.
+    m_categories_filtered = false;
+
+    if (content == nullptr && StrIsChar(m_filename, '-')) {
+        // Read from stdin
+        CacheVariables();
+        ProcessStream(std::cin);
+        if (!m_cpplint_state->Quiet() || m_has_error)
+            m_cpplint_state->PrintInfo("Done processing " + m_filename + "\n");
+        return;
+    }
 
     size_t lf_lines_count = 0;
-    std::vector<size_t> crlf_lines = {};
-    std::vector<size_t> bad_lines = {};
-    std::vector<size_t> null_lines = {};
-    std::vector<std::string> lines = {};
+    std::vector<std::string>& lines = m_lines;
+    m_crlf_lines.clear();
+    m_bad_lines.clear();
+    m_null_lines.clear();
 
     {
+        PROFILE_SCOPE("ReadFile");
         std::istream* stream;
         std::ifstream file;
-        if (StrIsChar(m_filename, '-')) {
-            // Read from stdin
-            stream = &std::cin;
+        StringReadBuf content_buf(content != nullptr ? *content : std::string_view());
+        std::istream content_stream(&content_buf);
+        if (content != nullptr) {
+            // Read from the loaded content
+            stream = &content_stream;
         } else {
             // Read from a file
             file = std::ifstream(m_file, std::ios::binary);
@@ -4079,37 +4644,27 @@ void FileLinter::ProcessFile() {
             stream = &file;
         }
 
+        // Strings in lines are overwritten to reuse their buffers.
         // insert a comment line at the beginning of file.
-        lines.emplace_back("// marker so line numbers and indices both start at 1");
+        if (lines.empty())
+            lines.emplace_back();
+        lines[0] = "// marker so line numbers and indices both start at 1";
 
         size_t linenum = 1;
-        int status = LINE_OK;
-        std::string buffer;
-        buffer.resize(120);
+        if (m_line_buffer.size() < 120)
+            m_line_buffer.resize(120);
         // Note: We can't use getline cause it trims NUL bytes and a linefeed at EOF.
-        while ((status & LINE_EOF) == 0) {
-            std::string line = GetLine(*stream, &buffer, &status);
-            if (!line.empty() && line.back() == '\r') {
-                // line ends with \r.
-                crlf_lines.push_back(linenum);
-                line.pop_back();
-            } else {
-                lf_lines_count++;
-            }
-            if (status & LINE_BAD_RUNE) {
-                // line contains bad runes.
-                bad_lines.push_back(linenum);
-            }
-            if (status & LINE_NULL) {
-                // line contains null bytes.
-                null_lines.push_back(linenum);
-            }
-            lines.emplace_back(std::move(line));
+        bool has_next = true;
+        while (has_next) {
+            if (lines.size() <= linenum)
+                lines.emplace_back();
+            has_next = ReadStreamLine(*stream, &lines[linenum], linenum, &lf_lines_count);
             linenum++;
         }
 
         // add a comment line to the end of file.
-        lines.emplace_back("// marker so line numbers end in a known way");
+        lines.resize(linenum + 1);
+        lines[linenum] = "// marker so line numbers end in a known way";
     }
 
     CacheVariables();
@@ -4122,34 +4677,7 @@ void FileLinter::ProcessFile() {
     } else {
         // Check lines
         ProcessFileData(lines);
-
-        // If end-of-line sequences are a mix of LF and CR-LF, issue
-        // warnings on the lines with CR.
-        //
-        // Don't issue any warnings if all lines are uniformly LF or CR-LF,
-        // since critique can handle these just fine, and the style guide
-        // doesn't dictate a particular end of line sequence.
-        //
-        // We can't depend on os.linesep to determine what the desired
-        // end-of-line sequence should be, since that will return the
-        // server-side end-of-line sequence.
-        if (lf_lines_count > 0 && crlf_lines.size() > 0) {
-            // Warn on every line with CR.  An alternative approach might be to
-            // check whether the file is mostly CRLF or just LF, and warn on the
-            // minority, we bias toward LF here since most tools prefer LF.
-            for (size_t linenum : crlf_lines) {
-                Error(linenum, "whitespace/newline", 1,
-                      "Unexpected \\r (^M) found; better to use only \\n");
-            }
-        }
-        for (size_t linenum : bad_lines) {
-            Error(linenum, "readability/utf8", 5,
-                  "Line contains invalid UTF-8 (or Unicode replacement character).");
-        }
-        for (size_t linenum : null_lines) {
-            Error(linenum, "readability/nul", 5,
-                  "Line contains NUL byte.");
-        }
+        CheckLineEncodings(lf_lines_count, INDEX_NONE);
     }
 
     // Suppress printing anything if --quiet was passed unless the error
@@ -0,0 +1,348 @@
+#include "file_loader.h"
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include "common.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef CPPLINT_IO_URING
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+
+namespace fs = std::filesystem;
+
+bool LoadFile(const fs::path& path, std::string* content) {
+    content->clear();
+#ifdef _WIN32
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+        return false;
+    content->assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    return !file.bad();
+#else
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+#ifdef POSIX_FADV_SEQUENTIAL
+    // Ask the kernel for aggressive readahead.
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+    struct stat st;
+    size_t size = 0;
+    if (fstat(fd, &st) == 0 && st.st_size > 0)
+        size = static_cast<size_t>(st.st_size);
+    // Read one more byte to detect files that grew after fstat.
+    content->resize(size + 1);
+    size_t length = 0;
+    bool ok = true;
+    while (true) {
+        if (length == content->size())
+            content->resize(content->size() * 2);
+        ssize_t n = read(fd, content->data() + length, content->size() - length);
+        if (n == 0)
+            break;
+        if (n < 0) {
+            // e.g. EISDIR. The check stage will try to read it again and report it.
+            ok = false;
+            break;
+        }
+        length += static_cast<size_t>(n);
+    }
+    close(fd);
+    content->resize(length);
+    return ok;
+#endif
+}
+
+UringLoader::UringLoader() :
+        m_ring_fd(-1),
+        m_entries(0),
+        m_sq_ptr(nullptr),
+        m_sq_size(0),
+        m_cq_ptr(nullptr),
+        m_cq_size(0),
+        m_sqes(nullptr),
+        m_sqes_size(0),
+        m_sq_head(nullptr),
+        m_sq_tail(nullptr),
+        m_sq_mask(nullptr),
+        m_sq_array(nullptr),
+        m_cq_head(nullptr),
+        m_cq_tail(nullptr),
+        m_cq_mask(nullptr),
+        m_cqes(nullptr),
+        m_to_submit(0) {}
+
+#ifdef CPPLINT_IO_URING
+
+UringLoader::~UringLoader() {
+    if (m_sqes != nullptr)
+        munmap(m_sqes, m_sqes_size);
+    if (m_cq_ptr != nullptr && m_cq_ptr != m_sq_ptr)
+        munmap(m_cq_ptr, m_cq_size);
+    if (m_sq_ptr != nullptr)
+        munmap(m_sq_ptr, m_sq_size);
+    if (m_ring_fd >= 0)
+        close(m_ring_fd);
+}
+
+static void* MapRing(int ring_fd, size_t size, uint64_t offset) {
+    void* ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                     ring_fd, static_cast<off_t>(offset));
+    return ptr == MAP_FAILED ? nullptr : ptr;
+}
+
+template <typename T>
+static T* RingField(void* ring, uint32_t offset) {
+    return reinterpret_cast<T*>(static_cast<char*>(ring) + offset);
+}
+
+bool UringLoader::Init(unsigned entries) {
+    io_uring_params params = {};
+    int ring_fd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+    if (ring_fd < 0)
+        return false;
+    m_ring_fd = ring_fd;
+
+    // OPENAT and STATX were added in Linux 5.6 along with this feature.
+    if (!(params.features & IORING_FEAT_RW_CUR_POS))
+        return false;
+
+    m_sq_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    m_cq_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        m_sq_size = m_cq_size = MAX(m_sq_size, m_cq_size);
+        m_sq_ptr = MapRing(m_ring_fd, m_sq_size, IORING_OFF_SQ_RING);
+        m_cq_ptr = m_sq_ptr;
+    } else {
+        m_sq_ptr = MapRing(m_ring_fd, m_sq_size, IORING_OFF_SQ_RING);
+        m_cq_ptr = MapRing(m_ring_fd, m_cq_size, IORING_OFF_CQ_RING);
+    }
+    m_sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+    m_sqes = MapRing(m_ring_fd, m_sqes_size, IORING_OFF_SQES);
+    if (m_sq_ptr == nullptr || m_cq_ptr == nullptr || m_sqes == nullptr)
+        return false;
+
+    m_sq_head = RingField<unsigned>(m_sq_ptr, params.sq_off.head);
+    m_sq_tail = RingField<unsigned>(m_sq_ptr, params.sq_off.tail);
+    m_sq_mask = RingField<unsigned>(m_sq_ptr, params.sq_off.ring_mask);
+    m_sq_array = RingField<unsigned>(m_sq_ptr, params.sq_off.array);
+    m_cq_head = RingField<unsigned>(m_cq_ptr, params.cq_off.head);
+    m_cq_tail = RingField<unsigned>(m_cq_ptr, params.cq_off.tail);
+    m_cq_mask = RingField<unsigned>(m_cq_ptr, params.cq_off.ring_mask);
+    m_cqes = RingField<io_uring_cqe>(m_cq_ptr, params.cq_off.cqes);
+    m_entries = params.sq_entries;
+    return true;
+}
+
+void* UringLoader::GetSqe() {
+    unsigned tail = *m_sq_tail;
+    unsigned head = std::atomic_ref<unsigned>(*m_sq_head).load(std::memory_order_acquire);
+    if (tail - head >= m_entries)
+        return nullptr;
+    unsigned index = tail & *m_sq_mask;
+    io_uring_sqe* sqe = static_cast<io_uring_sqe*>(m_sqes) + index;
+    *sqe = {};
+    m_sq_array[index] = index;
+    std::atomic_ref<unsigned>(*m_sq_tail).store(tail + 1, std::memory_order_release);
+    m_to_submit++;
+    return sqe;
+}
+
+bool UringLoader::SubmitAndWait(unsigned wait_nr) {
+    while (true) {
+        int ret = static_cast<int>(syscall(__NR_io_uring_enter, m_ring_fd, m_to_submit, wait_nr,
+                                           IORING_ENTER_GETEVENTS, nullptr, 0));
+        if (ret >= 0) {
+            m_to_submit -= MIN(static_cast<unsigned>(ret), m_to_submit);
+            return true;
+        }
+        if (errno != EINTR)
+            return false;
+    }
+}
+
+template <typename Func>
+void UringLoader::ReapCompletions(Func on_complete) {
+    unsigned head = *m_cq_head;
+    unsigned tail = std::atomic_ref<unsigned>(*m_cq_tail).load(std::memory_order_acquire);
+    io_uring_cqe* cqes = static_cast<io_uring_cqe*>(m_cqes);
+    for (; head != tail; head++) {
+        const io_uring_cqe& cqe = cqes[head & *m_cq_mask];
+        on_complete(static_cast<size_t>(cqe.user_data), cqe.res);
+    }
+    std::atomic_ref<unsigned>(*m_cq_head).store(head, std::memory_order_release);
+}
+
+// Linux transfers this many bytes at most in a read.
+static const size_t MAX_READ_SIZE = 0x7ffff000;
+
+namespace {
+
+struct FileState {
+    int fd;
+    struct statx st;
+    size_t length;
+    bool failed;
+};
+
+}  // namespace
+
+// Requests are sent in three rounds: open and statx, read, and close.
+// Each round waits for all completions of the previous one.
+void UringLoader::LoadBatch(LoadedFile* files, size_t count) {
+    std::vector<FileState> states(count);
+    size_t in_flight = 0;
+
+    // Waits for all requests. Returns false when the ring is broken.
+    auto wait_all = [this, &in_flight](auto on_complete) {
+        while (in_flight > 0) {
+            if (!SubmitAndWait(1))
+                return false;
+            ReapCompletions([&in_flight, &on_complete](size_t user_data, int res) {
+                in_flight--;
+                on_complete(user_data, res);
+            });
+        }
+        return true;
+    };
+
+    for (size_t i = 0; i < count; i++) {
+        FileState& state = states[i];
+        state.fd = -1;
+        state.length = 0;
+        state.failed = false;
+        files[i].content.clear();
+
+        io_uring_sqe* sqe = static_cast<io_uring_sqe*>(GetSqe());
+        sqe->opcode = IORING_OP_OPENAT;
+        sqe->fd = AT_FDCWD;
+        sqe->addr = reinterpret_cast<uint64_t>(files[i].path.c_str());
+        sqe->open_flags = O_RDONLY | O_CLOEXEC;
+        sqe->user_data = i * 2;
+
+        sqe = static_cast<io_uring_sqe*>(GetSqe());
+        sqe->opcode = IORING_OP_STATX;
+        sqe->fd = AT_FDCWD;
+        sqe->addr = reinterpret_cast<uint64_t>(files[i].path.c_str());
+        sqe->len = STATX_TYPE | STATX_SIZE;
+        sqe->off = reinterpret_cast<uint64_t>(&state.st);
+        sqe->user_data = i * 2 + 1;
+        in_flight += 2;
+    }
+    bool ok = wait_all([&states](size_t user_data, int res) {
+        FileState& state = states[user_data / 2];
+        if (res < 0)
+            state.failed = true;
+        else if (user_data % 2 == 0)
+            state.fd = res;
+    });
+
+    auto submit_read = [this, &files, &states, &in_flight](size_t i) {
+        std::string& content = files[i].content;
+        io_uring_sqe* sqe = static_cast<io_uring_sqe*>(GetSqe());
+        sqe->opcode = IORING_OP_READ;
+        sqe->fd = states[i].fd;
+        sqe->addr = reinterpret_cast<uint64_t>(content.data() + states[i].length);
+        sqe->len = static_cast<uint32_t>(MIN(content.size() - states[i].length, MAX_READ_SIZE));
+        sqe->off = states[i].length;
+        sqe->user_data = i;
+        in_flight++;
+    };
+
+    for (size_t i = 0; ok && i < count; i++) {
+        FileState& state = states[i];
+        // Other files (e.g. directories and pipes) are read by the check stage.
+        if (state.failed || !S_ISREG(state.st.stx_mode)) {
+            state.failed = true;
+            continue;
+        }
+        // Read one more byte to detect files that grew after statx.
+        files[i].content.resize(static_cast<size_t>(state.st.stx_size) + 1);
+        submit_read(i);
+    }
+    ok = ok && wait_all([&files, &states, &submit_read](size_t i, int res) {
+        FileState& state = states[i];
+        if (res < 0) {
+            state.failed = true;
+            return;
+        }
+        if (res == 0)
+            return;  // End of the file
+        // Reads can be short before the end. (e.g. Linux reads 0x7ffff000 bytes at most.)
+        // Read again until the end like LoadFile().
+        state.length += static_cast<size_t>(res);
+        if (state.length == files[i].content.size())
+            files[i].content.resize(files[i].content.size() * 2);
+        submit_read(i);
+    });
+
+    for (size_t i = 0; i < count; i++) {
+        FileState& state = states[i];
+        if (state.fd < 0)
+            continue;
+        if (ok) {
+            io_uring_sqe* sqe = static_cast<io_uring_sqe*>(GetSqe());
+            sqe->opcode = IORING_OP_CLOSE;
+            sqe->fd = state.fd;
+            sqe->user_data = i;
+            in_flight++;
+        } else {
+            close(state.fd);
+        }
+    }
+    ok = ok && wait_all([](size_t, int) {});
+
+    for (size_t i = 0; i < count; i++) {
+        files[i].loaded = ok && !states[i].failed;
+        files[i].content.resize(files[i].loaded ? states[i].length : 0);
+    }
+}
+
+void UringLoader::Load(std::vector<LoadedFile>* files) {
+    // Each file uses two entries for open and statx.
+    size_t batch_size = m_entries / 2;
+    for (size_t i = 0; i < files->size(); i += batch_size)
+        LoadBatch(files->data() + i, MIN(batch_size, files->size() - i));
+}
+
+#else  // CPPLINT_IO_URING
+
+UringLoader::~UringLoader() {}
+
+bool UringLoader::Init(unsigned entries) {
+    UNUSED(entries);
+    return false;
+}
+
+void* UringLoader::GetSqe() {
+    return nullptr;
+}
+
+bool UringLoader::SubmitAndWait(unsigned wait_nr) {
+    UNUSED(wait_nr);
+    return false;
+}
+
+void UringLoader::LoadBatch(LoadedFile* files, size_t count) {
+    for (size_t i = 0; i < count; i++)
+        files[i].loaded = false;
+}
+
+void UringLoader::Load(std::vector<LoadedFile>* files) {
+    LoadBatch(files->data(), files->size());
+}
+
+#endif  // CPPLINT_IO_URING
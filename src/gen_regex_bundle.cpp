@@ -0,0 +1,72 @@
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <vector>
+#include "regex_utils.h"
+#include "regex_patterns.h"
+
+// Compiles patterns in regex_patterns.h and writes them into a header
+// as serialized data. regex_utils.cpp decodes it instead of compiling patterns.
+// Usage: gen-regex-bundle <output.h>
+
+int main(int argc, char* argv[]) {
+    if (argc != 2) {
+        std::cerr << "Usage: gen-regex-bundle <output.h>" << std::endl;
+        return 1;
+    }
+
+    // Use pcre2_compile in the same way as RegexCompileBase.
+    // We can't link regex_utils.cpp since it includes the output of this program.
+    std::vector<const pcre2_code*> codes;
+    for (const RegexBundleEntry& entry : REGEX_BUNDLE_ENTRIES) {
+        int error_number;
+        PCRE2_SIZE error_offset;
+        pcre2_code* code = pcre2_compile(
+            reinterpret_cast<PCRE2_SPTR>(entry.pattern),
+            PCRE2_ZERO_TERMINATED,
+            entry.options,
+            &error_number,
+            &error_offset,
+            nullptr);
+        if (!code) {
+            std::cerr << "PCRE2 compilation failed. Offset: " << error_offset
+                << ", Error: " << error_number << ", Pattern: " << entry.pattern << std::endl;
+            return 1;
+        }
+        codes.push_back(code);
+    }
+
+    uint8_t* bytes = nullptr;
+    PCRE2_SIZE size = 0;
+    int32_t ret = pcre2_serialize_encode(codes.data(), static_cast<int32_t>(codes.size()),
+                                         &bytes, &size, nullptr);
+    if (ret < 0) {
+        std::cerr << "PCRE2 serialization failed. Error: " << ret << std::endl;
+        return 1;
+    }
+
+    std::ofstream out(argv[1], std::ios::binary);
+    out << "// Generated by gen_regex_bundle.cpp. Do not edit.\n"
+        << "#pragma once\n"
+        << "#include <cstdint>\n"
+        << "\n"
+        << "alignas(8) inline constexpr uint8_t REGEX_BUNDLE_DATA[] = {";
+    char hex[8];
+    for (PCRE2_SIZE i = 0; i < size; i++) {
+        if (i % 16 == 0)
+            out << "\n   ";
+        snprintf(hex, sizeof(hex), " 0x%02x,", bytes[i]);
+        out << hex;
+    }
+    out << "\n};\n";
+
+    pcre2_serialize_free(bytes);
+    for (const pcre2_code* code : codes)
+        pcre2_code_free(const_cast<pcre2_code*>(code));
+
+    if (!out) {
+        std::cerr << "Failed to write " << argv[1] << std::endl;
+        return 1;
+    }
+    return 0;
+}
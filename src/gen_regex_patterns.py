@@ -0,0 +1,160 @@
+"""Extract regex patterns from source files.
+
+This script collects string literals passed to RegexCompile,
+RegexJitCompile and RegexSet, and writes them into a header for
+gen_regex_bundle.cpp.
+Calls with non-literal patterns are skipped. They are compiled at runtime.
+
+Usage:
+    python gen_regex_patterns.py <output.h> <source.cpp>...
+"""
+import re
+import sys
+
+COMPILE_CALL = re.compile(r'\bRegex(?:Jit)?Compile\s*\(')
+REGEX_SET = re.compile(r'\bRegexSet(?:\s+\w+)?\s*\(\s*\{')
+RAW_STR_START = re.compile(r'(?:u8|u|U|L)?R"([^\s\\()]{0,16})\(')
+STR_START = re.compile(r'(?:u8|u|U|L)?"')
+OPTIONS = re.compile(r'\s*,\s*([A-Za-z_][A-Za-z0-9_]*(?:\s*\|\s*[A-Za-z_][A-Za-z0-9_]*)*)\s*\)')
+SIMPLE_ESCAPES = {
+    'a': '\a', 'b': '\b', 'f': '\f', 'n': '\n', 'r': '\r', 't': '\t', 'v': '\v',
+    '\\': '\\', '\'': '\'', '"': '"', '?': '?',
+}
+
+
+def skip_space(src, pos):
+    while pos < len(src):
+        if src[pos].isspace():
+            pos += 1
+        elif src.startswith('//', pos):
+            pos = src.find('\n', pos)
+            if pos < 0:
+                return len(src)
+        elif src.startswith('/*', pos):
+            pos = src.index('*/', pos) + 2
+        else:
+            break
+    return pos
+
+
+def parse_str(src, pos):
+    """Parse a string literal at pos. Returns (value, end) or (None, pos)."""
+    m = RAW_STR_START.match(src, pos)
+    if m:
+        end = src.index(')' + m.group(1) + '"', m.end())
+        return src[m.end():end], end + len(m.group(1)) + 2
+    m = STR_START.match(src, pos)
+    if not m:
+        return None, pos
+    pos = m.end()
+    value = []
+    while src[pos] != '"':
+        c = src[pos]
+        if c == '\n':
+            raise ValueError('Unterminated string literal.')
+        pos += 1
+        if c != '\\':
+            value.append(c)
+            continue
+        c = src[pos]
+        pos += 1
+        if c in SIMPLE_ESCAPES:
+            value.append(SIMPLE_ESCAPES[c])
+        elif c == 'x':
+            digits = re.match(r'[0-9a-fA-F]+', src[pos:]).group(0)
+            value.append(chr(int(digits, 16)))
+            pos += len(digits)
+        elif c in '01234567':
+            digits = re.match(r'[0-7]{1,3}', src[pos - 1:]).group(0)
+            value.append(chr(int(digits, 8)))
+            pos += len(digits) - 1
+        else:
+            raise ValueError(f'Unsupported escape sequence: \\{c}')
+    return ''.join(value), pos + 1
+
+
+def parse_concat_str(src, pos):
+    """Parse adjacent string literals. Returns (value, end) or (None, pos)."""
+    pattern = None
+    while True:
+        value, end = parse_str(src, pos)
+        if value is None:
+            break
+        pattern = value if pattern is None else pattern + value
+        pos = skip_space(src, end)
+    return pattern, pos
+
+
+def extract_patterns(src):
+    """Yield (pattern, options) of compile calls that use literal patterns."""
+    for m in COMPILE_CALL.finditer(src):
+        pattern, pos = parse_concat_str(src, skip_space(src, m.end()))
+        if pattern is None:
+            continue
+        if src[pos] == ')':
+            yield pattern, 'REGEX_OPTIONS_DEFAULT'
+            continue
+        m = OPTIONS.match(src, pos)
+        if m:
+            yield pattern, re.sub(r'\s+', ' ', m.group(1))
+
+    # RegexSet compiles each pattern with the default options.
+    for m in REGEX_SET.finditer(src):
+        pos = skip_space(src, m.end())
+        while True:
+            pattern, pos = parse_concat_str(src, pos)
+            if pattern is None:
+                break
+            yield pattern, 'REGEX_OPTIONS_DEFAULT'
+            if src[pos] != ',':
+                break
+            pos = skip_space(src, pos + 1)
+
+
+def to_c_str(value):
+    out = ['"']
+    for byte in value.encode('utf-8'):
+        c = chr(byte)
+        if c in '"\\':
+            out.append('\\' + c)
+        elif 0x20 <= byte < 0x7f:
+            out.append(c)
+        else:
+            out.append(f'\\{byte:03o}')
+    out.append('"')
+    return ''.join(out)
+
+
+def main(argv):
+    if len(argv) < 3:
+        print(__doc__)
+        return 1
+    patterns = set()
+    for path in argv[2:]:
+        with open(path, encoding='utf-8') as f:
+            patterns.update(extract_patterns(f.read()))
+
+    # Sort patterns to make the output reproducible.
+    # It also puts the same patterns with different options next to each other.
+    lines = [
+        '// Generated by gen_regex_patterns.py. Do not edit.',
+        '#pragma once',
+        '#include "regex_utils.h"',
+        '',
+        'struct RegexBundleEntry {',
+        '    const char* pattern;',
+        '    uint32_t options;',
+        '};',
+        '',
+        'inline constexpr RegexBundleEntry REGEX_BUNDLE_ENTRIES[] = {',
+    ]
+    for pattern, options in sorted(patterns):
+        lines.append(f'    {{ {to_c_str(pattern)}, {options} }},')
+    lines += ['};', '']
+    with open(argv[1], 'w', encoding='utf-8', newline='\n') as f:
+        f.write('\n'.join(lines))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))
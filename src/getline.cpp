@@ -59,7 +59,8 @@ static inline void ResizeBuffer(std::string* buffer, char** buf_p,
     }
 }
 
-std::string GetLine(std::istream& stream, std::string* buffer, int* status) {
+// Reads a line into buffer and returns its length.
+static size_t ReadLine(std::istream& stream, std::string* buffer, int* status) {
     *status = LINE_OK;
     int c = 0;
     unsigned char rune[4];
@@ -72,12 +73,12 @@ std::string GetLine(std::istream& stream, std::string* buffer, int* status) {
 
         if (c == EOF) {
             *status |= LINE_EOF;
-            return std::string(buffer->data(), length);
+            return length;
         } else if (c <= ASCII_MAX) {
             // ascii
             if (c == '\n') {
                 // a line found
-                return std::string(buffer->data(), length);
+                return length;
             } else if (c == '\0') {
                 ResizeBuffer(buffer, &buf_p, length, 3);
                 // replace null byte with a bad rune
@@ -137,9 +138,19 @@ std::string GetLine(std::istream& stream, std::string* buffer, int* status) {
         }
     }
 
+    return length;
+}
+
+std::string GetLine(std::istream& stream, std::string* buffer, int* status) {
+    size_t length = ReadLine(stream, buffer, status);
     return std::string(buffer->data(), length);
 }
 
+void GetLine(std::istream& stream, std::string* buffer, std::string* line, int* status) {
+    size_t length = ReadLine(stream, buffer, status);
+    line->assign(buffer->data(), length);
+}
+
 /* An inclusive range of characters. */
 struct uint32_range {
   uint32_t lo;
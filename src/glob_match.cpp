@@ -9,7 +9,6 @@
 // https://github.com/p-ranav/glob/blob/master/source/glob.cpp
 
 static constexpr auto SPECIAL_CHARACTERS = std::string_view{"()[]{}?*+-|^$\\.&~# \t\n\r\v\f"};
-static const auto ESCAPE_SET_OPER = RegexCompile(R"([&~|])");
 static const auto ESCAPE_REPL_STR = std::string{R"(\\\1)"};
 
 static bool string_replace(std::string &str, std::string_view from, std::string_view to) {
@@ -99,6 +98,7 @@ static std::string translate(std::string_view pattern, bool match_with_parent) {
                 }
 
                 // Escape set operations (&&, ~~ and ||).
+                static const regex_code ESCAPE_SET_OPER = RegexCompile(R"([&~|])");
                 RegexReplace(ESCAPE_SET_OPER, ESCAPE_REPL_STR, stuff);
                 i = j + 1;
                 if (stuff[0] == '!') {
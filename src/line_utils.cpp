@@ -19,7 +19,10 @@ size_t GetIndentLevel(const std::string& line) {
     return 0;
 }
 
-const regex_code RE_PATTERN_OPERATOR = RegexCompile(R"(\boperator\s*$)");
+static const regex_code& GetOperatorPattern() {
+    static const regex_code RE_PATTERN_OPERATOR = RegexCompile(R"(\boperator\s*$)");
+    return RE_PATTERN_OPERATOR;
+}
 
 void FindEndOfExpressionInLine(const std::string& line,
                                size_t* startpos,
@@ -40,7 +43,7 @@ void FindEndOfExpressionInLine(const std::string& line,
                         return;
                     }
                 }
-            } else if (i > 0 && RegexSearchWithRange(RE_PATTERN_OPERATOR, line, 0, i)) {
+            } else if (i > 0 && RegexSearchWithRange(GetOperatorPattern(), line, 0, i)) {
                 // operator<, don't add to stack
                 continue;
             } else {
@@ -77,7 +80,7 @@ void FindEndOfExpressionInLine(const std::string& line,
 
             // Ignore "->" and operator functions
             if (i > 0 &&
-                (line[i - 1] == '-' || RegexSearchWithRange(RE_PATTERN_OPERATOR, line, 0, i - 1)))
+                (line[i - 1] == '-' || RegexSearchWithRange(GetOperatorPattern(), line, 0, i - 1)))
                 continue;
 
             // Pop the stack if there is a matching '<'.  Otherwise, ignore
@@ -164,7 +167,7 @@ void FindStartOfExpressionInLine(const std::string& line,
             if (i > 0 &&
                 (line[i - 1] == '-' ||
                  RegexMatch(R"(\s>=\s)", line.substr(i - 1)) ||
-                 RegexSearchWithRange(RE_PATTERN_OPERATOR, line, 0, i)))
+                 RegexSearchWithRange(GetOperatorPattern(), line, 0, i)))
                 i--;
             else
                 stack->push('>');
@@ -247,7 +250,7 @@ const std::string& ReverseCloseExpression(const CleansedLines& clean_lines,
     }
 
     // Continue scanning backward
-    while (!stack.empty() && *linenum > 0) {
+    while (!stack.empty() && *linenum > clean_lines.FirstLine()) {
         (*linenum)--;
         const std::string& l = clean_lines.GetElidedAt(*linenum);
         start_pos = l.size() - 1;
@@ -261,10 +264,10 @@ const std::string& ReverseCloseExpression(const CleansedLines& clean_lines,
     // Did not find start of expression before beginning of file, give up
     *linenum = 0;
     *pos = INDEX_NONE;
-    return clean_lines.GetElidedAt(*linenum);
+    return clean_lines.GetElidedAt(clean_lines.FirstLine());
 }
 
-bool IsCppString(const std::string& line) {
+bool IsCppString(std::string_view line) {
     int count = 0;
     bool escape = false;
     bool inside_char = false;
@@ -1,6 +1,8 @@
 #include "nest_info.h"
+#include <algorithm>
 #include <string>
 #include <string_view>
+#include <vector>
 #include "cleanse.h"
 #include "file_linter.h"
 #include "line_utils.h"
@@ -37,16 +39,8 @@ ClassInfo::ClassInfo(const std::string& name,
     //   } *x = { ...
     //
     // But it's still good enough for CheckSectionSpacing.
-    m_last_line = 0;
-    int depth = 0;
-    for (size_t i = linenum; i < clean_lines.NumLines(); i++) {
-        const std::string& line = clean_lines.GetElidedAt(i);
-        depth += StrCount(line, "{") - StrCount(line, "}");
-        if (depth == 0) {
-            m_last_line = i;
-            break;
-        }
-    }
+    size_t block_end = clean_lines.GetBlockEnd(linenum);
+    m_last_line = (block_end == INDEX_NONE) ? 0 : block_end;
 }
 
 void ClassInfo::CheckBegin(const CleansedLines& clean_lines,
@@ -64,25 +58,28 @@ void ClassInfo::CheckEnd(const CleansedLines& clean_lines,
                          FileLinter* file_linter) {
     // If there is a DISALLOW macro, it should appear near the end of
     // the class.
-    bool seen_last_thing_in_class = false;
-    for (size_t i = linenum - 1; i > m_starting_linenum; i--) {
+    // Lines with "DISALLOW_" are indexed, so we don't scan all lines in the class.
+    const std::vector<size_t>& disallow_lines = clean_lines.GetDisallowLines();
+    auto it = std::lower_bound(disallow_lines.begin(), disallow_lines.end(), linenum);
+    while (it != disallow_lines.begin()) {
+        --it;
+        size_t i = *it;
+        if (i <= m_starting_linenum)
+            break;
         const std::string& elided = clean_lines.GetElidedAt(i);
-        if (StrContain(elided, "DISALLOW_")) {
-            bool match = RegexSearch(
-                            R"(\b(DISALLOW_COPY_AND_ASSIGN|DISALLOW_IMPLICIT_CONSTRUCTORS)\()" +
-                            RegexEscape(m_name) + R"(\))",
-                            elided, m_re_result);
-            if (match) {
-                if (seen_last_thing_in_class)
-                    file_linter->Error(i, "readability/constructors", 3,
-                                    GetMatchStr(m_re_result, elided, 1) +
-                                    " should be the last thing in the class");
-                break;
-            }
+        bool match = RegexSearch(
+                        R"(\b(DISALLOW_COPY_AND_ASSIGN|DISALLOW_IMPLICIT_CONSTRUCTORS)\()" +
+                        RegexEscape(m_name) + R"(\))",
+                        elided, m_re_result);
+        if (match) {
+            size_t last_thing = clean_lines.GetPrevNonBlankLine(linenum);
+            bool seen_last_thing_in_class = last_thing != INDEX_NONE && last_thing > i;
+            if (seen_last_thing_in_class)
+                file_linter->Error(i, "readability/constructors", 3,
+                                GetMatchStr(m_re_result, elided, 1) +
+                                " should be the last thing in the class");
+            break;
         }
-
-        if (!StrIsBlank(elided))
-            seen_last_thing_in_class = true;
     }
 
     // Check that closing brace is aligned with beginning of the class.
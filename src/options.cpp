@@ -1,6 +1,8 @@
 #include "options.h"
 #include <algorithm>
 #include <cassert>
+#include <cstdint>
+#include <cstdlib>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
@@ -8,12 +10,16 @@
 #include <mutex>
 #include <set>
 #include <string>
+#include <string_view>
 #include <thread>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 #include "cpplint_state.h"
+#include "error_categories.h"
 #include "error_suppressions.h"
 #include "glob_match.h"
+#include "profiler.h"
 #include "regex_utils.h"
 #include "string_utils.h"
 #include "version.h"
@@ -21,7 +27,8 @@
 namespace fs = std::filesystem;
 
 static const char* USAGE[] = {
-    "Syntax: cpplint.cpp [--verbose=#] [--output=emacs|eclipse|vs7|junit|sed|gsed]\n"
+    "Syntax: cpplint.cpp [--verbose=#]\n"
+    "                    [--output=emacs|eclipse|vs7|junit|sed|gsed|sarif|ndjson|binary]\n"
     "                    [--filter=-x,+y,...]\n"
     "                    [--counting=total|toplevel|detailed] [--root=subdir]\n"
     "                    [--repository=path]\n"
@@ -34,8 +41,12 @@ static const char* USAGE[] = {
     "                    [--quiet]\n"
     "                    [--version]\n"
     "                    [--build]\n"
-    "                    [--timing]\n"
+    "                    [--timing] [--profile[=N]]\n"
     "                    [--threads=#]\n"
+    "                    [--shard=i/N] [--shard-summary=path]\n"
+    "                    [--file-list=path] [--compile-commands=path]\n"
+    "                    [--watch]\n"
+    "                    [--max-memory=size]\n"
     "                    <file> [file] ...\n"
     "\n"
     "  Style checker for C/C++ source files.\n"
@@ -63,7 +74,7 @@ static const char* USAGE[] = {
     "\n"
     "  Flags:\n"
     "\n"
-    "    output=emacs|eclipse|vs7|junit|sed|gsed\n"
+    "    output=emacs|eclipse|vs7|junit|sed|gsed|sarif|ndjson|binary\n"
     "      By default, the output is formatted to ease emacs parsing.  Visual Studio\n"
     "      compatible output (vs7) may also be used.  Further support exists for\n"
     "      eclipse (eclipse), and JUnit (junit). XML parsers such as those used\n"
@@ -73,6 +84,11 @@ static const char* USAGE[] = {
     "      system (common e.g. on macOS with homebrew) you can use the gsed output\n"
     "      format. Sed commands are written to stdout, not stderr, so you should be\n"
     "      able to pipe output straight to a shell to run the fixes.\n"
+    "      The sarif format outputs a SARIF 2.1.0 log for code scanning services,\n"
+    "      and the ndjson format outputs a JSON object per line for each error.\n"
+    "      The binary format outputs compact records that cpplint-report can\n"
+    "      merge and convert to other formats.\n"
+    "      They are also written to stdout.\n"
     "\n"
     "    verbose=#\n"
     "      Specify a number 0-5 to restrict errors to certain verbosity levels.\n"
@@ -211,6 +227,11 @@ static const char* USAGE[] = {
     "    timing\n"
     "      Display elapsed processing time.\n"
     "\n"
+    "    profile[=N]\n"
+    "      Display cumulative time and call counts of each check, and the N\n"
+    "      slowest files (10 by default). cpplint-cpp should be built with\n"
+    "      -Dprofiler=true to use this option.\n"
+    "\n"
     "    threads=#\n"
     "      Specify a number of threads for multithreading.\n"
     "      You can use 0 or -1 for using all available threads."
@@ -218,6 +239,45 @@ static const char* USAGE[] = {
     "      To see the number of available threads, pass no arg:\n"
     "         --threads=\n"
     "\n"
+    "    shard=i/N\n"
+    "      Split files into N shards and lint only the i-th shard (0 <= i < N).\n"
+    "      Files are distributed by their sizes. Every shard gets the same files\n"
+    "      as long as the same files are passed to all processes.\n"
+    "      Files from --file-list and --compile-commands are distributed by hashes\n"
+    "      of their paths relative to --repository or the current directory.\n"
+    "\n"
+    "      Examples:\n"
+    "        --shard=0/4\n"
+    "        --shard=3/4\n"
+    "\n"
+    "    file-list=path\n"
+    "      Lint files listed in a text file, one path per line. Use - to read the\n"
+    "      list from stdin. Files are linted as soon as they are read.\n"
+    "\n"
+    "    compile-commands=path\n"
+    "      Lint source files listed in a compilation database\n"
+    "      (compile_commands.json). Files are linted as soon as they are read.\n"
+    "\n"
+    "    shard-summary=path\n"
+    "      Write error counts by category to a file. Summaries of all shards can\n"
+    "      be merged with \"cpplint-report --summary\".\n"
+    "\n"
+    "    watch\n"
+    "      Lint files once, then keep running and lint files again when they are\n"
+    "      saved. Only new and resolved errors are printed for each change.\n"
+    "      Sources are also linted again when their headers are added or removed.\n"
+    "      It's only available on Linux.\n"
+    "\n"
+    "    max-memory=size\n"
+    "      Limit memory used by files being linted at once. The size is in bytes,\n"
+    "      or with a K, M, or G suffix. Each file is estimated from its size, and\n"
+    "      waits until the others free enough memory. A file larger than the limit\n"
+    "      is linted alone. --timing displays the high-water mark.\n"
+    "\n"
+    "      Examples:\n"
+    "        --max-memory=512M\n"
+    "        --max-memory=2G\n"
+    "\n"
     "    cpplint.py supports per-directory configurations specified in CPPLINT.cfg\n"
     "    files. CPPLINT.cfg file can contain a number of key=value pairs.\n"
     "    Currently the following options are supported:\n"
@@ -301,7 +361,8 @@ static void PrintVersion() {
 static void PrintBuildConfig() {
     std::cout << "platform tag: " << PLATFORM_TAG << "\n"
                  "build type: " << BUILD_TYPE << "\n"
-                 "jit support: " << JIT_SUPPORT << "\n";
+                 "jit support: " << JIT_SUPPORT << "\n"
+                 "profiler: " << PROFILER_SUPPORT << "\n";
     exit(0);
 }
 
@@ -347,6 +408,27 @@ static size_t ArgToUintValue(const std::string& arg) {
     return StrToUint(val);
 }
 
+// Parses a size with an optional K, M, or G suffix. (e.g. 512M)
+// Returns INDEX_NONE for invalid values.
+static size_t ArgToMemorySize(const std::string& arg) {
+    std::string val = ArgToValue(arg);
+    size_t shift = 0;
+    if (val.ends_with('K') || val.ends_with('k'))
+        shift = 10;
+    else if (val.ends_with('M') || val.ends_with('m'))
+        shift = 20;
+    else if (val.ends_with('G') || val.ends_with('g'))
+        shift = 30;
+    if (shift > 0)
+        val.pop_back();
+    if (val.empty())
+        return INDEX_NONE;
+    size_t size = StrToUint(val);
+    if (size == INDEX_NONE || size > (INDEX_MAX >> shift))
+        return INDEX_NONE;
+    return size << shift;
+}
+
 std::vector<fs::path> Options::ParseArguments(int argc, char** argv,
                                               CppLintState* cpplint_state) {
     int verbosity = cpplint_state->VerboseLevel();
@@ -357,6 +439,8 @@ std::vector<fs::path> Options::ParseArguments(int argc, char** argv,
     std::vector<GlobPattern> excludes = {};
     int num_threads = -1;
     m_filters = DEFAULT_FILTERS;
+    m_excludes.clear();
+    m_recursive_dirs.clear();
 
     char** argp = argv + 1;
     // parse "--*" options
@@ -375,9 +459,10 @@ std::vector<fs::path> Options::ParseArguments(int argc, char** argv,
             if (output_format == "junit") {
                 PrintUsage("Sorry, cpplint.cpp does not support junit yet.");
             }
-            if (!InStrVec({ "emacs", "vs7", "eclipse", "junit", "sed", "gsed" }, output_format)) {
+            if (!InStrVec({ "emacs", "vs7", "eclipse", "junit", "sed", "gsed",
+                            "sarif", "ndjson", "binary" }, output_format)) {
                 PrintUsage("The only allowed output formats are "
-                           "emacs, vs7, eclipse, sed, gsed and junit.");
+                           "emacs, vs7, eclipse, sed, gsed, sarif, ndjson, binary and junit.");
             }
         } else if (opt == "--quiet") {
             quiet = true;
@@ -416,9 +501,9 @@ std::vector<fs::path> Options::ParseArguments(int argc, char** argv,
         } else if (opt.starts_with("--exclude=")) {
             std::string val = ArgToValue(opt);
             if (val != "") {
-                excludes.emplace_back(
-                    fs::weakly_canonical(fs::absolute(val)).make_preferred().string(),
-                    true);
+                m_excludes.emplace_back(
+                    fs::weakly_canonical(fs::absolute(val)).make_preferred().string());
+                excludes.emplace_back(m_excludes.back(), true);
             }
         } else if (opt.starts_with("--extensions=")) {
             ProcessExtensionsOption(ArgToValue(opt));
@@ -434,6 +519,19 @@ std::vector<fs::path> Options::ParseArguments(int argc, char** argv,
                 PrintUsage("Config file name must not include directory components.");
         } else if (opt == "--timing") {
             m_timing = true;
+        } else if (opt == "--profile" || opt.starts_with("--profile=")) {
+            size_t num_slowest_files = 10;
+            if (opt != "--profile") {
+                num_slowest_files = ArgToUintValue(opt);
+                if (num_slowest_files == INDEX_NONE)
+                    PrintUsage("Number of files should be an integer. (" + opt + ")");
+            }
+#ifdef CPPLINT_PROFILE
+            m_profile = true;
+            ProfilerEnable(num_slowest_files);
+#else
+            PrintUsage("Profiler is disabled. Build cpplint-cpp with -Dprofiler=true.");
+#endif
         } else if (opt.starts_with("--threads=")) {
             std::string val = ArgToValue(opt);
             if (val.empty())
@@ -443,6 +541,39 @@ std::vector<fs::path> Options::ParseArguments(int argc, char** argv,
                 if (num_threads < 1)
                     PrintUsage("Number of threads should be a positive integer. (" + opt+ ")");
             }
+        } else if (opt.starts_with("--shard=")) {
+            std::string val = ArgToValue(opt);
+            if (!StrContain(val, "/"))
+                PrintUsage("Shard should be the i/N format. (" + opt + ")");
+            m_shard_index = StrToUint(StrBeforeChar(val, '/'));
+            m_shard_count = StrToUint(StrAfterChar(val, '/'));
+            if (m_shard_count == INDEX_NONE || m_shard_count == 0 ||
+                m_shard_index >= m_shard_count) {
+                PrintUsage("Shard index should be less than the number of shards. (" +
+                           opt + ")");
+            }
+        } else if (opt.starts_with("--file-list=")) {
+            m_file_list = ArgToValue(opt);
+            if (m_file_list != "-" && !fs::is_regular_file(m_file_list))
+                PrintUsage("File list does not exist. (" + opt + ")");
+        } else if (opt.starts_with("--compile-commands=")) {
+            m_compile_commands = ArgToValue(opt);
+            if (!fs::is_regular_file(m_compile_commands))
+                PrintUsage("Compilation database does not exist. (" + opt + ")");
+        } else if (opt.starts_with("--shard-summary=")) {
+            m_shard_summary = ArgToValue(opt);
+            if (m_shard_summary.empty())
+                PrintUsage("Shard summary requires a file path. (" + opt + ")");
+        } else if (opt == "--watch") {
+#ifdef __linux__
+            m_watch = true;
+#else
+            PrintUsage("--watch is only available on Linux.");
+#endif
+        } else if (opt.starts_with("--max-memory=")) {
+            m_max_memory = ArgToMemorySize(opt);
+            if (m_max_memory == INDEX_NONE || m_max_memory == 0)
+                PrintUsage("Memory size should be a positive integer. (" + opt + ")");
         } else {
             PrintUsage("Invalid arguments. (" + opt + ")");
         }
@@ -458,12 +589,29 @@ std::vector<fs::path> Options::ParseArguments(int argc, char** argv,
             cpplint_state->PrintError("Skipping input '" + p.string() + "': Path not found.");
             continue;
         }
-        filenames.emplace_back(fs::canonical(p).make_preferred());
+        if (p == "-")
+            filenames.emplace_back(p);
+        else
+            filenames.emplace_back(fs::canonical(p).make_preferred());
     }
 
-    if (filenames.size() == 0)
+    if (filenames.size() == 0 && m_file_list.empty() && m_compile_commands.empty())
         PrintUsage("No files were specified.");
 
+    if (m_watch) {
+        if (InStrVec({ "junit", "sarif", "binary" }, output_format))
+            PrintUsage("--watch does not support --output=" + output_format + ".");
+        if (m_file_list == "-" ||
+            std::find(filenames.begin(), filenames.end(), "-") != filenames.end())
+            PrintUsage("--watch can not read files from stdin.");
+        if (recursive) {
+            for (const fs::path& f : filenames) {
+                if (fs::is_directory(f))
+                    m_recursive_dirs.push_back(f);
+            }
+        }
+    }
+
     if (recursive)
         filenames = ExpandDirectories(filenames);
 
@@ -479,13 +627,52 @@ std::vector<fs::path> Options::ParseArguments(int argc, char** argv,
     cpplint_state->SetVerboseLevel(verbosity);
     cpplint_state->SetCountingStyle(counting_style);
     cpplint_state->SetNumThreads(num_threads);
+    cpplint_state->SetShardSummary(!m_shard_summary.empty());
 
     // sort filenames
     std::sort(filenames.begin(), filenames.end());
     filenames.erase(std::unique(filenames.begin(), filenames.end()), filenames.end());
+
+    m_command_line_files = filenames;
+    if (m_shard_count > 1)
+        filenames = SelectShardFiles(filenames);
     return filenames;
 }
 
+std::vector<fs::path> Options::SelectShardFiles(const std::vector<fs::path>& filenames) {
+    std::vector<std::pair<uintmax_t, size_t>> sizes;
+    sizes.reserve(filenames.size());
+    for (size_t i = 0; i < filenames.size(); i++) {
+        std::error_code ec;
+        uintmax_t size = fs::file_size(filenames[i], ec);
+        if (ec)
+            size = 0;  // e.g. stdin
+        sizes.emplace_back(size, i);
+    }
+
+    // Assign the largest file to the least loaded shard.
+    // Files with the same size are sorted by their paths.
+    std::stable_sort(sizes.begin(), sizes.end(),
+                     [](const auto& a, const auto& b) { return a.first > b.first; });
+    std::vector<uintmax_t> loads(m_shard_count, 0);
+    std::vector<size_t> selected;
+    for (const auto& [size, id] : sizes) {
+        size_t shard = TO_SIZE(std::min_element(loads.begin(), loads.end()) - loads.begin());
+        // Count an empty file as one byte to distribute small files.
+        loads[shard] += MAX(size, 1);
+        if (shard == m_shard_index)
+            selected.push_back(id);
+    }
+
+    // Keep the sorted order
+    std::sort(selected.begin(), selected.end());
+    std::vector<fs::path> shard_files;
+    shard_files.reserve(selected.size());
+    for (size_t id : selected)
+        shard_files.push_back(filenames[id]);
+    return shard_files;
+}
+
 void Options::ProcessExtensionsOption(const std::string& val) {
     m_valid_extensions = ParseCommaSeparetedList(val);
 }
@@ -529,6 +716,284 @@ std::vector<fs::path> Options::FilterExcludedFiles(std::vector<fs::path> filenam
     return filenames;
 }
 
+bool Options::IsExcluded(const fs::path& file) const {
+    std::vector<GlobPattern> excludes;
+    for (const std::string& exclude : m_excludes)
+        excludes.emplace_back(exclude, true);
+    return ShouldBeExcluded(file, excludes);
+}
+
+FileListReader::FileListReader(const Options& options, CppLintState* cpplint_state) :
+        m_options(options),
+        m_cpplint_state(cpplint_state),
+        m_excludes(),
+        m_seen({}),
+        m_shard_root() {
+    for (const std::string& exclude : options.Excludes())
+        m_excludes.emplace_back(exclude, true);
+    // Paths from the command line are canonicalized by ParseArguments().
+    for (const fs::path& filename : options.CommandLineFiles())
+        m_seen.insert(filename.string());
+
+    // Absolute paths differ between machines, so they are hashed from a common root.
+    std::error_code ec;
+    fs::path root = options.Repository().empty() ? fs::current_path(ec) : options.Repository();
+    m_shard_root = fs::weakly_canonical(root, ec);
+}
+
+// FNV-1a hash. std::hash is not stable across platforms.
+static uint32_t HashPath(const std::string& path) {
+    uint32_t hash = 2166136261u;
+    for (const char c : path) {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+void FileListReader::AddFile(const std::string& file, const fs::path& directory,
+                             const Callback& callback) {
+    fs::path p = file;
+    if (p.is_relative() && !directory.empty())
+        p = directory / p;
+    std::error_code ec;
+    p = fs::canonical(p, ec);
+    if (ec) {
+        m_cpplint_state->PrintError("Skipping input '" + file + "': Path not found.\n");
+        return;
+    }
+    p.make_preferred();
+
+    if (ShouldBeExcluded(p, m_excludes))
+        return;
+    if (!m_seen.insert(p.string()).second)
+        return;  // e.g. a file compiled with multiple configurations
+
+    if (m_options.ShardCount() > 1) {
+        // Hash canonical paths, so a file listed with different spellings
+        // goes to the same shard on every machine.
+        std::string relative = p.lexically_relative(m_shard_root).generic_string();
+        if (relative.empty())
+            relative = p.generic_string();  // e.g. on another drive
+        if (HashPath(relative) % m_options.ShardCount() != m_options.ShardIndex())
+            return;
+    }
+    callback(p);
+}
+
+void FileListReader::ReadFileList(std::istream& stream, const Callback& callback) {
+    std::string line;
+    while (std::getline(stream, line)) {
+        std::string file = StrStrip(line);
+        if (!file.empty())
+            AddFile(file, "", callback);
+    }
+}
+
+// A tiny JSON reader for compilation databases.
+// It reads a stream character by character, so it doesn't need to
+// load the whole database.
+class JsonStream {
+ private:
+    std::istream& m_stream;
+    bool m_failed;
+
+ public:
+    explicit JsonStream(std::istream& stream) : m_stream(stream), m_failed(false) {}
+
+    bool Failed() const { return m_failed; }
+    bool Fail() {
+        m_failed = true;
+        return false;
+    }
+
+    // Returns the next non-space character without consuming it.
+    int Peek() {
+        while (IS_SPACE(m_stream.peek()))
+            m_stream.get();
+        return m_stream.peek();
+    }
+
+    // Consumes the next non-space character if it's c.
+    bool Consume(char c) {
+        if (Peek() != c)
+            return false;
+        m_stream.get();
+        return true;
+    }
+
+    // Reads XXXX of \uXXXX.
+    bool ReadHex4(uint32_t* code) {
+        char hex[5] = {};
+        if (!m_stream.read(hex, 4))
+            return false;
+        for (int i = 0; i < 4; i++) {
+            if (!isxdigit(static_cast<uint8_t>(hex[i])))
+                return false;
+        }
+        *code = static_cast<uint32_t>(std::strtoul(hex, nullptr, 16));
+        return true;
+    }
+
+    // Reads \uXXXX after the backslash and appends the character as UTF-8.
+    // Characters out of the BMP are escaped as surrogate pairs. (e.g. \uD83D\uDE00)
+    bool ReadUnicodeEscape(std::string* str) {
+        uint32_t code;
+        if (!ReadHex4(&code))
+            return false;
+        if (code >= 0xDC00 && code <= 0xDFFF)
+            return false;  // Unpaired low surrogate
+        if (code >= 0xD800 && code <= 0xDBFF) {
+            uint32_t low;
+            if (m_stream.get() != '\\' || m_stream.get() != 'u' ||
+                !ReadHex4(&low) || low < 0xDC00 || low > 0xDFFF)
+                return false;  // Unpaired high surrogate
+            code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+        }
+
+        if (code < 0x80) {
+            str->push_back(static_cast<char>(code));
+        } else if (code < 0x800) {
+            str->push_back(static_cast<char>(0xC0 | (code >> 6)));
+            str->push_back(static_cast<char>(0x80 | (code & 0x3F)));
+        } else if (code < 0x10000) {
+            str->push_back(static_cast<char>(0xE0 | (code >> 12)));
+            str->push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+            str->push_back(static_cast<char>(0x80 | (code & 0x3F)));
+        } else {
+            str->push_back(static_cast<char>(0xF0 | (code >> 18)));
+            str->push_back(static_cast<char>(0x80 | ((code >> 12) & 0x3F)));
+            str->push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+            str->push_back(static_cast<char>(0x80 | (code & 0x3F)));
+        }
+        return true;
+    }
+
+    bool ReadString(std::string* str) {
+        if (!Consume('"'))
+            return Fail();
+        str->clear();
+        while (true) {
+            int c = m_stream.get();
+            if (c == EOF)
+                return Fail();
+            if (c == '"')
+                return true;
+            if (c != '\\') {
+                str->push_back(static_cast<char>(c));
+                continue;
+            }
+            c = m_stream.get();
+            switch (c) {
+                case 'b': str->push_back('\b'); break;
+                case 'f': str->push_back('\f'); break;
+                case 'n': str->push_back('\n'); break;
+                case 'r': str->push_back('\r'); break;
+                case 't': str->push_back('\t'); break;
+                case 'u':
+                    if (!ReadUnicodeEscape(str))
+                        return Fail();
+                    break;
+                case EOF: return Fail();
+                default: str->push_back(static_cast<char>(c));  // '"', '\\', and '/'
+            }
+        }
+    }
+
+    // Skips any value including nested arrays and objects.
+    bool SkipValue() {
+        int c = Peek();
+        std::string str;
+        if (c == '"')
+            return ReadString(&str);
+        if (c == '[' || c == '{') {
+            char close = (c == '[') ? ']' : '}';
+            m_stream.get();
+            if (Consume(close))
+                return true;
+            do {
+                if (close == '}' && (!ReadString(&str) || !Consume(':')))
+                    return Fail();
+                if (!SkipValue())
+                    return false;
+            } while (Consume(','));
+            return Consume(close) || Fail();
+        }
+        // numbers, true, false, and null
+        bool has_value = false;
+        while (c != EOF && c != ',' && c != ']' && c != '}' && !IS_SPACE(c)) {
+            m_stream.get();
+            c = m_stream.peek();
+            has_value = true;
+        }
+        return has_value || Fail();
+    }
+};
+
+void FileListReader::ReadCompileCommands(std::istream& stream, const Callback& callback) {
+    // The database is an array of objects like this.
+    // { "directory": "/path/to/build", "file": "main.cpp", "command": "..." }
+    JsonStream json(stream);
+    std::string key;
+    std::string directory;
+    std::string file;
+    if (json.Consume('[') && !json.Consume(']')) {
+        do {
+            if (!json.Consume('{')) {
+                json.Fail();
+                break;
+            }
+            directory.clear();
+            file.clear();
+            if (!json.Consume('}')) {
+                do {
+                    if (!json.ReadString(&key) || !json.Consume(':'))
+                        break;
+                    if (key == "directory")
+                        json.ReadString(&directory);
+                    else if (key == "file")
+                        json.ReadString(&file);
+                    else
+                        json.SkipValue();
+                } while (!json.Failed() && json.Consume(','));
+                if (json.Failed() || !json.Consume('}')) {
+                    json.Fail();
+                    break;
+                }
+            }
+            if (file.empty()) {
+                json.Fail();  // "file" is required
+                break;
+            }
+            AddFile(file, directory, callback);
+        } while (json.Consume(','));
+        if (!json.Failed() && !json.Consume(']'))
+            json.Fail();
+    } else if (json.Peek() != EOF) {
+        json.Fail();
+    }
+
+    if (json.Failed()) {
+        m_cpplint_state->PrintError("Failed to parse compilation database: " +
+                                    m_options.CompileCommands() + "\n");
+    }
+}
+
+void FileListReader::Read(const Callback& callback) {
+    if (!m_options.FileList().empty()) {
+        if (m_options.FileList() == "-") {
+            ReadFileList(std::cin, callback);
+        } else {
+            std::ifstream stream(m_options.FileList());
+            ReadFileList(stream, callback);
+        }
+    }
+    if (!m_options.CompileCommands().empty()) {
+        std::ifstream stream(m_options.CompileCommands());
+        ReadCompileCommands(stream, callback);
+    }
+}
+
 static void ExpandDirectoriesRec(const fs::path& root,
                           std::vector<fs::path>& filtered,
                           const std::set<std::string>& extensions) {
@@ -699,8 +1164,14 @@ CfgFile* GetCfg(const fs::path& file, CppLintState* cpplint_state) {
     return cfg;
 }
 
+void ForgetCfg(const fs::path& file) {
+    std::lock_guard<std::mutex> lock(g_cfg_mtx);
+    g_cfg_map.erase(file);
+}
+
 bool Options::ProcessConfigOverrides(const fs::path& filename,
                                      CppLintState* cpplint_state) {
+    PROFILE_SCOPE("ProcessConfigOverrides");
     fs::path path = filename;
     bool noparent = false;
     while (!noparent) {
@@ -774,6 +1245,14 @@ bool Options::AddFilters(const std::string& filters) {
     return ParseCommaSeparetedFilters(filters, m_filters);
 }
 
+void Filter::MatchCategories() {
+    m_categories.reset();
+    for (size_t i = 0; i < NUM_ERROR_CATEGORIES; i++) {
+        if (std::string_view(ERROR_CATEGORIES[i]).starts_with(m_category))
+            m_categories.set(i);
+    }
+}
+
 void Filter::ParseFilterSelector(const std::string& filter) {
     /*Parses the given command line parameter for file- and line-specific
     exclusions.
@@ -820,7 +1299,7 @@ void Filter::ParseFilterSelector(const std::string& filter) {
     return;
 }
 
-bool Options::ShouldPrintError(const std::string& category,
+bool Options::ShouldPrintError(ErrorCategory category,
                                const std::string& filename, size_t linenum) const {
     bool is_filtered = false;
     for (const Filter& filter : Filters()) {
@@ -831,3 +1310,21 @@ bool Options::ShouldPrintError(const std::string& category,
     }
     return !is_filtered;
 }
+
+void Options::FilterCategories(const std::string& filename,
+                               ErrorCategorySet* filtered,
+                               ErrorCategorySet* line_specific) const {
+    filtered->reset();
+    line_specific->reset();
+    for (const Filter& filter : Filters()) {
+        if (!filter.IsMatchedFile(filename))
+            continue;
+        if (filter.Linenum() != INDEX_NONE) {
+            *line_specific |= filter.Categories();
+        } else if (filter.IsPositive()) {
+            *filtered &= ~filter.Categories();
+        } else {
+            *filtered |= filter.Categories();
+        }
+    }
+}
@@ -0,0 +1,281 @@
+#include "pipeline.h"
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <filesystem>
+#include <future>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+#include "common.h"
+#include "cpplint_state.h"
+#include "file_loader.h"
+#include "file_linter.h"
+#include "options.h"
+#include "profiler.h"
+
+#ifdef __linux__
+#include <sys/resource.h>
+#endif
+
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+namespace fs = std::filesystem;
+
+// The number of I/O threads is min(num_threads, MAX_READ_THREADS).
+static const size_t MAX_READ_THREADS = 4;
+
+// Capacities of the queues.
+// Loaded files wait in the queue, so its capacity is small.
+static const size_t PATH_QUEUE_SIZE = 4096;
+static const size_t FILES_PER_WORKER = 2;
+
+// Entries of an io_uring. Each file uses two of them at most.
+static const unsigned URING_ENTRIES = 64;
+
+static int64_t ElapsedNs(std::chrono::steady_clock::time_point start) {
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+}
+
+LintPipeline::LintPipeline(CppLintState* cpplint_state, const Options& options,
+                           int num_threads) :
+        m_cpplint_state(cpplint_state),
+        m_options(options),
+        m_paths(PATH_QUEUE_SIZE),
+        m_files(FILES_PER_WORKER * static_cast<size_t>(MAX(num_threads, 1))),
+        m_memory(options.MaxMemory()),
+        m_num_readers(MIN(static_cast<size_t>(MAX(num_threads, 1)), MAX_READ_THREADS)),
+        m_num_workers(static_cast<size_t>(MAX(num_threads, 1))),
+        m_idle_workers(),
+        m_pool(m_num_readers + m_num_workers),
+        m_readers(),
+        m_workers(),
+        m_finished(false),
+        m_done_mtx(),
+        m_done_cv(),
+        m_num_pushed(0),
+        m_num_done(0),
+        m_error(),
+        m_uring_used(false),
+        m_read_ns(0),
+        m_check_ns(0) {
+    m_cpplint_state->StartWriter();
+    m_idle_workers.Add(static_cast<int64_t>(m_num_workers));
+    for (size_t i = 0; i < m_num_readers; i++)
+        m_readers.push_back(m_pool.enqueue([this]() { ReadLoop(); }));
+    for (size_t i = 0; i < m_num_workers; i++)
+        m_workers.push_back(m_pool.enqueue([this]() { CheckLoop(); }));
+}
+
+LintPipeline::~LintPipeline() {
+    // Exceptions of workers are not thrown from the destructor.
+    Stop();
+}
+
+size_t LintPipeline::EstimateMemory(const fs::path& file) const {
+    // stdin is streamed with a window of lines, so it's not counted.
+    if (m_memory.Max() == 0 || file == "-")
+        return 0;
+    std::error_code ec;
+    uintmax_t size = fs::file_size(file, ec);
+    if (ec)
+        return 0;
+    return static_cast<size_t>(size) * LINT_MEMORY_PER_BYTE;
+}
+
+void LintPipeline::ReadLoop() {
+    if (ReadLoopWithUring())
+        return;
+
+    fs::path path;
+    while (m_paths.Pop(&path)) {
+        size_t memory = EstimateMemory(path);
+        m_memory.Acquire(memory);
+        auto start = std::chrono::steady_clock::now();
+        LoadedFile file = { path, "", false, memory };
+        // stdin is read by the check stage.
+        if (path != "-")
+            file.loaded = LoadFile(path, &file.content);
+        m_read_ns += ElapsedNs(start);
+        m_files.Push(std::move(file));
+    }
+}
+
+// Returns false when io_uring is not available.
+bool LintPipeline::ReadLoopWithUring() {
+    UringLoader uring;
+    if (!uring.Init(URING_ENTRIES))
+        return false;
+    m_uring_used = true;
+
+    std::vector<fs::path> paths;
+    std::vector<LoadedFile> files;
+    auto load_and_push = [this, &uring, &files]() {
+        auto start = std::chrono::steady_clock::now();
+        uring.Load(&files);
+        m_read_ns += ElapsedNs(start);
+        for (LoadedFile& file : files)
+            m_files.Push(std::move(file));
+        files.clear();
+    };
+    while (m_paths.PopSome(&paths, URING_ENTRIES / 2)) {
+        for (fs::path& path : paths) {
+            if (path == "-") {
+                // stdin is read by the check stage.
+                load_and_push();
+                m_files.Push({ std::move(path), "", false });
+            } else {
+                size_t memory = EstimateMemory(path);
+                if (!m_memory.TryAcquire(memory)) {
+                    // Files in the batch hold the budget, so they go first.
+                    load_and_push();
+                    m_memory.Acquire(memory);
+                }
+                files.push_back({ std::move(path), "", false, memory });
+            }
+        }
+        load_and_push();
+    }
+    return true;
+}
+
+void LintPipeline::CheckLoop() {
+    // Each worker reuses its linter to avoid reallocating buffers for every file.
+    FileLinter linter;
+    LoadedFile file;
+    while (m_files.Pop(&file)) {
+        m_idle_workers.Add(-1);
+        auto start = std::chrono::steady_clock::now();
+        std::exception_ptr error = nullptr;
+        try {
+            PROFILE_FILE(file.path.string());
+            linter.Reset(file.path, m_cpplint_state, m_options);
+            linter.SetIdleWorkers(&m_idle_workers);
+            linter.ProcessFile(file.loaded ? &file.content : nullptr);
+        } catch (...) {
+            // The file is still counted as done, so Wait() and Finish() don't hang.
+            // The exception is thrown from them instead.
+            error = std::current_exception();
+            linter = FileLinter();
+        }
+
+        // All outputs are stored in thread local streams.
+        // We flush them here.
+        m_cpplint_state->FlushThreadStream();
+        m_check_ns += ElapsedNs(start);
+
+        // Buffers of the linter are reused for the next file. They are freed
+        // when they would hold more than a share of the budget for each worker.
+        file.content = std::string();
+        if (m_memory.Max() > 0 && file.memory > m_memory.Max() / m_num_workers) {
+            linter = FileLinter();
+#ifdef __GLIBC__
+            // Freed memory stays in the malloc arena of each thread otherwise.
+            malloc_trim(0);
+#endif
+        }
+        m_memory.Release(file.memory);
+        m_idle_workers.Add(1);
+
+        std::lock_guard<std::mutex> lock(m_done_mtx);
+        if (error && !m_error)
+            m_error = error;
+        m_num_done++;
+        m_done_cv.notify_all();
+    }
+}
+
+void LintPipeline::Push(const fs::path& file) {
+    {
+        std::lock_guard<std::mutex> lock(m_done_mtx);
+        m_num_pushed++;
+    }
+    m_paths.Push(file);
+}
+
+void LintPipeline::Wait() {
+    std::unique_lock<std::mutex> lock(m_done_mtx);
+    m_done_cv.wait(lock, [this] { return m_num_done == m_num_pushed; });
+    // The exception is thrown once.
+    std::exception_ptr error = std::exchange(m_error, nullptr);
+    lock.unlock();
+    if (error)
+        std::rethrow_exception(error);
+}
+
+void LintPipeline::Stop() {
+    if (m_finished)
+        return;
+    m_finished = true;
+    m_paths.Close();
+    for (std::future<void>& reader : m_readers)
+        reader.get();
+    m_files.Close();
+    for (std::future<void>& worker : m_workers)
+        worker.get();
+    m_cpplint_state->StopWriter();
+}
+
+void LintPipeline::Finish() {
+    Stop();
+    std::exception_ptr error = std::exchange(m_error, nullptr);
+    if (error)
+        std::rethrow_exception(error);
+}
+
+static std::string FormatUtilization(const char* stage, int64_t busy_ns,
+                                     double elapsed_sec, size_t num_threads,
+                                     const char* note = "") {
+    double percent = 0;
+    if (elapsed_sec > 0 && num_threads > 0) {
+        percent = static_cast<double>(busy_ns) / 1e9 /
+                  (elapsed_sec * static_cast<double>(num_threads)) * 100;
+    }
+    std::ostringstream ss;
+    ss.setf(std::ios::fixed);
+    ss.precision(1);
+    ss << stage << " " << percent << "% (" << num_threads <<
+          (num_threads == 1 ? " thread" : " threads") << note << ")";
+    return ss.str();
+}
+
+std::string LintPipeline::GetUtilizationReport(double elapsed_sec) const {
+    return "Stage utilization: " +
+           FormatUtilization("read", m_read_ns, elapsed_sec, m_num_readers,
+                             m_uring_used ? ", io_uring" : "") + ", " +
+           FormatUtilization("check", m_check_ns, elapsed_sec, m_num_workers) + ", " +
+           FormatUtilization("write", m_cpplint_state->WriterBusyNs(), elapsed_sec, 1) +
+           "\n";
+}
+
+static std::string FormatMegabytes(size_t bytes) {
+    std::ostringstream ss;
+    ss.setf(std::ios::fixed);
+    ss.precision(1);
+    ss << static_cast<double>(bytes) / (1 << 20) << " MB";
+    return ss.str();
+}
+
+std::string LintPipeline::GetMemoryReport() {
+    std::string report;
+    if (m_memory.Max() > 0) {
+        report += "estimated peak " + FormatMegabytes(m_memory.Peak()) +
+                  " (max " + FormatMegabytes(m_memory.Max()) + ")";
+    }
+#ifdef __linux__
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+        if (!report.empty())
+            report += ", ";
+        // ru_maxrss is in kilobytes on Linux.
+        report += "peak RSS " + FormatMegabytes(static_cast<size_t>(usage.ru_maxrss) * 1024);
+    }
+#endif
+    if (report.empty())
+        return "";
+    return "Memory: " + report + "\n";
+}
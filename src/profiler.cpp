@@ -0,0 +1,136 @@
+#include "profiler.h"
+
+#ifdef CPPLINT_PROFILE
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+bool g_profiler_enabled = false;
+
+struct ProfileEntry {
+    uint64_t calls = 0;
+    int64_t total_ns = 0;
+};
+
+typedef std::pair<int64_t, std::string> FileTime;
+
+// Accumulator for each thread.
+// It doesn't need locks because only its owner thread updates it.
+struct ThreadProfile {
+    std::vector<ProfileEntry> entries;
+    // min-heap to keep the slowest files
+    std::priority_queue<FileTime, std::vector<FileTime>, std::greater<FileTime>> slowest_files;
+};
+
+static std::mutex g_profiler_mtx;
+static std::vector<const char*> g_section_names;
+static std::vector<std::unique_ptr<ThreadProfile>> g_thread_profiles;
+static size_t g_num_slowest_files = 0;
+
+// Accumulators are owned by g_thread_profiles,
+// so they are still alive after their threads are finished.
+thread_local ThreadProfile* t_profile = nullptr;
+
+static ThreadProfile* GetThreadProfile() {
+    if (t_profile == nullptr) {
+        std::lock_guard<std::mutex> lock(g_profiler_mtx);
+        g_thread_profiles.emplace_back(std::make_unique<ThreadProfile>());
+        t_profile = g_thread_profiles.back().get();
+    }
+    return t_profile;
+}
+
+void ProfilerEnable(size_t num_slowest_files) {
+    g_profiler_enabled = true;
+    g_num_slowest_files = num_slowest_files;
+}
+
+int ProfilerRegister(const char* name) {
+    std::lock_guard<std::mutex> lock(g_profiler_mtx);
+    g_section_names.push_back(name);
+    return static_cast<int>(g_section_names.size() - 1);
+}
+
+void ProfilerAdd(int id, int64_t elapsed_ns) {
+    ThreadProfile* profile = GetThreadProfile();
+    size_t index = static_cast<size_t>(id);
+    if (index >= profile->entries.size())
+        profile->entries.resize(index + 1);
+    ProfileEntry& entry = profile->entries[index];
+    entry.calls++;
+    entry.total_ns += elapsed_ns;
+}
+
+void ProfilerAddFile(const std::string& filename, int64_t elapsed_ns) {
+    if (g_num_slowest_files == 0)
+        return;
+    ThreadProfile* profile = GetThreadProfile();
+    profile->slowest_files.emplace(elapsed_ns, filename);
+    if (profile->slowest_files.size() > g_num_slowest_files)
+        profile->slowest_files.pop();
+}
+
+std::string ProfilerReport() {
+    std::lock_guard<std::mutex> lock(g_profiler_mtx);
+
+    // Merge accumulators
+    std::vector<ProfileEntry> entries(g_section_names.size());
+    std::vector<FileTime> files;
+    for (const std::unique_ptr<ThreadProfile>& profile : g_thread_profiles) {
+        for (size_t i = 0; i < profile->entries.size(); i++) {
+            entries[i].calls += profile->entries[i].calls;
+            entries[i].total_ns += profile->entries[i].total_ns;
+        }
+        auto heap = profile->slowest_files;
+        while (!heap.empty()) {
+            files.push_back(heap.top());
+            heap.pop();
+        }
+    }
+
+    // Sort sections by total time
+    std::vector<size_t> order;
+    for (size_t i = 0; i < entries.size(); i++) {
+        if (entries[i].calls > 0)
+            order.push_back(i);
+    }
+    std::stable_sort(order.begin(), order.end(), [&entries](size_t a, size_t b) {
+        return entries[a].total_ns > entries[b].total_ns;
+    });
+
+    std::ostringstream report;
+    report << std::fixed << std::setprecision(3);
+    report << "Profile (inclusive time summed over all threads):\n"
+           << std::setw(14) << "total(ms)" << std::setw(12) << "calls"
+           << std::setw(12) << "avg(us)" << "  section\n";
+    for (size_t i : order) {
+        const ProfileEntry& entry = entries[i];
+        report << std::setw(14) << static_cast<double>(entry.total_ns) / 1e6
+               << std::setw(12) << entry.calls
+               << std::setw(12) << static_cast<double>(entry.total_ns) / 1e3 /
+                                   static_cast<double>(entry.calls)
+               << "  " << g_section_names[i] << "\n";
+    }
+
+    if (!files.empty()) {
+        std::sort(files.begin(), files.end(), std::greater<FileTime>());
+        if (files.size() > g_num_slowest_files)
+            files.resize(g_num_slowest_files);
+        report << "Slowest files:\n";
+        for (const FileTime& file : files) {
+            report << std::setw(14) << static_cast<double>(file.first) / 1e6
+                   << "(ms)  " << file.second << "\n";
+        }
+    }
+    return report.str();
+}
+
+#endif  // CPPLINT_PROFILE
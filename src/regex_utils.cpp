@@ -3,13 +3,75 @@
 #include <algorithm>
 #include <cstring>
 #include <iostream>
+#include <iterator>
 #include <string>
 #include <string_view>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 #include "common.h"
 
+#ifdef CPPLINT_REGEX_BUNDLE
+#include "regex_patterns.h"
+#include "regex_bundle.h"
+
+// Patterns serialized at build time. (See gen_regex_bundle.cpp.)
+// Decoding them is faster than compiling them one by one.
+class RegexBundle {
+ private:
+    std::vector<pcre2_code*> m_codes;
+    // Maps a pattern to the first entry that has the pattern.
+    std::unordered_map<std::string_view, size_t> m_first_ids;
+
+ public:
+    RegexBundle() : m_codes(std::size(REGEX_BUNDLE_ENTRIES)), m_first_ids() {
+        int32_t count = static_cast<int32_t>(m_codes.size());
+        int32_t ret = pcre2_serialize_decode(m_codes.data(), count,
+                                             REGEX_BUNDLE_DATA, nullptr);
+        if (ret != count) {
+            // The data is incompatible with the linked pcre2.
+            // Patterns will be compiled at runtime.
+            m_codes.clear();
+            return;
+        }
+        m_first_ids.reserve(m_codes.size());
+        for (size_t i = 0; i < m_codes.size(); i++)
+            m_first_ids.emplace(REGEX_BUNDLE_ENTRIES[i].pattern, i);
+    }
+
+    ~RegexBundle() {
+        for (pcre2_code* code : m_codes)
+            pcre2_code_free(code);
+    }
+
+    // Returns a copy of the serialized pattern, or nullptr if it's not found.
+    // Copies have their own character tables since decoded patterns share
+    // the tables with a reference count that is not thread safe.
+    pcre2_code* Find(const char* regex, uint32_t options) const noexcept {
+        auto it = m_first_ids.find(regex);
+        if (it == m_first_ids.end())
+            return nullptr;
+        // The same patterns are sorted next to each other.
+        for (size_t i = it->second; i < m_codes.size(); i++) {
+            const RegexBundleEntry& entry = REGEX_BUNDLE_ENTRIES[i];
+            if (strcmp(entry.pattern, regex) != 0)
+                break;
+            if (entry.options == options)
+                return pcre2_code_copy_with_tables(m_codes[i]);
+        }
+        return nullptr;
+    }
+};
+#endif  // CPPLINT_REGEX_BUNDLE
+
 pcre2_code* RegexCompileBase(const char* regex, uint32_t options) noexcept {
+#ifdef CPPLINT_REGEX_BUNDLE
+    static const RegexBundle bundle;
+    pcre2_code* bundled = bundle.Find(regex, options);
+    if (bundled)
+        return bundled;
+#endif
+
     int error_number;
     PCRE2_SIZE error_offset;
     pcre2_code* code_ptr = pcre2_compile(
@@ -215,9 +277,12 @@ static void regex_replace_base(
     PCRE2_SIZE start_offset = 0;
 
     // Get matched ranges and the length of replaced string
-    std::vector<std::pair<PCRE2_SIZE, PCRE2_SIZE>>* matched_ranges = nullptr;
-    size_t result_length = 0;
+    thread_local std::vector<std::pair<PCRE2_SIZE, PCRE2_SIZE>> matched_ranges;
+    matched_ranges.clear();
+    size_t result_length = str.length();
     size_t fmt_length = strlen(fmt);
+    // True when no replacement is longer than its match
+    bool shrinks = true;
     while (true) {
         int rc = re_match(
             re,
@@ -230,7 +295,6 @@ static void regex_replace_base(
 
         if (rc < 0) {
             if (rc == PCRE2_ERROR_NOMATCH) {
-                result_length += str.length() - start_offset;
                 break;  // No more matches
             } else {
                 std::cerr << "PCRE2 matching error " << rc << std::endl;
@@ -242,10 +306,9 @@ static void regex_replace_base(
         PCRE2_SIZE* ovector = pcre2_get_ovector_pointer(re_result_temp.get());
         PCRE2_SIZE match_start = ovector[0];
         PCRE2_SIZE match_end = ovector[1];
-        if (!matched_ranges)
-            matched_ranges = new std::vector<std::pair<PCRE2_SIZE, PCRE2_SIZE>>({});
-        matched_ranges->emplace_back(match_start, match_end);
-        result_length += match_start - start_offset + fmt_length;
+        matched_ranges.emplace_back(match_start, match_end);
+        result_length = result_length + fmt_length - (match_end - match_start);
+        shrinks = shrinks && fmt_length <= match_end - match_start;
 
         // Update previous_end and start_offset to continue after the current match
         start_offset = match_end;
@@ -260,9 +323,25 @@ static void regex_replace_base(
             break;
     }
 
-    if (!matched_ranges)
+    if (matched_ranges.empty())
         return;  // Returns input string as it is.
 
+    if (result_str == &str && shrinks) {
+        // Overwrite the string in place. Unmatched parts only move backward.
+        char* result_p = result_str->data();
+        PCRE2_SIZE prev_end = 0;
+        for (const std::pair<PCRE2_SIZE, PCRE2_SIZE>& range : matched_ranges) {
+            memmove(result_p, str.data() + prev_end, range.first - prev_end);
+            result_p += range.first - prev_end;
+            memcpy(result_p, fmt, fmt_length);
+            result_p += fmt_length;
+            prev_end = range.second;
+        }
+        memmove(result_p, str.data() + prev_end, str.length() - prev_end);
+        result_str->resize(result_length);
+        return;
+    }
+
     // Create return value
     std::string new_str;
     new_str.resize(result_length);
@@ -271,7 +350,7 @@ static void regex_replace_base(
     const char* fmt_p = fmt;
     PCRE2_SIZE prev_end = 0;
 
-    for (const std::pair<PCRE2_SIZE, PCRE2_SIZE>& range : (*matched_ranges)) {
+    for (const std::pair<PCRE2_SIZE, PCRE2_SIZE>& range : matched_ranges) {
         memcpy(result_p, str_p + prev_end, range.first - prev_end);
         result_p += range.first - prev_end;
         memcpy(result_p, fmt_p, fmt_length);
@@ -283,7 +362,6 @@ static void regex_replace_base(
         memcpy(result_p, str_p + prev_end, str.length() - prev_end);
 
     *result_str = std::move(new_str);
-    delete matched_ranges;
 }
 
 std::string RegexReplace(const regex_code& regex, const std::string& fmt,
@@ -368,6 +446,24 @@ std::vector<std::string> RegexSplit(const std::string& regex, const std::string&
     return result;
 }
 
+RegexSet::RegexSet(std::initializer_list<const char*> patterns) : m_codes() {
+    if (patterns.size() > 64) {
+        std::cerr << "RegexSet supports up to 64 patterns." << std::endl;
+        exit(1);
+    }
+    for (const char* pattern : patterns)
+        m_codes.emplace_back(RegexJitCompile(pattern));
+}
+
+uint64_t RegexSet::Search(std::string_view str) const noexcept {
+    uint64_t hits = 0;
+    for (size_t i = 0; i < m_codes.size(); i++) {
+        if (RegexSearch(m_codes[i], str))
+            hits |= uint64_t(1) << i;
+    }
+    return hits;
+}
+
 #ifdef SUPPORT_JIT
 regex_code RegexJitCompile(const char* regex, uint32_t options) noexcept {
     pcre2_code* ret = RegexCompileBase(regex, options);
@@ -2,12 +2,15 @@
 #include <cassert>
 #include <cmath>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 #include "cleanse.h"
 #include "file_linter.h"
 #include "line_utils.h"
 #include "nest_info.h"
+#include "profiler.h"
 #include "regex_utils.h"
 #include "string_utils.h"
 
@@ -234,6 +237,70 @@ bool NestingState::InTemplateArgumentList(const CleansedLines& clean_lines,
     return false;
 }
 
+void NestingState::RestoreStack(const BlockStackNode* stack_top) {
+    m_stack_top = stack_top;
+    size_t depth = (stack_top == nullptr) ? 0 : stack_top->depth;
+    m_stack.resize(depth);
+    for (const BlockStackNode* node = stack_top; node != nullptr; node = node->parent)
+        m_stack[node->depth - 1] = node->block;
+}
+
+void NestingState::Compact() {
+    BlockInfoArena arena;
+    std::unordered_map<BlockInfo*, BlockInfo*> moved_blocks;
+    std::unordered_map<const BlockStackNode*, const BlockStackNode*> moved_nodes;
+
+    auto move_block = [&](BlockInfo* block) -> BlockInfo* {
+        if (block == nullptr)
+            return nullptr;
+        auto it = moved_blocks.find(block);
+        if (it != moved_blocks.end())
+            return it->second;
+        BlockInfo* new_block = arena.MoveBlock(block);
+        moved_blocks.emplace(block, new_block);
+        return new_block;
+    };
+
+    // Snapshots share their parents, so nodes are moved from the first shared one.
+    auto move_node = [&](const BlockStackNode* node) -> const BlockStackNode* {
+        std::vector<const BlockStackNode*> chain;
+        const BlockStackNode* parent = nullptr;
+        for (; node != nullptr; node = node->parent) {
+            auto it = moved_nodes.find(node);
+            if (it != moved_nodes.end()) {
+                parent = it->second;
+                break;
+            }
+            chain.push_back(node);
+        }
+        for (auto it = chain.rbegin(); it != chain.rend(); it++) {
+            const BlockStackNode* new_node =
+                arena.New<BlockStackNode>(move_block((*it)->block), parent, (*it)->depth);
+            moved_nodes.emplace(*it, new_node);
+            parent = new_node;
+        }
+        return parent;
+    };
+
+    const BlockStackNode* stack_top = move_node(m_stack_top);
+    m_previous_stack_top = move_block(m_previous_stack_top);
+
+    std::vector<PreprocessorInfo> pp_infos;
+    while (!m_pp_stack.empty()) {
+        pp_infos.push_back(m_pp_stack.top());
+        m_pp_stack.pop();
+    }
+    for (auto it = pp_infos.rbegin(); it != pp_infos.rend(); it++) {
+        PreprocessorInfo pp(move_node(it->StackBeforeIf()));
+        pp.SetSeenElse(it->SeenElse());
+        pp.SetStackBeforeElse(move_node(it->StackBeforeElse()));
+        m_pp_stack.push(pp);
+    }
+
+    m_arena = std::move(arena);
+    RestoreStack(stack_top);
+}
+
 void NestingState::UpdatePreprocessor(const std::string& line) {
     /*Update preprocessor stack.
 
@@ -264,7 +331,7 @@ void NestingState::UpdatePreprocessor(const std::string& line) {
     if (RegexMatch(RE_PATTERN_IF_MACRO, line)) {
         // Beginning of #if block, save the nesting stack here.  The saved
         // stack will allow us to restore the parsing state in the #else case.
-        m_pp_stack.push(PreprocessorInfo(m_stack));
+        m_pp_stack.push(PreprocessorInfo(m_stack_top));
     } else if (RegexMatch(RE_PATTERN_ELSE_MACRO, line)) {
         // Beginning of #else block
         if (!m_pp_stack.empty()) {
@@ -274,11 +341,11 @@ void NestingState::UpdatePreprocessor(const std::string& line) {
                 // whole nesting stack up to this point.  This is what we
                 // keep after the #endif.
                 pp.SetSeenElse(true);
-                pp.SetStackBeforeElse(m_stack);
+                pp.SetStackBeforeElse(m_stack_top);
             }
 
             // Restore the stack to how it was before the #if
-            m_stack = pp.StackBeforeIf();
+            RestoreStack(pp.StackBeforeIf());
         } else {
             // TODO(unknown): unexpected #else, issue warning?
         }
@@ -292,7 +359,7 @@ void NestingState::UpdatePreprocessor(const std::string& line) {
             if (pp.SeenElse()) {
                 // Here we can just use a shallow copy since we are the last
                 // reference to it.
-                m_stack = pp.StackBeforeElse();
+                RestoreStack(pp.StackBeforeElse());
             }
             // Drop the corresponding #if
             m_pp_stack.pop();
@@ -302,16 +369,15 @@ void NestingState::UpdatePreprocessor(const std::string& line) {
     }
 }
 
-const regex_code RE_PATTERN_ASM = RegexCompile(
-    R"(^\s*(?:asm|_asm|__asm|__asm__))"
-    R"((?:\s+(volatile|__volatile__))?)"
-    R"(\s*[{(])");
-
 void NestingState::Update(const CleansedLines& clean_lines,
                           const std::string& elided_line,
                           size_t linenum,
                           FileLinter* file_linter) {
-    std::string line = elided_line;
+    PROFILE_SCOPE("NestingState::Update");
+    static const regex_code RE_PATTERN_ASM = RegexCompile(
+        R"(^\s*(?:asm|_asm|__asm|__asm__))"
+        R"((?:\s+(volatile|__volatile__))?)"
+        R"(\s*[{(])");
 
     // Remember top of the previous nesting stack.
     //
@@ -324,13 +390,13 @@ void NestingState::Update(const CleansedLines& clean_lines,
         m_previous_stack_top = nullptr;
 
     // Update pp_stack
-    UpdatePreprocessor(line);
+    UpdatePreprocessor(elided_line);
 
     // Count parentheses.  This is to avoid adding struct arguments to
     // the nesting stack.
     if (!m_stack.empty()) {
         BlockInfo* inner_block = m_stack.back();
-        int depth_change = StrCount(line, '(') - StrCount(line, ')');
+        int depth_change = StrCount(elided_line, '(') - StrCount(elided_line, ')');
         inner_block->IncOpenParentheses(depth_change);
 
         // Also check if we are starting or ending an inline assembly block.
@@ -338,7 +404,7 @@ void NestingState::Update(const CleansedLines& clean_lines,
         if (inline_asm == NO_ASM || inline_asm == END_ASM) {
             if (depth_change != 0 &&
                 inner_block->OpenParentheses() == 1 &&
-                RegexMatch(RE_PATTERN_ASM, line)) {
+                RegexMatch(RE_PATTERN_ASM, elided_line)) {
                 // Enter assembly block
                 inner_block->SetInlineAsm(INSIDE_ASM);
             } else {
@@ -353,6 +419,10 @@ void NestingState::Update(const CleansedLines& clean_lines,
         }
     }
 
+    // The rest of the function consumes the line from the front.
+    // Use a view to avoid copying the remaining part on each step.
+    std::string_view line = elided_line;
+
     // Consume namespace declaration at the beginning of the line.  Do
     // this in a loop so that we catch same line declarations like this:
     //   namespace proto2 { namespace bridge { class MessageSet; } }
@@ -367,14 +437,13 @@ void NestingState::Update(const CleansedLines& clean_lines,
         if (!match)
             break;
 
-        m_block_info_buffer.push(new NamespaceInfo(GetMatchStr(m_re_result, line, 1), linenum));
-        m_stack.push_back(m_block_info_buffer.top());
+        PushBlock(m_arena.New<NamespaceInfo>(GetMatchStr(m_re_result, line, 1), linenum));
 
-        line = GetMatchStr(m_re_result, line, 2);
+        line = GetMatchStrView(m_re_result, line, 2);
         size_t pos = line.find('{');
-        if (pos != std::string::npos) {
+        if (pos != std::string_view::npos) {
             m_stack.back()->SetSeenOpenBrace(true);
-            line = line.substr(pos + 1);
+            line.remove_prefix(pos + 1);
         }
     }
 
@@ -401,13 +470,11 @@ void NestingState::Update(const CleansedLines& clean_lines,
         // template argument list.
         size_t end_declaration = GetMatchSize(m_re_result, 1);
         if (!InTemplateArgumentList(clean_lines, linenum, end_declaration)) {
-            m_block_info_buffer.push(
-                new ClassInfo(
+            PushBlock(m_arena.New<ClassInfo>(
                         GetMatchStr(m_re_result, line, 3),
                         GetMatchStr(m_re_result, line, 2),
                         clean_lines, linenum));
-            m_stack.push_back(m_block_info_buffer.top());
-            line = GetMatchStr(m_re_result, line, 4);
+            line = GetMatchStrView(m_re_result, line, 4);
         }
     }
 
@@ -447,19 +514,16 @@ void NestingState::Update(const CleansedLines& clean_lines,
     }
 
     // Consume braces or semicolons from what's left of the line
+    static constexpr CharSet TOKEN_CHARS("{;)}");
     size_t pos = 0;
     while (pos < line.size()) {
-        // Match first brace, semicolon, or closed parenthesis.
-        static const regex_code RE_PATTERN_TOKEN =
-            RegexCompile("^[^{;)}]*([{;)}])(.*)$");
-        size_t length = line.size() - pos;
-        bool matched = RegexMatchWithRange(RE_PATTERN_TOKEN, line,
-                                           pos, length, m_re_result);
-        if (!matched)
+        // Find first brace, semicolon, or closed parenthesis.
+        size_t token_pos = FindFirstOf(line, TOKEN_CHARS, pos);
+        if (token_pos == INDEX_NONE)
             break;
 
-        const char token = line[GetMatchStart(m_re_result, 1, pos)];
-        assert(GetMatchSize(m_re_result, 1) == 1);
+        const char token = line[token_pos];
+        size_t length = line.size() - pos;
         if (token == '{') {
             // If namespace or class hasn't seen a opening brace yet, mark
             // namespace/class head as complete.  Push a new block onto the
@@ -469,11 +533,9 @@ void NestingState::Update(const CleansedLines& clean_lines,
             if (!SeenOpenBrace()) {
                 m_stack.back()->SetSeenOpenBrace(true);
             } else if (RegexMatchWithRange(RE_PATTERN_EXTERN, line, pos, length)) {
-                m_block_info_buffer.push(new ExternCInfo(linenum));
-                m_stack.push_back(m_block_info_buffer.top());
+                PushBlock(m_arena.New<ExternCInfo>(linenum));
             } else {
-                m_block_info_buffer.push(new BlockInfo(linenum, true));
-                m_stack.push_back(m_block_info_buffer.top());
+                PushBlock(m_arena.New<BlockInfo>(linenum, true));
                 if (RegexMatchWithRange(RE_PATTERN_ASM, line, pos, length))
                     m_stack.back()->SetInlineAsm(BLOCK_ASM);
             }
@@ -487,15 +549,15 @@ void NestingState::Update(const CleansedLines& clean_lines,
             // function arguments with extra "class" or "struct" keywords.
             // Also pop these stack for these.
             if (!SeenOpenBrace())
-                m_stack.pop_back();
+                PopBlock();
         } else {  // token == '}'
             // Perform end of block checks and pop the stack.
             if (!m_stack.empty()) {
                 m_stack.back()->CheckEnd(clean_lines, linenum, file_linter);
-                m_stack.pop_back();
+                PopBlock();
             }
         }
-        pos = GetMatchStart(m_re_result, 2, pos);
+        pos = token_pos + 1;
     }
 }
 
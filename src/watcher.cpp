@@ -0,0 +1,382 @@
+#include "watcher.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+#include "common.h"
+#include "cpplint_state.h"
+#include "options.h"
+#include "pipeline.h"
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+// Returns indices of errors sorted by line numbers.
+static std::vector<size_t> SortByLine(const std::vector<ErrorRecord>& errors,
+                                      const std::vector<size_t>& indices) {
+    std::vector<size_t> sorted = indices;
+    std::stable_sort(sorted.begin(), sorted.end(), [&errors](size_t a, size_t b) {
+        return errors[a].linenum < errors[b].linenum;
+    });
+    return sorted;
+}
+
+void DiffErrors(const std::vector<ErrorRecord>& old_errors,
+                const std::vector<ErrorRecord>& new_errors,
+                std::vector<ErrorRecord>* added,
+                std::vector<ErrorRecord>* resolved) {
+    added->clear();
+    resolved->clear();
+
+    // Indices of old and new errors for each category and message
+    using Key = std::pair<std::string, std::string>;
+    std::map<Key, std::pair<std::vector<size_t>, std::vector<size_t>>> groups;
+    for (size_t i = 0; i < old_errors.size(); i++)
+        groups[{ old_errors[i].category, old_errors[i].message }].first.push_back(i);
+    for (size_t i = 0; i < new_errors.size(); i++)
+        groups[{ new_errors[i].category, new_errors[i].message }].second.push_back(i);
+
+    std::vector<size_t> added_ids;
+    std::vector<size_t> resolved_ids;
+    for (const auto& item : groups) {
+        std::vector<size_t> old_ids = SortByLine(old_errors, item.second.first);
+        std::vector<size_t> new_ids = SortByLine(new_errors, item.second.second);
+
+        // Match errors on the same lines.
+        std::vector<size_t> old_rest;
+        std::vector<size_t> new_rest;
+        size_t i = 0;
+        size_t j = 0;
+        while (i < old_ids.size() && j < new_ids.size()) {
+            size_t old_line = old_errors[old_ids[i]].linenum;
+            size_t new_line = new_errors[new_ids[j]].linenum;
+            if (old_line == new_line) {
+                i++;
+                j++;
+            } else if (old_line < new_line) {
+                old_rest.push_back(old_ids[i++]);
+            } else {
+                new_rest.push_back(new_ids[j++]);
+            }
+        }
+        old_rest.insert(old_rest.end(), old_ids.begin() + static_cast<ptrdiff_t>(i),
+                        old_ids.end());
+        new_rest.insert(new_rest.end(), new_ids.begin() + static_cast<ptrdiff_t>(j),
+                        new_ids.end());
+
+        // Errors that moved to other lines are matched in order.
+        size_t moved = MIN(old_rest.size(), new_rest.size());
+        resolved_ids.insert(resolved_ids.end(),
+                            old_rest.begin() + static_cast<ptrdiff_t>(moved), old_rest.end());
+        added_ids.insert(added_ids.end(),
+                         new_rest.begin() + static_cast<ptrdiff_t>(moved), new_rest.end());
+    }
+
+    // Keep the original order.
+    std::sort(added_ids.begin(), added_ids.end());
+    std::sort(resolved_ids.begin(), resolved_ids.end());
+    for (size_t id : added_ids)
+        added->push_back(new_errors[id]);
+    for (size_t id : resolved_ids)
+        resolved->push_back(old_errors[id]);
+}
+
+Watcher::Watcher(CppLintState* cpplint_state, const Options& options, LintPipeline* pipeline) :
+        m_cpplint_state(cpplint_state),
+        m_options(options),
+        m_pipeline(pipeline),
+        m_inotify_fd(-1),
+        m_extensions(options.GetAllExtensions()),
+        m_header_extensions(options.GetHeaderExtensions()),
+        m_dirs(),
+        m_errors() {}
+
+static std::string ExtensionOf(const fs::path& file) {
+    std::string ext = file.extension().string();
+    return ext.empty() ? ext : ext.substr(1);
+}
+
+static bool IsInDirectory(const fs::path& path, const fs::path& dir) {
+    auto it = std::mismatch(dir.begin(), dir.end(), path.begin(), path.end()).first;
+    return it == dir.end();
+}
+
+bool Watcher::IsInRecursiveDir(const fs::path& path) const {
+    for (const fs::path& dir : m_options.RecursiveDirs()) {
+        if (IsInDirectory(path, dir))
+            return true;
+    }
+    return false;
+}
+
+bool Watcher::ShouldLint(const fs::path& file) const {
+    // New files are linted when --recursive would find them.
+    return m_extensions.contains(ExtensionOf(file)) &&
+           IsInRecursiveDir(file) &&
+           !m_options.IsExcluded(file) &&
+           fs::is_regular_file(file);
+}
+
+void Watcher::Relint(const std::set<fs::path>& changed) {
+    std::vector<fs::path> files;
+    std::vector<fs::path> removed;
+    for (const fs::path& file : changed) {
+        if (fs::is_regular_file(file))
+            files.push_back(file);
+        else if (m_errors.contains(file))
+            removed.push_back(file);
+    }
+    if (files.empty() && removed.empty())
+        return;
+
+    // Workers only record errors. Differences are printed below.
+    m_cpplint_state->SetErrorRecording(true, false);
+    for (const fs::path& file : files)
+        m_pipeline->Push(file);
+    m_pipeline->Wait();
+    m_cpplint_state->SetErrorRecording(false);
+
+    std::map<fs::path, std::vector<ErrorRecord>> new_errors;
+    for (const fs::path& file : files)
+        new_errors[file] = {};
+    for (const fs::path& file : removed)
+        new_errors[file] = {};
+    for (ErrorRecord& record : m_cpplint_state->TakeErrorRecords())
+        new_errors[record.filename].push_back(std::move(record));
+
+    size_t num_added = 0;
+    size_t num_resolved = 0;
+    std::vector<ErrorRecord> added;
+    std::vector<ErrorRecord> resolved;
+    for (auto& [file, errors] : new_errors) {
+        DiffErrors(m_errors[file], errors, &added, &resolved);
+        for (const ErrorRecord& e : resolved) {
+            m_cpplint_state->PrintInfo(
+                "Resolved: " + e.filename + ":" + std::to_string(e.linenum) + ":  " +
+                e.message + "  [" + e.category + "] [" + std::to_string(e.confidence) + "]\n");
+        }
+        for (const ErrorRecord& e : added)
+            m_cpplint_state->Error(e.filename, e.linenum, e.category, e.confidence, e.message);
+        num_added += added.size();
+        num_resolved += resolved.size();
+        m_errors[file] = std::move(errors);
+    }
+    for (const fs::path& file : removed)
+        m_errors.erase(file);
+    // Errors go to stderr. Write them before the summary on stdout.
+    m_cpplint_state->FlushThreadStream();
+    m_cpplint_state->SyncWriter();
+
+    // Counts errors of all files again.
+    m_cpplint_state->ResetErrorCounts();
+    for (const auto& item : m_errors) {
+        for (const ErrorRecord& e : item.second)
+            m_cpplint_state->IncrementErrorCount(e.category);
+    }
+    m_cpplint_state->PrintInfo(
+        "Linted " + std::to_string(files.size()) + " files: " +
+        std::to_string(num_added) + " new errors, " +
+        std::to_string(num_resolved) + " resolved errors\n");
+    if (!m_cpplint_state->Quiet() || m_cpplint_state->ErrorCount() > 0)
+        m_cpplint_state->PrintErrorCounts();
+    m_cpplint_state->FlushThreadStream();
+    m_cpplint_state->SyncWriter();
+}
+
+#ifdef __linux__
+
+// Changes are linted when no events come for this time.
+// Editors often write a file with several events.
+static const int DEBOUNCE_MS = 100;
+
+static const uint32_t WATCH_MASK = IN_CLOSE_WRITE | IN_CREATE | IN_DELETE |
+                                   IN_MOVED_FROM | IN_MOVED_TO | IN_ONLYDIR;
+
+Watcher::~Watcher() {
+    if (m_inotify_fd >= 0)
+        close(m_inotify_fd);
+}
+
+void Watcher::WatchDirectory(const fs::path& dir, bool recursive,
+                             std::set<fs::path>* new_files) {
+    int wd = inotify_add_watch(m_inotify_fd, dir.c_str(), WATCH_MASK);
+    if (wd < 0) {
+        m_cpplint_state->PrintError("Failed to watch " + dir.string() + "\n");
+        return;
+    }
+    m_dirs[wd] = dir;
+    if (!recursive)
+        return;
+
+    std::error_code ec;
+    for (const fs::directory_entry& entry : fs::directory_iterator(dir, ec)) {
+        if (entry.is_directory(ec))
+            WatchDirectory(entry.path(), true, new_files);
+        else if (!m_errors.contains(entry.path()) && ShouldLint(entry.path()))
+            new_files->insert(entry.path());
+    }
+}
+
+bool Watcher::Init(const std::vector<fs::path>& files, std::vector<ErrorRecord> records) {
+    m_inotify_fd = inotify_init1(IN_CLOEXEC);
+    if (m_inotify_fd < 0)
+        return false;
+
+    for (const fs::path& file : files)
+        m_errors[file] = {};
+    for (ErrorRecord& record : records)
+        m_errors[record.filename].push_back(std::move(record));
+
+    // Directories of linted files, and all directories given with --recursive.
+    std::set<fs::path> dirs;
+    for (const auto& item : m_errors)
+        dirs.insert(item.first.parent_path());
+    std::set<fs::path> new_files;
+    for (const fs::path& dir : m_options.RecursiveDirs()) {
+        WatchDirectory(dir, true, &new_files);
+        dirs.erase(dir);
+    }
+    for (const fs::path& dir : dirs) {
+        if (!IsInRecursiveDir(dir))
+            WatchDirectory(dir, false, &new_files);
+    }
+
+    m_cpplint_state->PrintInfo(
+        "Watching " + std::to_string(m_errors.size()) + " files for changes...\n");
+    m_cpplint_state->FlushThreadStream();
+    m_cpplint_state->SyncWriter();
+
+    // Files created after the first run
+    if (!new_files.empty())
+        Relint(new_files);
+    return true;
+}
+
+void Watcher::HandleEvent(int wd, uint32_t mask, const char* name,
+                          std::set<fs::path>* changed) {
+    if (mask & IN_Q_OVERFLOW) {
+        // Some events are lost. Lint all the files again.
+        for (const auto& item : m_errors)
+            changed->insert(item.first);
+        return;
+    }
+    auto it = m_dirs.find(wd);
+    if (it == m_dirs.end())
+        return;
+    if (mask & IN_IGNORED) {
+        // The directory was removed.
+        m_dirs.erase(it);
+        return;
+    }
+    if (name[0] == '\0')
+        return;
+    fs::path path = it->second / name;
+
+    if (mask & IN_ISDIR) {
+        if ((mask & (IN_CREATE | IN_MOVED_TO)) && IsInRecursiveDir(path))
+            WatchDirectory(path, true, changed);
+        if (mask & (IN_DELETE | IN_MOVED_FROM)) {
+            for (const auto& item : m_errors) {
+                if (IsInDirectory(item.first, path))
+                    changed->insert(item.first);
+            }
+        }
+        return;
+    }
+
+    if (path.filename() == m_options.ConfigFilename()) {
+        // Lint all files affected by the config file.
+        ForgetCfg(path);
+        for (const auto& item : m_errors) {
+            if (IsInDirectory(item.first, it->second))
+                changed->insert(item.first);
+        }
+        return;
+    }
+
+    if (!(mask & (IN_CLOSE_WRITE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO)))
+        return;
+    if (m_errors.contains(path) || ShouldLint(path))
+        changed->insert(path);
+
+    // build/include checks if a source file includes a header with the same name.
+    // So, sources should be linted again when their headers are added or removed.
+    if (m_header_extensions.contains(ExtensionOf(path))) {
+        fs::path stem = path.stem();
+        for (const auto& item : m_errors) {
+            const fs::path& file = item.first;
+            if (file.parent_path() == it->second && file.stem() == stem &&
+                !m_header_extensions.contains(ExtensionOf(file)))
+                changed->insert(file);
+        }
+    }
+}
+
+void Watcher::Run() {
+    alignas(inotify_event) char buffer[4096];
+    while (true) {
+        // Wait for the first event, and collect more events until files are quiet.
+        std::set<fs::path> changed;
+        int timeout = -1;
+        while (true) {
+            pollfd pfd = { m_inotify_fd, POLLIN, 0 };
+            int ret = poll(&pfd, 1, timeout);
+            if (ret == 0)
+                break;
+            ssize_t length = ret < 0 ? -1 : read(m_inotify_fd, buffer, sizeof(buffer));
+            if (length < 0 && errno == EINTR)
+                continue;
+            if (length <= 0) {
+                m_cpplint_state->PrintError("Failed to read file system events.\n");
+                m_cpplint_state->FlushThreadStream();
+                return;
+            }
+            for (char* ptr = buffer; ptr < buffer + length; ) {
+                const inotify_event* event = reinterpret_cast<const inotify_event*>(ptr);
+                HandleEvent(event->wd, event->mask, event->len > 0 ? event->name : "", &changed);
+                ptr += sizeof(inotify_event) + event->len;
+            }
+            timeout = DEBOUNCE_MS;
+        }
+        Relint(changed);
+    }
+}
+
+#else  // __linux__
+
+Watcher::~Watcher() {}
+
+void Watcher::WatchDirectory(const fs::path& dir, bool recursive,
+                             std::set<fs::path>* new_files) {
+    UNUSED(dir);
+    UNUSED(recursive);
+    UNUSED(new_files);
+}
+
+bool Watcher::Init(const std::vector<fs::path>& files, std::vector<ErrorRecord> records) {
+    UNUSED(files);
+    UNUSED(records);
+    return false;
+}
+
+void Watcher::HandleEvent(int wd, uint32_t mask, const char* name,
+                          std::set<fs::path>* changed) {
+    UNUSED(wd);
+    UNUSED(mask);
+    UNUSED(name);
+    UNUSED(changed);
+}
+
+void Watcher::Run() {}
+
+#endif  // __linux__
@@ -0,0 +1,133 @@
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "binary_report.h"
+
+namespace fs = std::filesystem;
+
+TEST(BinaryReportTest, RoundTrip) {
+    BinaryWriter writer;
+    writer.WriteHeader();
+    writer.WriteError("foo.cpp", 1, "whitespace/tab", 1, "Tab found; better to use spaces");
+    writer.WriteError("foo.cpp", 3, "whitespace/tab", 1, "Tab found; better to use spaces");
+    writer.WriteError("bar.h", 0, "build/header_guard", 5, "No #ifndef header guard found");
+    std::string data = writer.Buffer();
+
+    BinaryReader reader(data);
+    BinaryError error;
+    ASSERT_TRUE(reader.ReadError(&error));
+    EXPECT_EQ("foo.cpp", error.filename);
+    EXPECT_EQ(1, error.linenum);
+    EXPECT_EQ("whitespace/tab", error.category);
+    EXPECT_EQ(1, error.confidence);
+    EXPECT_EQ("Tab found; better to use spaces", error.message);
+    ASSERT_TRUE(reader.ReadError(&error));
+    EXPECT_EQ("foo.cpp", error.filename);
+    EXPECT_EQ(3, error.linenum);
+    ASSERT_TRUE(reader.ReadError(&error));
+    EXPECT_EQ("bar.h", error.filename);
+    EXPECT_EQ(0, error.linenum);
+    EXPECT_EQ("build/header_guard", error.category);
+    EXPECT_EQ(5, error.confidence);
+    EXPECT_EQ("No #ifndef header guard found", error.message);
+    EXPECT_FALSE(reader.ReadError(&error));
+    EXPECT_EQ("", reader.ErrorMessage());
+}
+
+TEST(BinaryReportTest, InternStrings) {
+    BinaryWriter writer;
+    writer.WriteError("foo.cpp", 1, "whitespace/tab", 1, "Tab found; better to use spaces");
+    size_t first_size = writer.Buffer().size();
+    writer.WriteError("foo.cpp", 2, "whitespace/tab", 1, "Tab found; better to use spaces");
+    // The second record only has IDs of the strings.
+    EXPECT_EQ(23, writer.Buffer().size() - first_size);
+}
+
+TEST(BinaryReportTest, MessageTemplates) {
+    BinaryWriter writer;
+    writer.WriteHeader();
+    writer.WriteError("foo.cpp", 1, "whitespace/line_length", 2,
+                      "Lines should be <= 80 characters long");
+    size_t first_size = writer.Buffer().size();
+    writer.WriteError("foo.cpp", 2, "whitespace/line_length", 2,
+                      "Lines should be <= 100 characters long");
+    // Messages with different numbers share a template.
+    EXPECT_EQ(31, writer.Buffer().size() - first_size);
+
+    const std::vector<std::string> messages = {
+        "1 2 3",
+        "Use int16/int64/etc, rather than the C type long",
+        "x = 007; y = 0; z = 1234567890; w = 123456789",
+        "0x1F, 3.14, c++11, (42)",
+        "",
+    };
+    for (const std::string& message : messages)
+        writer.WriteError("foo.cpp", 3, "runtime/int", 4, message);
+
+    BinaryReader reader(writer.Buffer());
+    BinaryError error;
+    ASSERT_TRUE(reader.ReadError(&error));
+    EXPECT_EQ("Lines should be <= 80 characters long", error.message);
+    ASSERT_TRUE(reader.ReadError(&error));
+    EXPECT_EQ("Lines should be <= 100 characters long", error.message);
+    for (const std::string& message : messages) {
+        ASSERT_TRUE(reader.ReadError(&error));
+        EXPECT_EQ(message, error.message);
+        EXPECT_EQ(3, error.linenum);
+        EXPECT_EQ(4, error.confidence);
+    }
+    EXPECT_FALSE(reader.ReadError(&error));
+    EXPECT_EQ("", reader.ErrorMessage());
+}
+
+TEST(BinaryReportTest, MappedFile) {
+    BinaryWriter writer;
+    writer.WriteHeader();
+    writer.WriteError("foo.cpp", 1, "whitespace/tab", 1, "Tab found; better to use spaces");
+    fs::path path = fs::temp_directory_path() / "cpplint_binary_test.bin";
+    {
+        std::ofstream file(path, std::ios::binary);
+        file << writer.Buffer();
+    }
+
+    MappedFile mapped;
+    ASSERT_TRUE(mapped.Open(path.string()));
+    EXPECT_EQ(writer.Buffer(), mapped.Data());
+    BinaryReader reader(mapped.Data());
+    BinaryError error;
+    ASSERT_TRUE(reader.ReadError(&error));
+    EXPECT_EQ("Tab found; better to use spaces", error.message);
+    mapped.Close();
+    EXPECT_EQ("", mapped.Data());
+
+    // Empty files
+    {
+        std::ofstream file(path, std::ios::binary);
+    }
+    ASSERT_TRUE(mapped.Open(path.string()));
+    EXPECT_EQ("", mapped.Data());
+    fs::remove(path);
+    EXPECT_FALSE(mapped.Open(path.string()));
+}
+
+TEST(BinaryReportTest, InvalidMagic) {
+    BinaryReader reader("foo.cpp:1:  Tab found; better to use spaces  [whitespace/tab] [1]\n");
+    BinaryError error;
+    EXPECT_FALSE(reader.ReadError(&error));
+    EXPECT_EQ("Not a binary output of cpplint-cpp.", reader.ErrorMessage());
+}
+
+TEST(BinaryReportTest, Truncated) {
+    BinaryWriter writer;
+    writer.WriteHeader();
+    writer.WriteError("foo.cpp", 1, "whitespace/tab", 1, "Tab found; better to use spaces");
+    std::string data = writer.Buffer();
+    data.pop_back();
+
+    BinaryReader reader(data);
+    BinaryError error;
+    EXPECT_FALSE(reader.ReadError(&error));
+    EXPECT_EQ("Unexpected end of binary output.", reader.ErrorMessage());
+}
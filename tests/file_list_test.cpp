@@ -0,0 +1,193 @@
+#define _HAS_STREAM_INSERTION_OPERATORS_DELETED_IN_CXX20 1
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include <set>
+#include <string>
+#include <vector>
+#include "cpplint_state.h"
+#include "options.h"
+
+namespace fs = std::filesystem;
+
+class FileListTest : public ::testing::Test {
+ protected:
+    fs::path dir;
+    CppLintState cpplint_state;
+
+    void SetUp() override {
+        dir = fs::temp_directory_path() / "cpplint_file_list_test";
+        fs::remove_all(dir);
+        fs::create_directories(dir / "src");
+        dir = fs::canonical(dir);
+        cpplint_state.FlushThreadStream();
+    }
+
+    void TearDown() override {
+        cpplint_state.FlushThreadStream();
+        fs::remove_all(dir);
+    }
+
+    void WriteFile(const fs::path& path, const std::string& content = "") {
+        std::ofstream file(path, std::ios::binary);
+        file << content;
+    }
+
+    // Reads files with options, and returns paths relative to dir in the read order.
+    std::vector<std::string> ReadFiles(std::vector<std::string> args) {
+        args.insert(args.begin(), "cpplint");
+        std::vector<char*> argv;
+        for (std::string& arg : args)
+            argv.push_back(arg.data());
+
+        Options options;
+        options.ParseArguments(static_cast<int>(argv.size()), argv.data(), &cpplint_state);
+        FileListReader reader(options, &cpplint_state);
+        std::vector<std::string> files;
+        reader.Read([&](const fs::path& file) {
+            files.push_back(file.lexically_relative(dir).generic_string());
+        });
+        return files;
+    }
+
+    std::vector<std::string> ReadCompileCommands(const std::string& json) {
+        WriteFile(dir / "compile_commands.json", json);
+        return ReadFiles({ "--compile-commands=" + (dir / "compile_commands.json").string() });
+    }
+
+    bool HasParseError() {
+        std::string errors = cpplint_state.GetErrorStreamAsStr();
+        cpplint_state.FlushThreadStream();
+        return errors.find("Failed to parse compilation database") != std::string::npos;
+    }
+};
+
+TEST_F(FileListTest, FileList) {
+    for (const char* name : { "a.cc", "b.cc", "excluded.cc", "src/c.cc" })
+        WriteFile(dir / name);
+    std::string list =
+        (dir / "a.cc").string() + "\n"
+        "  " + fs::relative(dir / "b.cc").string() + "  \n"
+        "\n" +
+        (dir / "src" / ".." / "a.cc").string() + "\n" +  // duplicate
+        (dir / "excluded.cc").string() + "\n" +
+        (dir / "not_found.cc").string() + "\n" +
+        (dir / "src" / "c.cc").string() + "\n";
+    WriteFile(dir / "list.txt", list);
+    std::vector<std::string> files = ReadFiles({
+        "--exclude=" + (dir / "excluded.cc").string(),
+        "--file-list=" + (dir / "list.txt").string(),
+    });
+    EXPECT_EQ(std::vector<std::string>({ "a.cc", "b.cc", "src/c.cc" }), files);
+    EXPECT_NE(std::string::npos,
+              cpplint_state.GetErrorStreamAsStr().find("not_found.cc': Path not found."));
+}
+
+TEST_F(FileListTest, CommandLineFiles) {
+    WriteFile(dir / "a.cc");
+    WriteFile(dir / "b.cc");
+    WriteFile(dir / "list.txt", (dir / "a.cc").string() + "\n" + (dir / "b.cc").string());
+    // Files from the command line are not passed again.
+    std::vector<std::string> files = ReadFiles({
+        "--file-list=" + (dir / "list.txt").string(),
+        (dir / "a.cc").string(),
+    });
+    EXPECT_EQ(std::vector<std::string>({ "b.cc" }), files);
+}
+
+TEST_F(FileListTest, CompileCommands) {
+    for (const char* name : { "a.cc", "b.cc", "src/c.cc" })
+        WriteFile(dir / name);
+    std::string d = dir.generic_string();
+    std::vector<std::string> files = ReadCompileCommands(
+        "[\n"
+        "  {\"directory\": \"" + d + "\", \"file\": \"src/c.cc\",\n"
+        "   \"command\": \"c++ -c src/c.cc\"},\n"
+        "  {\"file\": \"c.cc\", \"directory\": \"" + d + "/src\",\n"
+        "   \"arguments\": [\"c++\", \"-c\", \"c.cc\"], \"output\": {\"x\": [1, true, null]}},\n"
+        "  {\"directory\": \"/not_found\", \"file\": \"" + d + "/a.cc\"},\n"
+        "  {\"directory\": \"" + d + "\", \"file\": \"src\\/..\\/b.cc\"}\n"
+        "]\n");
+    EXPECT_EQ(std::vector<std::string>({ "src/c.cc", "a.cc", "b.cc" }), files);
+    EXPECT_FALSE(HasParseError());
+
+    EXPECT_TRUE(ReadCompileCommands("[]").empty());
+    EXPECT_TRUE(ReadCompileCommands("").empty());
+    EXPECT_FALSE(HasParseError());
+}
+
+TEST_F(FileListTest, StringEscapes) {
+    // U+00E9, U+3042, and U+1F600 (a surrogate pair in JSON)
+    WriteFile(dir / "c\xC3\xA9 d.cc");
+    WriteFile(dir / "\xE3\x81\x82\xF0\x9F\x98\x80.cc");
+    std::string d = dir.generic_string();
+    std::vector<std::string> files = ReadCompileCommands(
+        "[{\"directory\": \"" + d + "\", \"file\": \"c\\u00e9\\u0020d.cc\"},"
+        " {\"directory\": \"" + d + "\", \"file\": \"\\u3042\\uD83D\\uDE00.cc\"}]");
+    EXPECT_EQ(std::vector<std::string>({
+        "c\xC3\xA9 d.cc", "\xE3\x81\x82\xF0\x9F\x98\x80.cc"
+    }), files);
+    EXPECT_FALSE(HasParseError());
+
+    // Unpaired surrogates and broken escapes
+    for (const char* file : { "\\uD83D.cc", "\\uD83D\\u0041.cc", "\\uDE00.cc",
+                              "\\u12G4.cc", "\\u12" }) {
+        std::string json = "[{\"directory\": \"" + d + "\", \"file\": \"" + file + "\"}]";
+        EXPECT_TRUE(ReadCompileCommands(json).empty()) << "  file: " << file;
+        EXPECT_TRUE(HasParseError()) << "  file: " << file;
+    }
+}
+
+TEST_F(FileListTest, MalformedJson) {
+    WriteFile(dir / "a.cc");
+    std::string a = "{\"file\": \"" + (dir / "a.cc").generic_string() + "\"}";
+    const std::vector<std::string> cases = {
+        "[" + a + ", {\"file\": \"b.cc",  // unterminated string
+        "[" + a + ", {\"directory\": \"/\"}]",  // missing file
+        "[" + a + ", {\"file\": \"\"}]",  // empty file
+        "[" + a + " " + a + "]",  // missing comma
+        "[" + a + ", {\"file\" \"b.cc\"}]",  // missing colon
+        "[" + a + ", {\"output\": [1, 2}]",  // unterminated array
+        "[" + a,  // unterminated array
+    };
+    for (const std::string& json : cases) {
+        // Files before the error are still read.
+        EXPECT_EQ(std::vector<std::string>({ "a.cc" }), ReadCompileCommands(json))
+            << "  json: " << json;
+        EXPECT_TRUE(HasParseError()) << "  json: " << json;
+    }
+    EXPECT_TRUE(ReadCompileCommands(a).empty());
+    EXPECT_TRUE(HasParseError());
+}
+
+TEST_F(FileListTest, Shards) {
+    std::string list;
+    std::multiset<std::string> expected;
+    for (int i = 0; i < 20; i++) {
+        std::string name = "f" + std::to_string(i) + ".cc";
+        WriteFile(dir / name);
+        expected.insert(name);
+        // The same file with different spellings
+        list += (dir / name).string() + "\n";
+        list += (dir / "src" / ".." / name).string() + "\n";
+        list += fs::relative(dir / name).string() + "\n";
+    }
+    WriteFile(dir / "list.txt", list);
+    WriteFile(dir / "argv.cc");
+
+    for (int count : { 2, 3 }) {
+        std::multiset<std::string> files;
+        for (int index = 0; index < count; index++) {
+            std::vector<std::string> shard_files = ReadFiles({
+                "--shard=" + std::to_string(index) + "/" + std::to_string(count),
+                "--file-list=" + (dir / "list.txt").string(),
+                (dir / "argv.cc").string(),
+            });
+            // Each shard gets some of the files.
+            EXPECT_FALSE(shard_files.empty());
+            files.insert(shard_files.begin(), shard_files.end());
+        }
+        // Every file is read by one shard. argv.cc is only in the command line.
+        EXPECT_EQ(expected, files) << "  shards: " << count;
+    }
+}
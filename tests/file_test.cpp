@@ -1,6 +1,9 @@
 #define _HAS_STREAM_INSERTION_OPERATORS_DELETED_IN_CXX20 1
 #include <gtest/gtest.h>
+#include <algorithm>
+#include <sstream>
 #include <string>
+#include <tuple>
 #include <vector>
 #include "cpplint_state.h"
 #include "file_linter.h"
@@ -90,3 +93,133 @@ TEST_F(FileLinterTest, Crlf) {
         "  [whitespace/newline] [1]\n";
     EXPECT_ERROR_STR(expected);
 }
+
+TEST_F(FileLinterTest, NdjsonOutput) {
+    filename = "./tests/test_files/nullbytes.c";
+    cpplint_state.SetOutputFormat("ndjson");
+    ProcessFile();
+    EXPECT_EQ(2, cpplint_state.ErrorCount());
+    const char* expected =
+        "{\"file\": \"./tests/test_files/nullbytes.c\", \"line\": 1, "
+        "\"category\": \"readability/nul\", \"confidence\": 5, "
+        "\"message\": \"Line contains NUL byte.\"}\n"
+        "{\"file\": \"./tests/test_files/nullbytes.c\", \"line\": 2, "
+        "\"category\": \"readability/nul\", \"confidence\": 5, "
+        "\"message\": \"Line contains NUL byte.\"}\n";
+    EXPECT_STREQ(expected, cpplint_state.GetOutputStreamAsStr().c_str());
+    EXPECT_ERROR_STR("");
+}
+
+TEST_F(FileLinterTest, NdjsonInvalidUTF8) {
+    cpplint_state.SetOutputFormat("ndjson");
+    cpplint_state.Error("bad\xff.c", 1, ErrorCategory("readability/utf8"), 5,
+                        "\xC3\xA9 \xC3( \xED\xA0\x80 \xF0\x9F\x98\x80 \xE3\x81");
+    const char* expected =
+        "{\"file\": \"bad\\ufffd.c\", \"line\": 1, "
+        "\"category\": \"readability/utf8\", \"confidence\": 5, "
+        "\"message\": \"\xC3\xA9 \\ufffd( \\ufffd\\ufffd\\ufffd \xF0\x9F\x98\x80 "
+        "\\ufffd\\ufffd\"}\n";
+    EXPECT_STREQ(expected, cpplint_state.GetOutputStreamAsStr().c_str());
+}
+
+TEST_F(FileLinterTest, SarifOutput) {
+    filename = "./tests/test_files/nullbytes.c";
+    cpplint_state.SetOutputFormat("sarif");
+    ProcessFile();
+    EXPECT_EQ(2, cpplint_state.ErrorCount());
+    const char* expected =
+        "        {\"ruleId\": \"readability/nul\", \"level\": \"warning\", "
+        "\"message\": {\"text\": \"Line contains NUL byte.\"}, "
+        "\"locations\": [{\"physicalLocation\": {"
+        "\"artifactLocation\": {\"uri\": \"./tests/test_files/nullbytes.c\"}, "
+        "\"region\": {\"startLine\": 1}}}], \"properties\": {\"confidence\": 5}},\n"
+        "        {\"ruleId\": \"readability/nul\", \"level\": \"warning\", "
+        "\"message\": {\"text\": \"Line contains NUL byte.\"}, "
+        "\"locations\": [{\"physicalLocation\": {"
+        "\"artifactLocation\": {\"uri\": \"./tests/test_files/nullbytes.c\"}, "
+        "\"region\": {\"startLine\": 2}}}], \"properties\": {\"confidence\": 5}}";
+    EXPECT_STREQ(expected, cpplint_state.GetOutputStreamAsStr().c_str());
+    EXPECT_ERROR_STR("");
+}
+
+TEST_F(FileLinterTest, StreamWindows) {
+    // Errors of a stream should be the same as ones of the whole content,
+    // even when comments and raw strings are longer than a window.
+    std::string content = "/*\n";
+    for (int i = 0; i < 100; i++)
+        content += " * a long comment\n";
+    content += " */\n";
+    for (int i = 0; i < 40; i++) {
+        std::string id = std::to_string(i);
+        content +=
+            "namespace ns" + id + " {\n"
+            "int f" + id + "(int a,int b) {  /* a multi-line\n"
+            "    comment */\n"
+            "  const char* s = R\"(raw\n"
+            "string)\";\n"
+            "  return a+b; \n"
+            "}\n"
+            "}\n";
+    }
+
+    auto sorted_records = [this]() {
+        std::vector<ErrorRecord> records = cpplint_state.TakeErrorRecords();
+        std::sort(records.begin(), records.end(),
+                  [](const ErrorRecord& a, const ErrorRecord& b) {
+            return std::tie(a.linenum, a.category, a.message) <
+                   std::tie(b.linenum, b.category, b.message);
+        });
+        return records;
+    };
+
+    filename = "-";
+    ResetFilters();
+    cpplint_state.SetErrorRecording(true, false);
+    linter.ProcessFile(&content);
+    std::vector<ErrorRecord> expected = sorted_records();
+
+    ResetFilters();
+    linter.SetStreamWindowLines(MIN_STREAM_WINDOW_LINES);
+    std::istringstream stream(content);
+    linter.ProcessStream(stream);
+    std::vector<ErrorRecord> actual = sorted_records();
+    cpplint_state.SetErrorRecording(false);
+
+    EXPECT_LT(100, expected.size());
+    ASSERT_EQ(expected.size(), actual.size());
+    for (size_t i = 0; i < expected.size(); i++) {
+        EXPECT_EQ(expected[i].linenum, actual[i].linenum);
+        EXPECT_EQ(expected[i].category, actual[i].category);
+        EXPECT_EQ(expected[i].message, actual[i].message);
+    }
+}
+
+TEST_F(FileLinterTest, FiltersAndNolint) {
+    std::string content =
+        "int a;\t\n"
+        "int b;\t  // NOLINT(whitespace/tab)\n"
+        "int c;\t  // NOLINT\n"
+        "int d = (int)1.0;\n";
+
+    // Filters match categories by prefix.
+    filename = "-";
+    filters = "-legal,-whitespace";
+    ResetFilters();
+    linter.ProcessFile(&content);
+    EXPECT_EQ(1, cpplint_state.ErrorCount());
+    EXPECT_EQ(1, cpplint_state.ErrorCount("readability/casting"));
+
+    // Later filters override earlier ones.
+    filters = "-legal,-whitespace,+whitespace/tab,-readability:-";
+    ResetFilters();
+    linter.ProcessFile(&content);
+    EXPECT_EQ(1, cpplint_state.ErrorCount());
+    EXPECT_EQ(1, cpplint_state.ErrorCount("whitespace/tab"));
+
+    // File-specific filters don't affect other files.
+    filters = "-legal,-whitespace,-readability:foo.cc";
+    ResetFilters();
+    linter.ProcessFile(&content);
+    EXPECT_EQ(1, cpplint_state.ErrorCount("readability/casting"));
+    cpplint_state.GetErrorStreamAsStr();
+}
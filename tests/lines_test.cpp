@@ -3863,6 +3863,36 @@ TEST_F(LinesLinterTest, IncludeWhatYouUseFail) {
     EXPECT_ERROR_STR(expected);
 }
 
+TEST_F(LinesLinterTest, IncludeWhatYouUseFailContext) {
+    ProcessLines({
+        "printf(\"%d\", 1);",
+        "x = max<int>(a, b);",
+        "::std::list<int> l;",
+        "std::cout << foo::less<int>();",
+        "void f(foo::set<int> a, std::set<int> b);",
+        "y = sort();",
+    });
+    EXPECT_EQ(5, cpplint_state.ErrorCount());
+    EXPECT_EQ(5, cpplint_state.ErrorCount("build/include_what_you_use"));
+    const char* expected =
+        "test/test.cpp:2:  "
+        "Add #include <algorithm> for max"
+        "  [build/include_what_you_use] [4]\n"
+        "test/test.cpp:1:  "
+        "Add #include <cstdio> for printf"
+        "  [build/include_what_you_use] [4]\n"
+        "test/test.cpp:4:  "
+        "Add #include <iostream> for cout"
+        "  [build/include_what_you_use] [4]\n"
+        "test/test.cpp:3:  "
+        "Add #include <list> for list<>"
+        "  [build/include_what_you_use] [4]\n"
+        "test/test.cpp:5:  "
+        "Add #include <set> for set<>"
+        "  [build/include_what_you_use] [4]\n";
+    EXPECT_ERROR_STR(expected);
+}
+
 TEST_F(LinesLinterTest, NolintBlockPass) {
     ProcessLines({
         "// NOLINTBEGIN(build/include)",
@@ -4046,3 +4076,98 @@ TEST_F(LinesLinterTest, LintKernelFile) {
     EXPECT_EQ(1, cpplint_state.ErrorCount("readability/casting"));
     EXPECT_EQ(1, cpplint_state.ErrorCount("runtime/int"));
 }
+
+TEST_F(LinesLinterTest, ParallelLineChecks) {
+    // Line-local checks on other threads should print the same errors in the same order.
+    std::vector<std::string> lines = {
+        "// Copyright 2024",
+        "class Foo {",
+        "public:",
+        "  int a;  int b; ",
+        "  void f(string &s) {",
+        "    asm volatile (",
+        "        \"mov %0, 1 ;;  \"",
+        "        : \"=r\"(x));",
+        "    if(a) {  // NOLINT",
+        "\treturn;",
+        "    }",
+        "  }",
+        "};",
+        "int g( ) { return  1;; }",
+    };
+    ProcessLines(lines);
+    std::string expected = cpplint_state.GetErrorStreamAsStr();
+    int expected_count = cpplint_state.ErrorCount();
+    EXPECT_LT(0, expected_count);
+    cpplint_state.FlushThreadStream();
+
+    ResetFilters("-legal/copyright,-whitespace/ending_newline");
+    cpplint_state.SetNumThreads(4);
+    linter.SetParallelChunkLines(4);
+    ProcessLines(lines);
+    EXPECT_EQ(expected_count, cpplint_state.ErrorCount());
+    EXPECT_ERROR_STR(expected.c_str());
+    cpplint_state.FlushThreadStream();
+
+    // Chunks only use idle workers, and give them back.
+    IdleWorkers idle_workers;
+    for (int64_t idle : { 0, 1 }) {
+        idle_workers.Add(idle);
+        ResetFilters("-legal/copyright,-whitespace/ending_newline");
+        cpplint_state.SetNumThreads(4);
+        linter.SetParallelChunkLines(4);
+        linter.SetIdleWorkers(&idle_workers);
+        ProcessLines(lines);
+        EXPECT_EQ(expected_count, cpplint_state.ErrorCount());
+        EXPECT_ERROR_STR(expected.c_str());
+        EXPECT_EQ(idle, idle_workers.Count());
+        cpplint_state.FlushThreadStream();
+    }
+}
+
+TEST(CleansedLinesTest, BlockExtents) {
+    Options options;
+    std::vector<std::string> lines = {
+        "class A {",             // 0
+        "  int Foo(int a,",      // 1
+        "          int b) {",    // 2
+        "    return \"}\";",     // 3
+        "  }",                   // 4
+        "};",                    // 5
+        "void Bar(",             // 6
+        "    // { in comments",  // 7
+        "    int a)",            // 8
+        "}",                     // 9
+    };
+    CleansedLines clean_lines(lines, options);
+    EXPECT_EQ(5, clean_lines.GetBlockEnd(0));
+    EXPECT_EQ(1, clean_lines.GetBlockEnd(1));
+    EXPECT_EQ(4, clean_lines.GetBlockEnd(2));
+    EXPECT_EQ(3, clean_lines.GetBlockEnd(3));
+    EXPECT_EQ(INDEX_NONE, clean_lines.GetBlockEnd(9));
+    EXPECT_EQ(2, clean_lines.FindBodyStart(1));
+    EXPECT_EQ(3, clean_lines.FindBodyStart(3));
+    EXPECT_EQ(9, clean_lines.FindBodyStart(6));
+}
+
+TEST(CleansedLinesTest, StatementBoundaries) {
+    Options options;
+    std::vector<std::string> lines = {
+        "class A {",                             // 0
+        "  A(int a)",                            // 1
+        "      : a_(a),",                        // 2
+        "",                                      // 3
+        "        b_(a) {}",                      // 4
+        "  DISALLOW_COPY_AND_ASSIGN(A);  // ;",  // 5
+        "  // comment",                          // 6
+        "};",                                    // 7
+    };
+    CleansedLines clean_lines(lines, options);
+    EXPECT_EQ(INDEX_NONE, clean_lines.GetPrevNonBlankLine(0));
+    EXPECT_EQ(2, clean_lines.GetPrevNonBlankLine(4));
+    EXPECT_EQ(5, clean_lines.GetPrevNonBlankLine(7));
+    EXPECT_EQ(INDEX_NONE, clean_lines.GetPrevStatementEnd(0));
+    EXPECT_EQ(0, clean_lines.GetPrevStatementEnd(4));
+    EXPECT_EQ(5, clean_lines.GetPrevStatementEnd(7));
+    EXPECT_EQ(std::vector<size_t>({ 5 }), clean_lines.GetDisallowLines());
+}
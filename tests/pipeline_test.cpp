@@ -0,0 +1,150 @@
+#define _HAS_STREAM_INSERTION_OPERATORS_DELETED_IN_CXX20 1
+#include <gtest/gtest.h>
+#include <atomic>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+#include "cpplint_state.h"
+#include "file_linter.h"
+#include "options.h"
+#include "pipeline.h"
+
+TEST(PipelineTest, BoundedQueue) {
+    BoundedQueue<int> queue(2);
+    queue.Push(1);
+    queue.Push(2);
+    int item = 0;
+    EXPECT_TRUE(queue.Pop(&item));
+    EXPECT_EQ(1, item);
+    queue.Close();
+    // Remaining items can be popped after Close().
+    EXPECT_TRUE(queue.Pop(&item));
+    EXPECT_EQ(2, item);
+    EXPECT_FALSE(queue.Pop(&item));
+}
+
+TEST(PipelineTest, BoundedQueueThreads) {
+    BoundedQueue<int> queue(1);
+    std::thread producer([&queue]() {
+        for (int i = 0; i < 100; i++)
+            queue.Push(i);
+        queue.Close();
+    });
+    std::vector<int> items;
+    int item = 0;
+    while (queue.Pop(&item))
+        items.push_back(item);
+    producer.join();
+    ASSERT_EQ(100, items.size());
+    for (int i = 0; i < 100; i++)
+        EXPECT_EQ(i, items[i]);
+}
+
+TEST(PipelineTest, MemoryBudget) {
+    MemoryBudget budget(100);
+    EXPECT_TRUE(budget.TryAcquire(60));
+    EXPECT_TRUE(budget.TryAcquire(40));
+    EXPECT_FALSE(budget.TryAcquire(1));
+    budget.Release(60);
+    budget.Release(40);
+    // A file larger than the budget is admitted alone.
+    EXPECT_TRUE(budget.TryAcquire(150));
+    EXPECT_FALSE(budget.TryAcquire(1));
+    budget.Release(150);
+    EXPECT_EQ(150, budget.Peak());
+
+    // No limit
+    MemoryBudget unlimited(0);
+    EXPECT_TRUE(unlimited.TryAcquire(150));
+    EXPECT_TRUE(unlimited.TryAcquire(150));
+    EXPECT_EQ(300, unlimited.Peak());
+}
+
+TEST(PipelineTest, MemoryBudgetThreads) {
+    MemoryBudget budget(100);
+    budget.Acquire(80);
+    std::atomic<bool> acquired = false;
+    std::thread waiter([&budget, &acquired]() {
+        budget.Acquire(50);
+        acquired = true;
+    });
+    // Later files wait for the waiting one.
+    while (budget.TryAcquire(10)) {
+        budget.Release(10);
+        std::this_thread::yield();
+    }
+    EXPECT_FALSE(acquired);
+    budget.Release(80);
+    waiter.join();
+    EXPECT_TRUE(acquired);
+    budget.Release(50);
+}
+
+TEST(PipelineTest, IdleWorkers) {
+    IdleWorkers idle_workers;
+    EXPECT_EQ(0, idle_workers.TryTake(3));
+    idle_workers.Add(2);
+    EXPECT_EQ(2, idle_workers.TryTake(3));
+    EXPECT_EQ(0, idle_workers.TryTake(1));
+    // A worker got a file while its thread was taken.
+    idle_workers.Add(-1);
+    idle_workers.Release(2);
+    EXPECT_EQ(1, idle_workers.Count());
+    EXPECT_EQ(1, idle_workers.TryTake(3));
+    EXPECT_EQ(0, idle_workers.Count());
+}
+
+TEST(PipelineTest, LoadFile) {
+    const char* filename = "./tests/test_files/crlf.c";
+    std::ifstream file(filename, std::ios::binary);
+    std::string expected((std::istreambuf_iterator<char>(file)),
+                         std::istreambuf_iterator<char>());
+    std::string content = "garbage";
+    EXPECT_TRUE(LoadFile(filename, &content));
+    EXPECT_EQ(expected, content);
+
+    EXPECT_FALSE(LoadFile("./tests/test_files/not_found.c", &content));
+}
+
+TEST(PipelineTest, UringLoader) {
+    UringLoader uring;
+    if (!uring.Init(4))
+        GTEST_SKIP() << "io_uring is not available.";
+
+    std::vector<LoadedFile> files;
+    files.push_back({ "./tests/test_files/crlf.c", "", false });
+    files.push_back({ "./tests/test_files/not_found.c", "", true });
+    files.push_back({ "./tests/test_files", "", true });
+    files.push_back({ "./tests/test_files/nullbytes.c", "", false });
+    // Four entries can load two files at once. So, it uses two batches.
+    uring.Load(&files);
+
+    std::string expected;
+    ASSERT_TRUE(LoadFile("./tests/test_files/crlf.c", &expected));
+    EXPECT_TRUE(files[0].loaded);
+    EXPECT_EQ(expected, files[0].content);
+    EXPECT_FALSE(files[1].loaded);
+    // Directories are left to the check stage.
+    EXPECT_FALSE(files[2].loaded);
+    ASSERT_TRUE(LoadFile("./tests/test_files/nullbytes.c", &expected));
+    EXPECT_TRUE(files[3].loaded);
+    EXPECT_EQ(expected, files[3].content);
+}
+
+TEST(PipelineTest, PreloadedContent) {
+    Options options;
+    options.AddFilters("-legal/copyright");
+    CppLintState cpplint_state;
+    cpplint_state.SetCountingStyle("detailed");
+    cpplint_state.SetVerboseLevel(0);
+    // The file doesn't exist. The linter should only use the given content.
+    fs::path file = "./tests/test_files/preloaded.c";
+    FileLinter linter(file, &cpplint_state, options);
+    std::string content = "int a; \n";
+    linter.ProcessFile(&content);
+    EXPECT_EQ(1, cpplint_state.ErrorCount());
+    EXPECT_EQ(1, cpplint_state.ErrorCount("whitespace/end_of_line"));
+    cpplint_state.FlushThreadStream();
+}
@@ -144,7 +144,45 @@ TEST(RegexTest, RegexReplaceNoCopy) {
     EXPECT_STREQ("        true, true);", res.c_str());
 }
 
+TEST(RegexTest, RegexReplaceNoCopyLonger) {
+    regex_code re = RegexCompile("[0-9]+");
+    std::string res = "a1b22c333d";
+    RegexReplace(re, "@@", &res);
+    EXPECT_STREQ("a@@b@@c@@d", res.c_str());
+    res = "a1b22c333d";
+    RegexReplace(re, "##", &res, false);
+    EXPECT_STREQ("a##b22c333d", res.c_str());
+}
+
 TEST(RegexTest, RegexMatchWithRange) {
     bool match = RegexMatchWithRange("^test$", std::string("rangetest"), 5, 4);
     EXPECT_EQ(true, match);
 }
+
+TEST(RegexTest, RegexCompileBundledPattern) {
+    // "Copyright" is serialized with REGEX_OPTIONS_ICASE when the regex bundle is enabled.
+    regex_code re_icase = RegexCompile("Copyright", REGEX_OPTIONS_ICASE);
+    regex_code re_icase2 = RegexCompile("Copyright", REGEX_OPTIONS_ICASE);
+    regex_code re = RegexCompile("Copyright");
+    re_icase2.reset();
+    EXPECT_TRUE(RegexSearch(re_icase, std::string("// COPYRIGHT 2024")));
+    EXPECT_FALSE(RegexSearch(re, std::string("// COPYRIGHT 2024")));
+    EXPECT_TRUE(RegexSearch(re, std::string("// Copyright 2024")));
+}
+
+TEST(RegexTest, RegexSet) {
+    RegexSet set({ R"(\bint\b)", "(?i)printf", R"(\((\w+)\))", "^x" });
+    EXPECT_EQ(4, set.Size());
+    EXPECT_EQ(0, set.Search(""));
+    EXPECT_EQ(0, set.Search("long y = f(1 + 2);"));
+    EXPECT_EQ(0b0001, set.Search("int y;"));
+    EXPECT_EQ(0b0110, set.Search("PRINTF(x)"));
+    EXPECT_EQ(0b1101, set.Search("x = (int)y;"));
+    EXPECT_EQ(0b0110, set.Search("(printf)"));
+    EXPECT_TRUE(RegexSet::Matched(0b0100, 2));
+    EXPECT_FALSE(RegexSet::Matched(0b0100, 1));
+
+    regex_match result = RegexCreateMatchData(set.Get(2));
+    EXPECT_TRUE(RegexSearch(set.Get(2), std::string("(int)"), result));
+    EXPECT_EQ("int", GetMatchStr(result, std::string("(int)"), 1));
+}
@@ -0,0 +1,159 @@
+#define _HAS_STREAM_INSERTION_OPERATORS_DELETED_IN_CXX20 1
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include <set>
+#include <string>
+#include <vector>
+#include "cpplint_state.h"
+#include "file_linter.h"
+#include "options.h"
+
+namespace fs = std::filesystem;
+
+class ShardTest : public ::testing::Test {
+ protected:
+    fs::path dir;
+
+    void SetUp() override {
+        dir = fs::temp_directory_path() / "cpplint_shard_test";
+        fs::remove_all(dir);
+        fs::create_directories(dir);
+    }
+
+    void TearDown() override {
+        fs::remove_all(dir);
+    }
+
+    void WriteFile(const std::string& name, size_t size) {
+        std::ofstream file(dir / name, std::ios::binary);
+        file << std::string(size, 'a');
+    }
+
+    // Returns names of files selected for --shard=index/count.
+    std::vector<std::string> SelectShard(const std::vector<std::string>& names,
+                                         size_t index, size_t count) {
+        std::vector<std::string> args = {
+            "cpplint", "--shard=" + std::to_string(index) + "/" + std::to_string(count)
+        };
+        for (const std::string& name : names)
+            args.push_back((dir / name).string());
+        std::vector<char*> argv;
+        for (std::string& arg : args)
+            argv.push_back(arg.data());
+
+        Options options;
+        CppLintState cpplint_state;
+        std::vector<fs::path> files =
+            options.ParseArguments(static_cast<int>(argv.size()), argv.data(), &cpplint_state);
+        std::vector<std::string> selected;
+        for (const fs::path& file : files)
+            selected.push_back(file.filename().string());
+        return selected;
+    }
+
+    // Lints content as if it were read from filename.
+    void LintFile(CppLintState* cpplint_state, const std::string& filename,
+                  const std::string& content) {
+        Options options;
+        options.AddFilters("-legal/copyright");
+        fs::path file = filename;
+        FileLinter linter(file, cpplint_state, options);
+        linter.ProcessFile(&content);
+    }
+
+    std::string PrintErrorCounts(CppLintState* cpplint_state) {
+        cpplint_state->FlushThreadStream();
+        cpplint_state->PrintErrorCounts();
+        std::string counts = cpplint_state->GetOutputStreamAsStr();
+        cpplint_state->FlushThreadStream();
+        return counts;
+    }
+};
+
+TEST_F(ShardTest, EveryFileInOneShard) {
+    std::vector<std::string> names;
+    for (size_t i = 0; i < 20; i++) {
+        names.push_back("f" + std::to_string(i) + ".cc");
+        WriteFile(names.back(), (i * 37) % 11);
+    }
+    for (size_t count : { 1, 2, 3, 7, 25 }) {
+        std::multiset<std::string> linted;
+        for (size_t index = 0; index < count; index++) {
+            for (const std::string& name : SelectShard(names, index, count))
+                linted.insert(name);
+        }
+        EXPECT_EQ(std::multiset<std::string>(names.begin(), names.end()), linted)
+            << "  shards: " << count;
+    }
+}
+
+TEST_F(ShardTest, LargestFilesSpread) {
+    WriteFile("small1.cc", 10);
+    WriteFile("large1.cc", 1000);
+    WriteFile("small2.cc", 10);
+    WriteFile("large2.cc", 900);
+    WriteFile("small3.cc", 10);
+    WriteFile("large3.cc", 800);
+    std::vector<std::string> names = {
+        "small1.cc", "large1.cc", "small2.cc", "large2.cc", "small3.cc", "large3.cc"
+    };
+    for (size_t index = 0; index < 3; index++) {
+        std::vector<std::string> selected = SelectShard(names, index, 3);
+        // Each shard gets one of the large files.
+        // Small files go to the least loaded shard. (large3.cc)
+        ASSERT_LE(1, selected.size());
+        EXPECT_EQ("large" + std::to_string(index + 1) + ".cc", selected[0]);
+        if (index < 2)
+            EXPECT_EQ(1, selected.size());
+        else
+            EXPECT_EQ(4, selected.size());
+    }
+}
+
+TEST_F(ShardTest, EqualSizesByPath) {
+    for (const char* name : { "a.cc", "b.cc", "c.cc", "d.cc" })
+        WriteFile(name, 5);
+    // The order of arguments doesn't matter.
+    std::vector<std::string> names = { "d.cc", "b.cc", "c.cc", "a.cc" };
+    EXPECT_EQ(std::vector<std::string>({ "a.cc", "c.cc" }), SelectShard(names, 0, 2));
+    EXPECT_EQ(std::vector<std::string>({ "b.cc", "d.cc" }), SelectShard(names, 1, 2));
+}
+
+TEST_F(ShardTest, SummaryRoundTrip) {
+    const std::string content1 = "int a;\t\nint b = (int)1.0; \n";
+    const std::string content2 = "int c; \nint d;\t\nlong e;\n";
+
+    for (const char* counting : { "total", "toplevel", "detailed" }) {
+        CppLintState single;
+        single.SetCountingStyle(counting);
+        LintFile(&single, "foo.cc", content1);
+        LintFile(&single, "bar.cc", content2);
+        ASSERT_LT(0, single.ErrorCount());
+
+        // Shards write detailed counts regardless of --counting.
+        CppLintState shard0;
+        shard0.SetShardSummary(true);
+        LintFile(&shard0, "foo.cc", content1);
+        CppLintState shard1;
+        shard1.SetShardSummary(true);
+        LintFile(&shard1, "bar.cc", content2);
+        std::string summary0 = (dir / "shard0.txt").string();
+        std::string summary1 = (dir / "shard1.txt").string();
+        ASSERT_TRUE(shard0.WriteShardSummary(summary0, 0, 2, 1));
+        ASSERT_TRUE(shard1.WriteShardSummary(summary1, 1, 2, 1));
+
+        CppLintState merged;
+        merged.SetCountingStyle(counting);
+        std::string shard;
+        ASSERT_TRUE(merged.ReadShardSummary(summary0, &shard));
+        EXPECT_EQ("0/2", shard);
+        ASSERT_TRUE(merged.ReadShardSummary(summary1, &shard));
+        EXPECT_EQ("1/2", shard);
+
+        EXPECT_EQ(single.ErrorCount(), merged.ErrorCount());
+        EXPECT_EQ(PrintErrorCounts(&single), PrintErrorCounts(&merged))
+            << "  counting: " << counting;
+    }
+    EXPECT_FALSE(CppLintState().ReadShardSummary((dir / "not_found.txt").string(), nullptr));
+}
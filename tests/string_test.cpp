@@ -2,6 +2,7 @@
 #include <set>
 #include <string>
 #include <vector>
+#include "c_header_list.h"
 #include "string_utils.h"
 
 // TODO(matyalatte): add more test cases
@@ -273,3 +274,65 @@ TEST(StringTest, GetLastNonSpacePos) {
 TEST(StringTest, StrContain) {
     EXPECT_EQ(true, StrContain("x = sprintf()", "printf"));
 }
+
+TEST(StringTest, PerfectHashSet) {
+    for (const char* const *header_p = CPP_HEADERS; *header_p != nullptr; header_p++)
+        EXPECT_TRUE(CPP_HEADER_SET.Contains(*header_p)) << *header_p;
+    for (const char* const *header_p = C_HEADERS; *header_p != nullptr; header_p++)
+        EXPECT_TRUE(C_HEADER_SET.Contains(*header_p)) << *header_p;
+    EXPECT_FALSE(CPP_HEADER_SET.Contains(""));
+    EXPECT_FALSE(CPP_HEADER_SET.Contains("stdio.h"));
+    EXPECT_FALSE(CPP_HEADER_SET.Contains("vectors"));
+    EXPECT_FALSE(C_HEADER_SET.Contains("vector"));
+    EXPECT_FALSE(C_HEADER_SET.Contains("stdio.hpp"));
+}
+
+TEST(StringTest, InHeaderFolders) {
+    EXPECT_TRUE(InHeaderFolders("sys/types.h"));
+    EXPECT_TRUE(InHeaderFolders("linux/foo/bar.h"));
+    EXPECT_TRUE(InHeaderFolders("foo/netinet/in.h"));
+    EXPECT_TRUE(InHeaderFolders("mysys/foo.hpp"));
+    EXPECT_FALSE(InHeaderFolders("sys/types"));
+    EXPECT_FALSE(InHeaderFolders("foo.h/sys/types"));
+    EXPECT_FALSE(InHeaderFolders("system/types.h"));
+    EXPECT_FALSE(InHeaderFolders("types.h"));
+}
+
+TEST(StringTest, Matchers) {
+    // RegexMatch(R"( {4}:)", str)
+    EXPECT_EQ(5, MatchChar("    : x", MatchChar("    : x", 0, ' ', 4), ':'));
+    EXPECT_EQ(INDEX_NONE, MatchChar("   : x", MatchChar("   : x", 0, ' ', 4), ':'));
+    EXPECT_EQ(INDEX_NONE, MatchChar("  ", 0, ' ', 4));
+    // RegexMatch(R"( {6}\w)", str)
+    EXPECT_EQ(7, MatchWordChar("      _x", MatchChar("      _x", 0, ' ', 6)));
+    EXPECT_EQ(INDEX_NONE, MatchWordChar("      ", MatchChar("      ", 0, ' ', 6)));
+    // RegexMatch(R"(\s*}\s*$)", str)
+    EXPECT_TRUE(MatchSpacesToEnd(" \t} ", MatchChar(" \t} ", MatchSpaces(" \t} ", 0), '}')));
+    EXPECT_FALSE(MatchSpacesToEnd(" };", MatchChar(" };", MatchSpaces(" };", 0), '}')));
+    // RegexMatch(R"(\s*"")", str)
+    EXPECT_EQ(3, MatchStr(" \"\"", MatchSpaces(" \"\"", 0), "\"\""));
+    EXPECT_EQ(INDEX_NONE, MatchStr(" \"", MatchSpaces(" \"", 0), "\"\""));
+    EXPECT_EQ(INDEX_NONE, MatchStr("", INDEX_NONE, ""));
+}
+
+TEST(StringTest, FindWord) {
+    static_assert(FindWord("final", "final") == 0);
+    EXPECT_EQ(4, FindWord("int final;", "final"));
+    EXPECT_EQ(12, FindWord("int finally final", "final"));
+    EXPECT_EQ(INDEX_NONE, FindWord("int _final", "final"));
+    EXPECT_EQ(INDEX_NONE, FindWord("int final", "final", 5));
+    EXPECT_TRUE(IsWordBoundary("a b", 1));
+    EXPECT_FALSE(IsWordBoundary("ab", 1));
+    EXPECT_FALSE(IsWordBoundary("", 0));
+}
+
+TEST(StringTest, FindFirstOf) {
+    static constexpr CharSet TOKENS("{;)}");
+    static_assert(TOKENS.Contains('}') && !TOKENS.Contains('('));
+    EXPECT_EQ(7, FindFirstOf("void f() {}", TOKENS));
+    EXPECT_EQ(9, FindFirstOf("void f() {}", TOKENS, 8));
+    EXPECT_EQ(INDEX_NONE, FindFirstOf("int x", TOKENS));
+    EXPECT_EQ(INDEX_NONE, FindFirstOf("x;", TOKENS, 2));
+    EXPECT_TRUE(CharSet("\xff").Contains('\xff'));
+    EXPECT_FALSE(CharSet("\xff").Contains('\x7f'));
+}
@@ -0,0 +1,71 @@
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+#include "cpplint_state.h"
+#include "watcher.h"
+
+static ErrorRecord MakeError(size_t linenum, const std::string& category) {
+    return { "foo.cc", linenum, category, 1, "message of " + category };
+}
+
+TEST(WatcherTest, DiffErrorsSameLines) {
+    std::vector<ErrorRecord> old_errors = {
+        MakeError(1, "whitespace/tab"),
+        MakeError(2, "whitespace/tab"),
+    };
+    std::vector<ErrorRecord> new_errors = {
+        MakeError(2, "whitespace/tab"),
+        MakeError(3, "whitespace/end_of_line"),
+    };
+    std::vector<ErrorRecord> added;
+    std::vector<ErrorRecord> resolved;
+    DiffErrors(old_errors, new_errors, &added, &resolved);
+    ASSERT_EQ(1, added.size());
+    EXPECT_EQ(3, added[0].linenum);
+    EXPECT_EQ("whitespace/end_of_line", added[0].category);
+    ASSERT_EQ(1, resolved.size());
+    EXPECT_EQ(1, resolved[0].linenum);
+    EXPECT_EQ("whitespace/tab", resolved[0].category);
+}
+
+TEST(WatcherTest, DiffErrorsMovedLines) {
+    // A line was inserted at the top of the file.
+    std::vector<ErrorRecord> old_errors = {
+        MakeError(3, "whitespace/tab"),
+        MakeError(5, "readability/casting"),
+    };
+    std::vector<ErrorRecord> new_errors = {
+        MakeError(4, "whitespace/tab"),
+        MakeError(6, "readability/casting"),
+    };
+    std::vector<ErrorRecord> added;
+    std::vector<ErrorRecord> resolved;
+    DiffErrors(old_errors, new_errors, &added, &resolved);
+    EXPECT_TRUE(added.empty());
+    EXPECT_TRUE(resolved.empty());
+
+    // All errors are resolved.
+    DiffErrors(old_errors, {}, &added, &resolved);
+    EXPECT_TRUE(added.empty());
+    EXPECT_EQ(2, resolved.size());
+}
+
+TEST(WatcherTest, RecordErrors) {
+    CppLintState cpplint_state;
+    cpplint_state.SetCountingStyle("detailed");
+    cpplint_state.SetErrorRecording(true, false);
+    cpplint_state.Error("foo.cc", 1, ErrorCategory("whitespace/tab"), 1,
+                        "Tab found; better to use spaces");
+    // Recorded errors are neither printed nor counted.
+    EXPECT_EQ("", cpplint_state.GetErrorStreamAsStr());
+    EXPECT_EQ(0, cpplint_state.ErrorCount());
+
+    cpplint_state.SetErrorRecording(false);
+    std::vector<ErrorRecord> records = cpplint_state.TakeErrorRecords();
+    ASSERT_EQ(1, records.size());
+    EXPECT_EQ("foo.cc", records[0].filename);
+    EXPECT_EQ(1, records[0].linenum);
+    EXPECT_EQ("whitespace/tab", records[0].category);
+    EXPECT_TRUE(cpplint_state.TakeErrorRecords().empty());
+    cpplint_state.FlushThreadStream();
+}